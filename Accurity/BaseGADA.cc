@@ -45,6 +45,26 @@ std::ostream &operator<<(std::ostream &stream, const rbNodeDataType &b) {
  SegLen  Segment longitudes length K+1 and should sum up to M_total_length?
  */
 
+void BaseGADA::releaseArrays() {
+	free(Iext);
+	free(Wext);
+	free(SegLen);
+	free(SegAmp);
+	free(SegState);
+	free(_alpha_array);
+	free(_aux_array);
+	if (workspace == NULL)
+		free(normalized_data_array);
+	Iext = NULL;
+	Wext = NULL;
+	SegLen = NULL;
+	SegAmp = NULL;
+	SegState = NULL;
+	_alpha_array = NULL;
+	_aux_array = NULL;
+	normalized_data_array = NULL;
+}
+
 void BaseGADA::IextToSegLen() {
 	SegLen = (long*) calloc(K + 1, sizeof(long));
 	SegAmp = (double *) calloc(K + 1, sizeof(double));
@@ -661,20 +681,38 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 //    w=calloc(K,sizeof(double));
 //    sigw=calloc(K,sizeof(double));
 
-	//Memory initialization (internal to be freed)
-	yy = (double*) calloc(M_total_length,sizeof(double));
-	t0 = (double*) calloc(M_total_length,sizeof(double));
-	tl = (double*) calloc(M_total_length-1,sizeof(double));
-	tu = (double*) calloc(M_total_length-1,sizeof(double));
-	AA = (double*) calloc(4*M_total_length,sizeof(double));
-	d = (double*) calloc(M0-1,sizeof(double));
-	e = (double*) calloc(M0-1,sizeof(double));
-	h0 = (double*) calloc(M0,sizeof(double));
-	h1 = (double*) calloc(M0-1,sizeof(double));
-	wpred = (double*) calloc(K,sizeof(double));
-	sel = (long*) calloc(K,sizeof(long));
-	z = (double*) calloc(M0,sizeof(double));
-	xx = (double*) calloc(K,sizeof(double)); //myDoubleMAlloc(K);
+	//Memory initialization (internal to be freed, unless it comes from the workspace)
+	if (workspace != NULL) {
+		yy = workspace->zeroed(workspace->yy, M_total_length);
+		t0 = workspace->zeroed(workspace->t0, M_total_length);
+		tl = workspace->zeroed(workspace->tl, M_total_length-1);
+		tu = workspace->zeroed(workspace->tu, M_total_length-1);
+		AA = workspace->zeroed(workspace->AA, 4*M_total_length);
+		d = workspace->zeroed(workspace->d, M0-1);
+		e = workspace->zeroed(workspace->e, M0-1);
+		h0 = workspace->zeroed(workspace->h0, M0);
+		h1 = workspace->zeroed(workspace->h1, M0-1);
+		wpred = workspace->zeroed(workspace->wpred, K);
+		sel = workspace->zeroed(workspace->sel, K);
+		z = workspace->zeroed(workspace->z, M0);
+		xx = workspace->zeroed(workspace->xx, M0);
+	} else {
+		yy = (double*) calloc(M_total_length,sizeof(double));
+		t0 = (double*) calloc(M_total_length,sizeof(double));
+		tl = (double*) calloc(M_total_length-1,sizeof(double));
+		tu = (double*) calloc(M_total_length-1,sizeof(double));
+		AA = (double*) calloc(4*M_total_length,sizeof(double));
+		d = (double*) calloc(M0-1,sizeof(double));
+		e = (double*) calloc(M0-1,sizeof(double));
+		h0 = (double*) calloc(M0,sizeof(double));
+		h1 = (double*) calloc(M0-1,sizeof(double));
+		wpred = (double*) calloc(K,sizeof(double));
+		sel = (long*) calloc(K,sizeof(long));
+		z = (double*) calloc(M0,sizeof(double));
+		xx = (double*) calloc(M0,sizeof(double)); //myDoubleMAlloc(K); M0 long as it holds the full-basis w0 for z below
+	}
+	sblScratchBytes = (6 * M_total_length + 2 * (M_total_length - 1) + 3 * (M0 - 1) + 3 * M0 + K) * sizeof(double) +
+			K * sizeof(long);
 
 	//Create a copy of the input
 	for (i = 0; i < M_total_length; i++)
@@ -693,7 +731,7 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 
 	w0 = yy; //w0 now has M_total_length-1 dimmension
 	//printf("W0\n\nw0[0]:%g\nw0[1]:%g\nw0[2]:%g\nw0[3]:%g\nw0[%ld]:%g\n",w0[0],w0[1],w0[2],w0[3],M0-1,w0[M0-1]);
-	for (i = 0; i < K; i++) {
+	for (i = 0; i < M0; i++) {	//z is always computed on the full basis, K<M0 selects from it below
 		xx[i] = w0[i];
 		t0[i] = h0[i];
 	}
@@ -734,6 +772,7 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 	/******* EM loop         ********/
 	/********************************/
 
+	std::chrono::steady_clock::time_point iterationStart = std::chrono::steady_clock::now();
 	for (n = 0; n < maxNoOfIterations; n++) {
 
 		for (i = 0; i < K; i++) {
@@ -827,6 +866,7 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 //            printf("\n\neuclidean_norm:%g\n\n",delta);
 //        }
 		if (delta < convergenceDelta) {
+			recordSBLIteration(n, K, delta, iterationStart);
 			if (debug > 0) {
 				std::cerr<< boost::format("# \t SBL: Converged after %1% iterations, delta=%4%, within tolerance %2%, M_total_length=%3% \n") %
 						n % convergenceDelta % K % delta;
@@ -835,6 +875,7 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 		}
 
 		sizesel = findminus(alpha_array, K, convergenceMaxAlpha, sel);
+		recordSBLIteration(n, sizesel, delta, iterationStart);
 //        if (n==0){
 //            printf("\n\nSIZESEL FIRST ITERATION:\n");
 //            printf("SEL\n\nsel[0]:%ld\nsel[1]:%ld\nsel[2]:%ld\nsel[3]:%ld\nsel[%ld]:%ld\n",sel[0],sel[1],sel[2],sel[3],K-1,sel[K-1]);
@@ -845,8 +886,10 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 			I[0] = -1;
 			sigw[0] = -1;
 			alpha_array[0] = -1;
-			std::cerr << boost::format("#      SBL: After %1% iterations, No disconinuities found M_total_length=%2% \n") %
-					n % K;
+			if (debug > 0) {
+				std::cerr << boost::format("#      SBL: After %1% iterations, No disconinuities found M_total_length=%2% \n") %
+						n % K;
+			}
 			break;
 		}
 		if (sizesel < K) {
@@ -897,6 +940,14 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 //             }
 
 		} //End if of column elimination
+		if (adaptiveStop.update(n, K, delta)) {
+			stoppedAdaptively = true;
+			if (debug > 0) {
+				std::cerr << boost::format("# \t SBL: Stopped adaptively after %1% iterations, K stable for %2% iterations, delta=%3%, M_total_length=%4% \n") %
+						n % adaptiveStop.window % delta % K;
+			}
+			break;
+		}
 	} //End loop MAXIT
 	/*********************/
 
@@ -926,19 +977,21 @@ long BaseGADA::SBL(double *y, //I -- 1D array with the input signal
 	}
 
 	//Memory freeing....
-	free(yy);
-	free(h0);
-	free(h1);
-	free(xx);
-	free(z);
-	free(t0);
-	free(tl);
-	free(tu);
-	free(wpred);
-	free(d);
-	free(e);
-	free(sel);
-	free(AA);
+	if (workspace == NULL) {
+		free(yy);
+		free(h0);
+		free(h1);
+		free(xx);
+		free(z);
+		free(t0);
+		free(tl);
+		free(tu);
+		free(wpred);
+		free(d);
+		free(e);
+		free(sel);
+		free(AA);
+	}
 
 	*pK = K;
 	return n;
@@ -1225,50 +1278,34 @@ long BaseGADA::BEthresh(double *Scores, long Nscores, double *wr, long *indsel,
 
 void BaseGADA::CollapseAmpTtest() {
 	//Uses a T test to decide which segments collapse to neutral
-	long k;
-
-//	if(L==1)
-//	{
-//		if( fabs(SegAmp[0]-BaseAmp)/sqrt(sigma2/(double)SegLen[0]) < T)
-//			SegAmp[0]=BaseAmp;
-//	}
-	SegState = (double *) calloc(K + 1, sizeof(double));
-	for (i = 0; i <= K; i++)
-		SegState[i] = SegAmp[i];
-	for (k = 0; k < K; k++)
-		if (fabs(SegAmp[k] - BaseAmp) / sqrt(sigma2 / (double) SegLen[k]) < T) {
-			//but do it only if one of the neigboring ones have been collapsed
-			if ((k > 0)
-					&& (fabs(SegAmp[k - 1] - BaseAmp)
-							/ sqrt(sigma2 / (double) SegLen[k - 1]) < T))
-				SegAmp[k] = BaseAmp;
-			if ((k < K - 1)
-					&& (fabs(SegAmp[k + 1] - BaseAmp)
-							/ sqrt(sigma2 / (double) SegLen[k + 1]) < T))
-				SegAmp[k] = BaseAmp;
-			//or it is the initial segment or the final segment of the unit, since we assume that the unseen neighbors where in collapsed state
-			if ((k == 0) || (k == K - 1))
-				SegAmp[k] = BaseAmp;
-			//or it has larger size than the neighboring segments
-			if ((k > 0) && (SegLen[k] > SegLen[k - 1]))
-				SegAmp[k] = BaseAmp;
-			if ((k < K - 1) && (SegLen[k] > SegLen[k + 1]))
-				SegAmp[k] = BaseAmp;
-
-		}
-
 	/*
-	 //Classify amplitudes...
-	 for(k=0;k++;k<K)
-	 {
-	 if(SegAmp[k]>BaseAmp)
-	 SegAmp=+1; //Gain
-	 else if(SegAmp[k]<BaseAmp)
-	 SegAmp=-1;
-	 else
-	 SegAmp=0;
-	 }
+	 * 2026.10.18 two passes over the K+1 segments instead of re-testing the neighbors inside one
+	 * in-place loop: the t test of every segment first (no loop-carried dependency, vectorizes),
+	 * then the collapse rule, which only reads the neighbors' test results. Same decisions as the
+	 * in-place loop, because a neighbor that had been collapsed had always passed its own test.
+	 * The loop used to stop at K-1 (segments are 0..K), so the last segment was never collapsed.
+	 * SegState gets the collapsed amplitude, so Gain/Loss/Neutral follows from comparing it with BaseAmp.
 	 */
+	long k;
+	long noOfSegments = K + 1;
+	vector<unsigned char> isNeutral(noOfSegments);
+
+	for (k = 0; k < noOfSegments; k++)
+		isNeutral[k] = fabs(SegAmp[k] - BaseAmp) / sqrt(sigma2 / (double) SegLen[k]) < T;
+
+	free(SegState);
+	SegState = (double *) calloc(noOfSegments, sizeof(double));
+	for (k = 0; k < noOfSegments; k++) {
+		if (isNeutral[k] && (
+				//the initial segment or the final segment of the unit, since we assume that the unseen neighbors where in collapsed state
+				(k == 0) || (k == noOfSegments - 1)
+				//or one of the neigboring ones is collapsed too
+				|| isNeutral[k - 1] || isNeutral[k + 1]
+				//or it has larger size than the neighboring segments
+				|| (SegLen[k] > SegLen[k - 1]) || (SegLen[k] > SegLen[k + 1])))
+			SegAmp[k] = BaseAmp;
+		SegState[k] = SegAmp[k];
+	}
 }
 /*************************************************************************/
 /*
@@ -1311,22 +1348,19 @@ void BaseGADA::ClassifySegments(double *SegAmp, long *SegLen, double *SegState,
 
 double // Returns BaseAmp corresponding to the base level.
 BaseGADA::CompBaseAmpMedianMethod() {
-	//Computes the median recontruction level, as baseline level.
+	//Computes the median recontruction level (length-weighted median of SegAmp), as baseline level.
+	//2026.10.18 sorts segment indices instead of copies of SegAmp/SegLen. doubleBubbleSort was
+	// quadratic or worse, and the sorted copies replaced SegAmp/SegLen, which scrambled the segment
+	// order that CollapseAmpTtest() and the output rely on.
 	long M_total_length, k, RunLen;
+	vector<long> orderByAmp(K + 1);
 	BaseAmp = 0;
 
-	//If they need to be sorted use the following...
-	double *D;
-	long *I;
-	D = (double*) calloc(K+1,sizeof(double));
-	I = (long*) calloc(K+1,sizeof(long));
-	for (k = 0; k < K + 1; k++) {
-		D[k] = SegAmp[k];
-		I[k] = SegLen[k];
-	}
-	doubleBubbleSort(D, I, K + 1); //I need indexes of the sort
-	SegAmp = D;
-	SegLen = I;
+	for (k = 0; k <= K; k++)
+		orderByAmp[k] = k;
+	//stable, ties keep segment order like doubleBubbleSort
+	std::stable_sort(orderByAmp.begin(), orderByAmp.end(),
+			[this](long left, long right) {return SegAmp[left] < SegAmp[right];});
 
 	M_total_length = 0;
 	for (k = 0; k <= K; k++)
@@ -1338,12 +1372,13 @@ BaseGADA::CompBaseAmpMedianMethod() {
 	RunLen = 0;
 	k = 0;
 	while (RunLen < M_total_length / 2)
-		RunLen = RunLen + SegLen[k++];
+		RunLen = RunLen + SegLen[orderByAmp[k++]];
+	k = max(k, 1L);
 #ifdef _DebugCompBaseAmpMedianMethod_
-	printf("_DebugCompBaseAmpMedianMethod_: k%ld RunLen=%ld SegAmp[k-1]%g SegAmp[k]%g\n",k,RunLen,SegAmp[k-1],SegAmp[k]);
+	printf("_DebugCompBaseAmpMedianMethod_: k%ld RunLen=%ld SegAmp[k-1]%g\n",k,RunLen,SegAmp[orderByAmp[k-1]]);
 #endif
 
-	BaseAmp = SegAmp[k - 1];
+	BaseAmp = SegAmp[orderByAmp[k - 1]];
 
 #ifdef _DebugCompBaseAmpMedianMethod_
 	printf("_DebugCompBaseAmpMedianMethod_: BaseAmp=%g\n",BaseAmp);
@@ -1354,21 +1389,80 @@ BaseGADA::CompBaseAmpMedianMethod() {
 
 /**************************************************************************************************************************/
 
+/*
+ * Stationary Haar step detector used to shrink the initial SBL basis.
+ * For every candidate breakpoint p (between y[p] and y[p+1]) and every dyadic half-width h,
+ * compare the mean of y[p-h+1..p] with the mean of y[p+1..p+h] (windows truncated at the ends),
+ * scaled to a z-score with sigma2. At each scale, positions that reach prefilterThreshold and are
+ * the maximum score within +-h (a coarse window flags every position near a step otherwise) are kept,
+ * together with prefilterMargin positions on either side.
+ * O(M_total_length*prefilterNoOfScales) through a prefix sum and a sliding-window maximum.
+ */
+long BaseGADA::HaarPrefilter(double *y, long M_total_length, long *I) {
+	long p, h, nl, nr, k, j, head, tail;
+	long M0 = M_total_length - 1;
+	double diff, noiseStd;
+	vector<double> cumsum(M_total_length + 1, 0.0);
+	vector<double> score(M0, 0.0);
+	vector<long> maxQueue(M0, 0);	//positions of a monotonic deque for the sliding maximum
+	vector<char> keep(M0, 0);
+
+	for (p = 0; p < M_total_length; p++)
+		cumsum[p + 1] = cumsum[p] + y[p];
+	noiseStd = sqrt(sigma2);
+	if (noiseStd <= 0)
+		noiseStd = 1E-20;
+
+	for (j = 0, h = 1; j < prefilterNoOfScales && h < M_total_length; j++, h <<= 1) {
+		for (p = 0; p < M0; p++) {
+			nl = min(h, p + 1);
+			nr = min(h, M_total_length - 1 - p);
+			diff = (cumsum[p + 1 + nr] - cumsum[p + 1]) / nr - (cumsum[p + 1] - cumsum[p + 1 - nl]) / nl;
+			score[p] = fabs(diff) / (noiseStd * sqrt(1.0 / nl + 1.0 / nr));
+		}
+		//window [p-h, p+h]: push p+h, pop positions left of p-h
+		head = 0;
+		tail = 0;
+		for (p = 0; p < min(h, M0); p++) {
+			while (tail > head && score[maxQueue[tail - 1]] <= score[p])
+				tail--;
+			maxQueue[tail++] = p;
+		}
+		for (p = 0; p < M0; p++) {
+			if (p + h < M0) {
+				while (tail > head && score[maxQueue[tail - 1]] <= score[p + h])
+					tail--;
+				maxQueue[tail++] = p + h;
+			}
+			while (maxQueue[head] < p - h)
+				head++;
+			if (score[p] >= prefilterThreshold && score[p] >= score[maxQueue[head]]) {
+				for (k = max(0L, p - prefilterMargin); k <= min(M0 - 1, p + prefilterMargin); k++)
+					keep[k] = 1;
+			}
+		}
+	}
+	k = 0;
+	for (p = 0; p < M0; p++) {
+		if (keep[p]) {
+			I[k++] = p;
+		}
+	}
+	if (debug > 0) {
+		std::cerr << boost::format("_HaarPrefilter_ kept %1% of %2% candidate breakpoints, threshold=%3%, scales=%4%, margin=%5%.\n") %
+				k % M0 % prefilterThreshold % prefilterNoOfScales % prefilterMargin;
+	}
+	return k;
+}
 
-long BaseGADA::SBLandBE() {
-	//double convergenceDelta, convergenceMaxAlpha, convergenceB;
-	//long maxNoOfIterations;
-	// SBL optimization parameters
-	//convergenceDelta = 1E-10; //1E-10 or 1E-8 seems to work well for this parameter. -- => ++ conv time
-	//convergenceMaxAlpha = 1E8; //1E8 better than 1E10 seems to work well for this parameter. -- => -- conv time
-	//maxNoOfIterations = 100000; //Maximum number of iterations to reach convergence...
-	//convergenceB = 1E-20; //
-	//sigma2 = *Psigma2;
-
+void BaseGADA::normalizeInputData() {
     //2013.08.28 no more copying of input data. to reduce memory usage.
 	//normalized_data_array = inputDataArray;
 
-    normalized_data_array = (double* )calloc(_M_total_length, sizeof(double));
+    if (workspace != NULL)
+        normalized_data_array = workspace->zeroed(workspace->normalizedData, _M_total_length);
+    else
+        normalized_data_array = (double* )calloc(_M_total_length, sizeof(double));
     for(i=0;i<_M_total_length;i++)
         normalized_data_array[i]=inputDataArray[i];
 
@@ -1393,8 +1487,153 @@ long BaseGADA::SBLandBE() {
 	ymean = ymean / _M_total_length;
 	for (i = 0; i < _M_total_length; ++i)
 		normalized_data_array[i] = normalized_data_array[i] - ymean;
+}
+
+long BaseGADA::runSegmentation() {
+	if (segmentationEngine == kEnginePELT)
+		return PELTandBE();
+	return SBLandBE();
+}
+
+void BaseGADA::recordSBLIteration(long n, long K, double delta, std::chrono::steady_clock::time_point &iterationStart) {
+	if (!collectSBLTelemetry)
+		return;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	SBLIterationRecord record;
+	record.iteration = n;
+	record.K = K;
+	record.delta = delta;
+	record.microseconds = std::chrono::duration<double, std::micro>(now - iterationStart).count();
+	sblTelemetry.push_back(record);
+	iterationStart = now;
+}
+
+void BaseGADA::appendStructureBytes(vector<pair<string, size_t> > &structureBytesVec) const {
+	long noOfSegments = K + 1;
+	size_t workspaceBytes = 0;
+	if (workspace != NULL) {
+		workspaceBytes = workspace->normalizedData.capacity() * sizeof(double) + workspace->sel.capacity() * sizeof(long);
+		for (const vector<double> *buffer : {&workspace->yy, &workspace->t0, &workspace->tl, &workspace->tu, &workspace->AA,
+				&workspace->d, &workspace->e, &workspace->h0, &workspace->h1, &workspace->wpred, &workspace->z, &workspace->xx})
+			workspaceBytes += buffer->capacity() * sizeof(double);
+	}
+	//normalized_data_array lives in the workspace if there is one
+	structureBytesVec.push_back(make_pair(string("normalized_data"),
+			(normalized_data_array != NULL && workspace == NULL) ? _M_total_length * sizeof(double) : 0));
+	structureBytesVec.push_back(make_pair(string("workspace"), workspaceBytes));
+	structureBytesVec.push_back(make_pair(string("sbl_alpha_aux"),
+			(_alpha_array != NULL ? _M_total_length * sizeof(double) : 0) +
+			(_aux_array != NULL ? _M_total_length * sizeof(double) : 0)));
+	structureBytesVec.push_back(make_pair(string("breakpoints"),
+			(Iext != NULL ? (noOfSegments + 1) * sizeof(long) : 0) + (Wext != NULL ? noOfSegments * sizeof(double) : 0)));
+	structureBytesVec.push_back(make_pair(string("segments"),
+			(SegLen != NULL ? noOfSegments * sizeof(long) : 0) + (SegAmp != NULL ? noOfSegments * sizeof(double) : 0) +
+			(SegState != NULL ? noOfSegments * sizeof(double) : 0)));
+	structureBytesVec.push_back(make_pair(string("sbl_telemetry"), sblTelemetry.capacity() * sizeof(SBLIterationRecord)));
+	structureBytesVec.push_back(make_pair(string("sbl_scratch_peak"), sblScratchBytes));
+	structureBytesVec.push_back(make_pair(string("be_structures_peak"), beStructureBytes));
+}
+
+void BaseGADA::writeSBLTelemetry(std::ostream &out, const string &label, bool writeHeader) {
+	/*
+	 * 2026.10.18 one line per EM iteration. delta and K show whether a long run is still shrinking
+	 * the active set or just creeping towards convergenceDelta.
+	 */
+	unsigned long i;
+	if (writeHeader) {
+		if (!label.empty())
+			out << "label\t";
+		out << "iteration\tK\tdelta\tmicroseconds" << std::endl;
+	}
+	for (i = 0; i < sblTelemetry.size(); i++) {
+		if (!label.empty())
+			out << label << "\t";
+		out << boost::format("%1%\t%2%\t%3$.6g\t%4$.1f\n") % sblTelemetry[i].iteration % sblTelemetry[i].K %
+				sblTelemetry[i].delta % sblTelemetry[i].microseconds;
+	}
+}
+
+//2: with the input hash, files of version 1 are not loaded
+static const char sblStateMagic[8] = {'G', 'A', 'D', 'A', 'S', 'B', 'L', '2'};
+
+static uint64_t hashInputData(const double *inputDataArray, long M) {
+	return boost::hash_range(inputDataArray, inputDataArray + M);
+}
+
+bool SBLState::save(const string &path) const {
+	std::ofstream stateFile(path.c_str(), std::ios::binary);
+	if (!stateFile)
+		return false;
+	long K = (long) I.size();
+	stateFile.write(sblStateMagic, sizeof(sblStateMagic));
+	stateFile.write((const char*) &M, sizeof(long));
+	stateFile.write((const char*) &K, sizeof(long));
+	stateFile.write((const char*) &ymean, sizeof(double));
+	stateFile.write((const char*) &inputHash, sizeof(uint64_t));
+	stateFile.write((const char*) &sigma2, sizeof(double));
+	stateFile.write((const char*) &a, sizeof(double));
+	stateFile.write((const char*) I.data(), K * sizeof(long));
+	stateFile.write((const char*) alpha.data(), K * sizeof(double));
+	stateFile.write((const char*) w.data(), K * sizeof(double));
+	return (bool) stateFile;
+}
 
+bool SBLState::load(const string &path) {
+	std::ifstream stateFile(path.c_str(), std::ios::binary);
+	if (!stateFile)
+		return false;
+	char magic[sizeof(sblStateMagic)];
+	long K, i;
+	stateFile.read(magic, sizeof(magic));
+	stateFile.read((char*) &M, sizeof(long));
+	stateFile.read((char*) &K, sizeof(long));
+	stateFile.read((char*) &ymean, sizeof(double));
+	stateFile.read((char*) &inputHash, sizeof(uint64_t));
+	stateFile.read((char*) &sigma2, sizeof(double));
+	stateFile.read((char*) &a, sizeof(double));
+	if (!stateFile || memcmp(magic, sblStateMagic, sizeof(magic)) != 0 || M < 2 || K < 0 || K >= M) {
+		*this = SBLState();
+		return false;
+	}
+	I.resize(K);
+	alpha.resize(K);
+	w.resize(K);
+	stateFile.read((char*) I.data(), K * sizeof(long));
+	stateFile.read((char*) alpha.data(), K * sizeof(double));
+	stateFile.read((char*) w.data(), K * sizeof(double));
+	for (i = 0; stateFile && i < K; i++)
+		if (I[i] < 0 || I[i] >= M - 1 || (i > 0 && I[i] <= I[i - 1]))
+			break;
+	if (!stateFile || i < K) {
+		*this = SBLState();
+		return false;
+	}
+	return true;
+}
 
+long BaseGADA::SBLandBE() {
+	//double convergenceDelta, convergenceMaxAlpha, convergenceB;
+	//long maxNoOfIterations;
+	// SBL optimization parameters
+	//convergenceDelta = 1E-10; //1E-10 or 1E-8 seems to work well for this parameter. -- => ++ conv time
+	//convergenceMaxAlpha = 1E8; //1E8 better than 1E10 seems to work well for this parameter. -- => -- conv time
+	//maxNoOfIterations = 100000; //Maximum number of iterations to reach convergence...
+	//convergenceB = 1E-20; //
+	//sigma2 = *Psigma2;
+
+	prepareSBL();
+	if (debug){
+		std::cerr << "_SBLBE_ SBL starts\n";
+	}
+	numEMsteps = SBL(normalized_data_array, Iext, _alpha_array, Wext + 1, _aux_array, _M_total_length, &K, sigma2, a, convergenceB,
+			convergenceMaxAlpha, maxNoOfIterations, convergenceDelta, debug);
+	return finishSBLandBE();
+}
+
+void BaseGADA::prepareSBL() {
+	long i;
+
+	normalizeInputData();
 
 	//Call to SBL
 	if (debug){
@@ -1417,13 +1656,38 @@ long BaseGADA::SBLandBE() {
 		Wext[i] = 0.0;
 	for (i = 0; i < _M_total_length; i++)
 		Iext[i] = i;
-
-	if (debug){
-		std::cerr << "_SBLBE_ SBL starts\n";
+	warmStarted = (sblState != NULL &&
+			sblState->matches(_M_total_length, ymean, hashInputData(inputDataArray, _M_total_length)));
+	if (warmStarted) {
+		//2026.10.18 continue EM from the saved basis, alpha and weights
+		K = (long) sblState->I.size();
+		for (i = 0; i < K; i++) {
+			Iext[i] = sblState->I[i];
+			_alpha_array[i] = sblState->alpha[i];
+			Wext[1 + i] = sblState->w[i];
+		}
+	} else if (prefilterThreshold > 0 && K > 1) {
+		K = HaarPrefilter(normalized_data_array, _M_total_length, Iext);
 	}
-	numEMsteps = SBL(normalized_data_array, Iext, _alpha_array, Wext + 1, _aux_array, _M_total_length, &K, sigma2, a, convergenceB,
-			convergenceMaxAlpha, maxNoOfIterations, convergenceDelta, debug);
+	noOfBreakpointsBeforeSBL = K;
+	adaptiveStop.reset();
+	stoppedAdaptively = false;
+	sblTelemetry.clear();
+}
+
+long BaseGADA::finishSBLandBE() {
+	long i;
 	noOfBreakpointsAfterSBL = K;	//2013.08.31 K would be changed later on.
+	if (sblState != NULL) {
+		sblState->M = _M_total_length;
+		sblState->ymean = ymean;
+		sblState->inputHash = hashInputData(inputDataArray, _M_total_length);
+		sblState->sigma2 = sigma2;
+		sblState->a = a;
+		sblState->I.assign(Iext, Iext + K);
+		sblState->alpha.assign(_alpha_array, _alpha_array + K);
+		sblState->w.assign(Wext + 1, Wext + 1 + K);
+	}
 
 	//Convert Iext and Wext to the extended notation.
 	Iext = (long*) realloc(Iext, (K + 2) * sizeof(long));
@@ -1440,7 +1704,9 @@ long BaseGADA::SBLandBE() {
 	if (debug){
 		std::cerr << "_SBLBE_ Backward Elimination T=" << T << " MinSegLen=" << MinSegLen << std::endl;
 	}
+	std::chrono::steady_clock::time_point beStart = std::chrono::steady_clock::now();
 	BEwTandMinLen(Wext, Iext, &K, sigma2, T, MinSegLen, debug);
+	beSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beStart).count();
 
 	Iext = (long*) realloc(Iext, (K + 2) * sizeof(long));
 	Wext = (double *) realloc(Wext, (K + 1) * sizeof(double));
@@ -1460,6 +1726,119 @@ long BaseGADA::SBLandBE() {
 	return K;
 }
 
+/**************************************************************************************************************************/
+
+/*
+ * PELT (Killick, Fearnhead & Eckley 2012) for changes in mean with Gaussian cost:
+ * F(t) = min_s F(s) + RSS(y[s..t-1]) + penalty, with candidates s pruned once F(s)+RSS(s,t) > F(t).
+ * Near-linear when the number of breakpoints grows with M_total_length.
+ */
+long BaseGADA::PELT(double *y, long M_total_length, double penalty, long *I) {
+	long t, s, k, bestS, noOfCandidates;
+	double cost, segmentSum, bestF;
+	vector<double> cumsum(M_total_length + 1, 0.0);
+	vector<double> cumsumSquared(M_total_length + 1, 0.0);
+	vector<double> F(M_total_length + 1, 0.0);
+	vector<long> lastBreakpoint(M_total_length + 1, 0);
+	vector<long> candidates;
+	vector<double> candidateCost;
+
+	for (t = 0; t < M_total_length; t++) {
+		cumsum[t + 1] = cumsum[t] + y[t];
+		cumsumSquared[t + 1] = cumsumSquared[t] + y[t] * y[t];
+	}
+	F[0] = -penalty;
+	candidates.push_back(0);
+	peltNoOfCandidatesEvaluated = 0;
+	for (t = 1; t <= M_total_length; t++) {
+		noOfCandidates = candidates.size();
+		candidateCost.resize(noOfCandidates);
+		bestF = 1E300;
+		bestS = 0;
+		for (k = 0; k < noOfCandidates; k++) {
+			s = candidates[k];
+			segmentSum = cumsum[t] - cumsum[s];
+			cost = F[s] + (cumsumSquared[t] - cumsumSquared[s]) - segmentSum * segmentSum / (t - s);
+			candidateCost[k] = cost;
+			if (cost + penalty < bestF) {
+				bestF = cost + penalty;
+				bestS = s;
+			}
+		}
+		peltNoOfCandidatesEvaluated += noOfCandidates;
+		F[t] = bestF;
+		lastBreakpoint[t] = bestS;
+		//pruning
+		s = 0;
+		for (k = 0; k < noOfCandidates; k++) {
+			if (candidateCost[k] <= bestF) {
+				candidates[s++] = candidates[k];
+			}
+		}
+		candidates.resize(s);
+		candidates.push_back(t);
+	}
+	//backtrack, segment starts in reverse order
+	k = 0;
+	for (t = lastBreakpoint[M_total_length]; t > 0; t = lastBreakpoint[t]) {
+		I[k++] = t - 1;	//SBL notation: breakpoint between y[t-1] and y[t]
+	}
+	reverse(I, I + k);
+	return k;
+}
+
+long BaseGADA::PELTandBE() {
+	long k;
+	double penalty, leftMean, rightMean;
+
+	normalizeInputData();
+	Iext = (long*) calloc(_M_total_length + 1, sizeof(long));
+	Wext = (double*) calloc(_M_total_length + 1, sizeof(double));
+
+	penalty = peltPenalty;
+	if (penalty <= 0)
+		penalty = 2 * log((double) _M_total_length);
+	penalty = penalty * sigma2;
+	if (debug) {
+		std::cerr << boost::format("_PELTandBE_ PELT starts, penalty=%1% .\n") % penalty;
+	}
+	K = PELT(normalized_data_array, _M_total_length, penalty, Iext);
+	noOfBreakpointsBeforeSBL = _M_total_length - 1;
+	noOfBreakpointsAfterSBL = K;
+	numEMsteps = 0;
+	delta = 0;
+
+	//Convert to the extended notation. Weights of the normalized basis follow from the segment means:
+	// SegAmp[k]-SegAmp[k-1] = Wext[k]/sqrt((M-Iext[k])*Iext[k]/M), see IextWextToSegAmp().
+	for (k = K + 1; k > 0; k--)
+		Iext[k] = Iext[k - 1] + 1;
+	Iext[0] = 0;
+	Iext[K + 1] = _M_total_length;
+	Wext[0] = ymean;
+	for (k = 1; k <= K; k++) {
+		leftMean = 0;
+		for (i = Iext[k - 1]; i < Iext[k]; i++)
+			leftMean += normalized_data_array[i];
+		leftMean = leftMean / (Iext[k] - Iext[k - 1]);
+		rightMean = 0;
+		for (i = Iext[k]; i < Iext[k + 1]; i++)
+			rightMean += normalized_data_array[i];
+		rightMean = rightMean / (Iext[k + 1] - Iext[k]);
+		Wext[k] = (rightMean - leftMean) * sqrt((double) (_M_total_length - Iext[k]) * (double) Iext[k] / _M_total_length);
+	}
+	if (debug) {
+		std::cerr << boost::format("_PELTandBE_ %1% breakpoints after PELT (%2% candidate evaluations), Backward Elimination T=%3% MinSegLen=%4%\n") %
+				K % peltNoOfCandidatesEvaluated % T % MinSegLen;
+	}
+	std::chrono::steady_clock::time_point beStart = std::chrono::steady_clock::now();
+	BEwTandMinLen(Wext, Iext, &K, sigma2, T, MinSegLen, debug);
+	beSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beStart).count();
+	if (debug) {
+		std::cerr << "_PELTandBE_ After BE K=" << K << endl;
+	}
+	return K;
+}
+
 /**************************************************************************************************************************/
 long BaseGADA::BEwTandMinLen( //Returns breakpoint list length. with T and MinSegLen
 		double *Wext, //IO Breakpoint weights extended notation...
@@ -1504,14 +1883,36 @@ long BaseGADA::BEwTandMinLen( //Returns breakpoint list length. with T and MinSe
 		std::cerr << boost::format("_BEwTandMinLen_() finished. number of breakpoints=%1% \n") % K;
 	}
 
-	//Do not free tscore_local as it will trigger memory free error during program exit. 
-	//  tscore_local is realloc-ed in BEwTscore().
-	//free(tscore_local); 
+	//2026.10.18 BEwTscore() no longer realloc-s tscore_local, so it can be freed here.
+	free(tscore_local);
 
 	*pK = K;
 	return K;
 }
 
+//2026.10.18 progress events of BEwTscore(), see trace.h
+enum BETraceEventType {
+	kTraceBEIteration,
+	kTraceBERemoval
+};
+
+//values: counter, T, MinSegLen, the 6 fields of the key or break point, previousRoundMinScore,
+// previousToRemoveSegmentLength, noOfSegments and for iterations setOfBPPtr.size, currentMinScore, toRemoveSegmentLength
+static void decodeBEProgress(ostream &out, const TraceEvent &event) {
+	const double *v = event.values;
+	boost::format bpFormat = boost::format("position=%1%, tscore=%2%, weight=%3%, length=%4%, MinSegLen=%5%, totalLength=%6%")%
+			long(v[3]) % v[4] % v[5] % long(v[6]) % long(v[7]) % long(v[8]);
+	if (event.type==kTraceBEIteration){
+		out << boost::format("BEwTscore(): iteration no=%1% T=%2% MinSegLen=%3%: minimum break point key: %4% previousRoundMinScore=%5% previousToRemoveSegmentLength=%6% noOfSegments=%7% setOfBPPtr.size=%8% \n") %
+				long(v[0]) % v[1] % long(v[2]) % bpFormat % v[9] % long(v[10]) % long(v[11]) % long(v[12]);
+		out << boost::format("\t currentMinScore=%1%, toRemoveSegmentLength=%2% \n")% v[13] % long(v[14]);
+	}
+	else{
+		out << boost::format("\t BEwTscore(): iteration no=%1% T=%2% MinSegLen=%3%: break point to be removed: %4% previousRoundMinScore=%5% previousToRemoveSegmentLength=%6% noOfSegments=%7% \n") %
+				long(v[0]) % v[1] % long(v[2]) % bpFormat % v[9] % long(v[10]) % long(v[11]);
+	}
+}
+
 /******************************************************/
 //BEwTscore(Iext,Wext,h0,h1,tscore_array,&K,T);  //Need to update BEthres to operate on the Iext Wext notation...
 long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation...
@@ -1525,6 +1926,10 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 
 	K = *pK; //Number of breakpoints
 	M_total_length = Iext[K + 1]; //Total length
+	if (K == 0) {
+		//2026.10.18 nothing to eliminate, and the tree below would be empty (no minimum node).
+		return 0;
+	}
 
 	if (debug>0){
 		std::cerr << boost::format("BEwTscore(): BE starts K=%1% M_total_length=%2% T=%3% MinSegLen=%4% ... \n")% K % M_total_length % T % MinSegLen;
@@ -1532,7 +1937,7 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 	if (debug>0){
 		std::cerr << boost::format("Adding %1% breakpoints into a red-black tree ... ")% K ;
 	}
-	treeType rbTree = treeType();
+	treeType rbTree;
 
 	BreakPoint* leftBreakPointPtr=NULL;
 	BreakPoint* rightBreakPointPtr=NULL;
@@ -1540,14 +1945,20 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 	rbNodeType* currentNodePtr=rbTree.nil;
 	rbNodeType* genomeLeftNodePtr=rbTree.nil;
 	rbNodeType* genomeRightNodePtr=rbTree.nil;
+	vector<BreakPoint*> allocatedBreakPointPtrVector;	//2026.10.18 everything new-ed below, deleted at the end
+	vector<rbNodeDataType*> allocatedNodeDataPtrVector;
 	BreakPoint *leftMostBreakPointPtr = new BreakPoint(Iext[0], Wext[0], tscore_array[0], 0, MinSegLen, T, Iext[K+1]);
 	leftMostBreakPointPtr->nodePtr = rbTree.nil;
 	BreakPoint *rightMostBreakPointPtr = new BreakPoint(Iext[K+1], 0, 0, 0, MinSegLen, T, Iext[K+1]);
 	rightMostBreakPointPtr->nodePtr = rbTree.nil;
+	allocatedBreakPointPtrVector.reserve(K + 2);
+	allocatedBreakPointPtrVector.push_back(leftMostBreakPointPtr);
+	allocatedBreakPointPtrVector.push_back(rightMostBreakPointPtr);
 	int maxBPSetSize =0;
 	for (i = 1; i < K + 1; i++){
 		long segLength = min(Iext[i]-Iext[i-1],Iext[i+1]-Iext[i]);	//shorter of two neighboring segments as length for the breakpoint
 		BreakPoint* bpPtr = new BreakPoint(Iext[i], Wext[i], tscore_array[i], segLength, MinSegLen, T, Iext[K+1]);
+		allocatedBreakPointPtrVector.push_back(bpPtr);
 		BreakPointKey bpKey = bpPtr->getKey();
 		//cerr<< *bpPtr << endl;
 		//cerr << boost::format("i=%1%, tree size=%2%, tree valid=%3%")% i % rbTree.size() % rbTree.isValidRedBlackTree() << endl;
@@ -1566,6 +1977,7 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 		currentNodePtr = rbTree.queryTree(bpKey);
 		if (rbTree.isNULLNode(currentNodePtr)){
 			rbNodeDataType* dataPtr = new rbNodeDataType();
+			allocatedNodeDataPtrVector.push_back(dataPtr);
 			currentNodePtr = rbTree.insertNode(bpKey, dataPtr);
 		}
 		currentNodePtr->getDataPtr()->insert(bpPtr);
@@ -1576,6 +1988,10 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 		//reset the left break point pointer
 		leftBreakPointPtr = bpPtr;
 	}
+	//the most BE holds: scores, breakpoints, one tree node per key and one set entry per breakpoint
+	beStructureBytes = (K + 1) * sizeof(double) +
+			allocatedBreakPointPtrVector.size() * (sizeof(BreakPoint) + 2 * sizeof(BreakPoint*) + 4 * sizeof(void*)) +
+			allocatedNodeDataPtrVector.size() * (sizeof(rbNodeDataType) + sizeof(rbNodeType) + sizeof(void*));
 	if (debug>0){
 		//rbTree.printTree();
 		std::cerr << boost::format(" noOfNodesInTree=%1%, tree max depth =%2%, tree valid=%3%, maxBPSetSize=%4%.\n") %
@@ -1600,15 +2016,21 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 
 	currentMinScore = minBPKey.tscore;
 	toRemoveSegmentLength = minBPKey.segmentLength;
+	//2026.10.18 the progress inside the loop is traced, only builds with ACCURITY_TRACE report it
+	Tracer tracer;
+	if (kTraceEnabled && debug>0){
+		int sink = tracer.addSink(std::cerr);
+		tracer.addEventType(kTraceBEIteration, sink, decodeBEProgress);
+		tracer.addEventType(kTraceBERemoval, sink, decodeBEProgress);
+	}
 	while (rbTree.noOfNodes()>0 && (currentMinScore<T || toRemoveSegmentLength<MinSegLen)){
 		minBPKey = minNodePtr->getKey();
 		setOfBPPtr = minNodePtr->getDataPtr();
-		if (debug>0 && counter%reportIntervalDuringBE==0){
-			std::cerr << boost::format("BEwTscore(): iteration no=%1% T=%2% MinSegLen=%3%: minimum break point key: %4% previousRoundMinScore=%5% previousToRemoveSegmentLength=%6% noOfSegments=%7% setOfBPPtr.size=%8% \n") %
-					counter % T % MinSegLen % minBPKey %  previousRoundMinScore % previousToRemoveSegmentLength %
-					rbTree.noOfNodes() % (*setOfBPPtr).size();
-			cerr << boost::format("\t currentMinScore=%1%, toRemoveSegmentLength=%2% \n")%
-							currentMinScore % toRemoveSegmentLength;
+		if (tracer.active() && counter%reportIntervalDuringBE==0){
+			tracer.record(kTraceBEIteration, counter, T, MinSegLen, minBPKey.position, minBPKey.tscore, minBPKey.weight,
+					minBPKey.segmentLength, minBPKey.MinSegLen, minBPKey.totalLength, previousRoundMinScore,
+					previousToRemoveSegmentLength, rbTree.noOfNodes(), (*setOfBPPtr).size(), currentMinScore,
+					toRemoveSegmentLength);
 		}
 		for (setOfBPIterator =(*setOfBPPtr).begin(); setOfBPIterator!=(*setOfBPPtr).end(); setOfBPIterator++){
 			//remove all breakpoints in this node's data (they have same tscore and length)
@@ -1616,9 +2038,10 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 			leftBreakPointPtr = minBPPtr->leftBreakPointPtr;
 			rightBreakPointPtr = minBPPtr->rightBreakPointPtr;
 
-			if ((debug>0) && counter%reportIntervalDuringBE==0){
-				std::cerr << boost::format("\t BEwTscore(): iteration no=%1% T=%2% MinSegLen=%3%: break point to be removed: %4% previousRoundMinScore=%5% previousToRemoveSegmentLength=%6% noOfSegments=%7% \n") %
-						counter % T % MinSegLen % *minBPPtr %  previousRoundMinScore % previousToRemoveSegmentLength % rbTree.noOfNodes();
+			if (tracer.active() && counter%reportIntervalDuringBE==0){
+				tracer.record(kTraceBERemoval, counter, T, MinSegLen, minBPPtr->position, minBPPtr->tscore,
+						minBPPtr->weight, minBPPtr->segmentLength, minBPPtr->MinSegLen, minBPPtr->totalLength,
+						previousRoundMinScore, previousToRemoveSegmentLength, rbTree.noOfNodes());
 			}
 			//update two neighboring break points.
 			minBPPtr->removeItself();
@@ -1636,7 +2059,9 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 				genomeLeftNodePtr = rbTree.queryTree(leftBreakPointPtr->getKey());
 				if (rbTree.isNULLNode(genomeLeftNodePtr)){
 					//create an new node
-					genomeLeftNodePtr = rbTree.insertNode(leftBreakPointPtr->getKey(), new rbNodeDataType() );
+					rbNodeDataType* dataPtr = new rbNodeDataType();
+					allocatedNodeDataPtrVector.push_back(dataPtr);
+					genomeLeftNodePtr = rbTree.insertNode(leftBreakPointPtr->getKey(), dataPtr);
 				}
 				genomeLeftNodePtr->getDataPtr()->insert(leftBreakPointPtr);
 				leftBreakPointPtr->nodePtr = genomeLeftNodePtr;
@@ -1653,7 +2078,9 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 				genomeRightNodePtr = rbTree.queryTree(rightBreakPointPtr->getKey());
 				if (rbTree.isNULLNode(genomeRightNodePtr)){
 					//create an new node
-					genomeRightNodePtr = rbTree.insertNode(rightBreakPointPtr->getKey(), new rbNodeDataType() );
+					rbNodeDataType* dataPtr = new rbNodeDataType();
+					allocatedNodeDataPtrVector.push_back(dataPtr);
+					genomeRightNodePtr = rbTree.insertNode(rightBreakPointPtr->getKey(), dataPtr);
 				}
 				genomeRightNodePtr->getDataPtr()->insert(rightBreakPointPtr);
 				rightBreakPointPtr->nodePtr = genomeRightNodePtr;
@@ -1678,6 +2105,7 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 		}
 
 	}
+	tracer.finish();
 	if (debug>0){
 		std::cerr << boost::format("BEwTscore(): last iteration no=%1% T=%2% MinSegLen=%3%: minimum break point key: %4%, previousRoundMinScore=%5% previousToRemoveSegmentLength=%6% tree size=%7%, noOfNodesInTree=%8% \n") %
 				counter % T % MinSegLen % minBPKey % previousRoundMinScore %
@@ -1717,12 +2145,14 @@ long BaseGADA::BEwTscore(double *Wext, //IO Breakpoint weights extended notation
 		tscore_array[i]=breakPointVector[i].tscore;
 	}
 	Iext[K+1] = leftMostBreakPointPtr->totalLength;
-	Iext = (long*) realloc(Iext, (K + 2) * sizeof(long));
-	Wext = (double *) realloc(Wext, (K + 1) * sizeof(double));
-	tscore_array = (double *) realloc(tscore_array, (K + 1) * sizeof(double));
-
-	//free(leftMostBreakPointPtr);
-	//free(rightMostBreakPointPtr);
+	//2026.10.18 no realloc here: Iext/Wext/tscore_array are the caller's pointers (passed by value),
+	// a moved block would leave the caller with a dangling one. SBLandBE() shrinks Iext and Wext itself.
+
+	//2026.10.18 free all break points and node sets, the tree only frees its own nodes.
+	for (i = 0; i < (long) allocatedBreakPointPtrVector.size(); i++)
+		delete allocatedBreakPointPtrVector[i];
+	for (i = 0; i < (long) allocatedNodeDataPtrVector.size(); i++)
+		delete allocatedNodeDataPtrVector[i];
 	leftBreakPointPtr = NULL;
 	rightMostBreakPointPtr = NULL;
 	*pK = K;
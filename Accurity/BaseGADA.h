@@ -35,6 +35,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>	//2026.10.18 SBLState::inputHash
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -42,10 +43,12 @@
 #include <vector>
 #include <map>	//for hash_map
 #include <set>	//for set
+#include <chrono>	//2026.10.18 SBL telemetry
 #include <functional>	//2013.09.11 for customize hash
 #include <boost/functional/hash.hpp>	//2013.09.10 yh: for customize boost::hash
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
+#include "trace.h"	//2026.10.18 progress of backward elimination
 #include "RedBlackTree.h"	//2013.09.19 red-black tree to store segment breakpoint, score, etc.
 
 #define log2(x) log(x)/log(2)
@@ -61,7 +64,7 @@ class BreakPointKey{
 	 * 	content is similar to BreakPoint but different ordering function.
 	 */
 	// for output
-	friend ostream& operator<<(ostream& out, BreakPointKey& bpKey){
+	friend ostream& operator<<(ostream& out, const BreakPointKey& bpKey){
 		/*
 		 * 2013.09.22 something wrong here, it can't be streamed to an ostream
 		 */
@@ -174,7 +177,7 @@ public:
 
 class BreakPoint{
 	// for output
-	friend ostream& operator<<(ostream& out, BreakPoint& breakPoint){
+	friend ostream& operator<<(ostream& out, const BreakPoint& breakPoint){
 		out << boost::format("position=%1%, tscore=%2%, weight=%3%, length=%4%, MinSegLen=%5%, totalLength=%6%")%
 				breakPoint.position % breakPoint.tscore % breakPoint.weight %
 				breakPoint.segmentLength % breakPoint.MinSegLen % breakPoint.totalLength;
@@ -334,6 +337,113 @@ namespace std {
 
 };
 
+//2026.10.18 segmentation engines available through BaseGADA::runSegmentation()
+enum SegmentationEngine {
+	kEngineSBL = 0,	//sparse Bayesian learning followed by backward elimination
+	kEnginePELT = 1	//penalized exact change-point detection (PELT) followed by backward elimination
+};
+//"SBL" or "PELT" (case-insensitive) to a SegmentationEngine, -1 if unknown.
+inline int segmentationEngineFromName(const string& engineName){
+	if (boost::iequals(engineName, "SBL"))
+		return kEngineSBL;
+	if (boost::iequals(engineName, "PELT"))
+		return kEnginePELT;
+	return -1;
+}
+
+//2026.10.18 one EM iteration of SBL, kept in BaseGADA::sblTelemetry when collectSBLTelemetry is set.
+struct SBLIterationRecord{
+	long iteration;
+	long K;	//active breakpoints after findminus
+	double delta;	//max |w-wpred| of this iteration
+	double microseconds;	//wall time of the iteration
+};
+
+class SBLAdaptiveStop{
+	/*
+	 * 2026.10.18 optional early stop of the SBL EM loop: stop once the number of active breakpoints
+	 * has not changed for window iterations and delta is still above deltaRatio times its value at
+	 * the start of that window, i.e. it has plateaued instead of heading to convergenceDelta.
+	 * window<=0 disables the rule.
+	 */
+public:
+	long window;
+	double deltaRatio;
+	long noOfStableIterations;
+	long lastK;
+	vector<double> deltaHistory;	//ring buffer of the last window+1 deltas
+
+	SBLAdaptiveStop():window(0), deltaRatio(0.9){
+		reset();
+	}
+	void reset(){
+		noOfStableIterations = 0;
+		lastK = -1;
+		deltaHistory.assign(max(window, 0L) + 1, 0.0);
+	}
+	//call once per EM iteration n with K after basis reduction. Returns true if EM should stop.
+	bool update(long n, long K, double delta){
+		if (window <= 0)
+			return false;
+		deltaHistory[n % (window + 1)] = delta;
+		if (K == lastK)
+			noOfStableIterations++;
+		else
+			noOfStableIterations = 0;
+		lastK = K;
+		return noOfStableIterations >= window && delta >= deltaRatio * deltaHistory[(n + 1) % (window + 1)];
+	}
+};
+
+class GADAWorkspace{
+	/*
+	 * 2026.10.18 scratch arrays of SBL() and the normalized input, kept between calls so that repeated
+	 * segmentations (many chromosomes, many samples) do not go back to the allocator for O(M) memory
+	 * every time. Set BaseGADA::workspace to use one. A workspace must not be shared by two
+	 * segmentations running at the same time; use one per thread.
+	 */
+public:
+	vector<double> normalizedData;
+	vector<double> yy, t0, tl, tu, AA, d, e, h0, h1, wpred, z, xx;
+	vector<long> sel;
+
+	//zero-filled like calloc(n), keeps the capacity of earlier calls
+	template<class ElementType>
+	ElementType* zeroed(vector<ElementType> &buffer, long n){
+		buffer.assign(max(n, 1L), ElementType());
+		return buffer.data();
+	}
+};
+
+class SBLState{
+	/*
+	 * 2026.10.18 converged SBL state of one track: the active basis I (SBL indexing, before the extended
+	 * notation), its alpha and weights, and the sigma2 and a it converged with. With BaseGADA::sblState set,
+	 * prepareSBL() starts EM from it instead of the full basis if it belongs to the same input (same length,
+	 * mean and hash of the values), so a
+	 * re-run with another a or sigma2 takes a few iterations. Positions pruned in the saved run stay pruned.
+	 */
+public:
+	long M;
+	double ymean;	//with M and inputHash, identifies the input the state belongs to
+	uint64_t inputHash;	//boost::hash_range() of the input values
+	double sigma2;
+	double a;
+	vector<long> I;
+	vector<double> alpha;
+	vector<double> w;
+
+	SBLState():
+		M(0), ymean(0), inputHash(0), sigma2(0), a(0){
+	}
+	bool matches(long _M, double _ymean, uint64_t _inputHash) const {
+		return M > 0 && M == _M && ymean == _ymean && inputHash == _inputHash;
+	}
+	//binary file. Both return false on an I/O error or, for load(), a file that is not an SBL state file.
+	bool save(const string &path) const;
+	bool load(const string &path);
+};
+
 typedef set<BreakPoint*> rbNodeDataType;
 typedef RedBlackTree<BreakPointKey, rbNodeDataType > treeType;
 typedef RedBlackTreeNode<BreakPointKey, rbNodeDataType > rbNodeType;
@@ -382,6 +492,26 @@ public:
 	double ymean;	//mean of inputDataArray
 	int reportIntervalDuringBE;	// how often to report progress during backward elimination, default is 100K
 
+	double prefilterThreshold;	// Haar step score a position needs to enter the initial SBL basis. <=0 disables the prefilter (full basis).
+	int prefilterNoOfScales;	// number of dyadic Haar scales (window half-widths 1,2,4,...) scanned by the prefilter
+	long prefilterMargin;	// positions within this distance of a prefilter hit are kept as well
+	long noOfBreakpointsBeforeSBL;	// size of the initial SBL basis, M-1 without the prefilter
+
+	int segmentationEngine;	// kEngineSBL (default) or kEnginePELT, used by runSegmentation()
+	double peltPenalty;	// PELT penalty per breakpoint in units of sigma2. <=0 means 2*log(M) (BIC)
+	long peltNoOfCandidatesEvaluated;	// PELT work counter, the analog of numEMsteps
+
+	SBLAdaptiveStop adaptiveStop;	// adaptive stopping rule for the SBL EM loop, off by default
+	bool stoppedAdaptively;	// whether the last SBL run was ended by adaptiveStop
+	bool collectSBLTelemetry;	// record every SBL EM iteration into sblTelemetry
+	vector<SBLIterationRecord> sblTelemetry;
+	GADAWorkspace *workspace;	// scratch arrays of SBL() and normalized_data_array come from here if not NULL
+	SBLState *sblState;	// if not NULL: warm start from it if it matches the input, and receives the converged state
+	bool warmStarted;	// whether the last SBL run started from sblState
+	double beSeconds;	// wall-clock time of the last backward elimination, the rest of runSegmentation() is SBL/PELT
+	size_t sblScratchBytes;	// scratch arrays of the last SBL() run, held only while it runs
+	size_t beStructureBytes;	// approximate breakpoint objects, tree and scores of the last BE, held only while it runs
+
 	BaseGADA(double* _inputDataArray, long _M, double _sigma2, double _BaseAmp, double _a, double _T, long _MinSegLen,
 			long _debug , double _convergenceDelta,
 			long _maxNoOfIterations, double _convergenceMaxAlpha, double _convergenceB, int _reportIntervalDuringBE):
@@ -391,12 +521,39 @@ public:
 			maxNoOfIterations (_maxNoOfIterations), convergenceMaxAlpha(_convergenceMaxAlpha),
 			convergenceB(_convergenceB), reportIntervalDuringBE(_reportIntervalDuringBE){
 		noOfBreakpointsAfterSBL = 0;
+		noOfBreakpointsBeforeSBL = 0;
+		prefilterThreshold = 0;
+		prefilterNoOfScales = 10;
+		prefilterMargin = 2;
+		segmentationEngine = kEngineSBL;
+		peltPenalty = 0;
+		peltNoOfCandidatesEvaluated = 0;
+		stoppedAdaptively = false;
+		collectSBLTelemetry = false;
+		workspace = NULL;
+		sblState = NULL;
+		warmStarted = false;
+		beSeconds = 0;
+		sblScratchBytes = 0;
+		beStructureBytes = 0;
+		Wext = NULL;
+		Iext = NULL;
+		_tscore_array = NULL;
+		normalized_data_array = NULL;
+		SegLen = NULL;
+		SegAmp = NULL;
+		SegState = NULL;
+		_alpha_array = NULL;
+		_aux_array = NULL;
 	}
 	~BaseGADA(){
 		//free(SegLen);
 		//free(SegAmp);
 		//free(SegState);
 	}
+	//2026.10.18 frees Iext, Wext, SegLen, SegAmp, SegState and the SBL arrays. Not done in the destructor
+	// because callers copy BaseGADA by value and keep using the arrays.
+	void releaseArrays();
 	void reconstruct(double *wr, long M_total_length, double *aux_vec);
 	void BubbleSort(long *I, long L);
 	void doubleBubbleSort(double *D, long *I, long L);
@@ -444,8 +601,34 @@ public:
 			//To eliminate...
 			double *Scores, long Nscores, double *wr, long *indsel,
 			long *pointNumRem, double *pointTau);
+	//appends one SBLIterationRecord if collectSBLTelemetry is set and restarts the iteration clock.
+	void recordSBLIteration(long n, long K, double delta, std::chrono::steady_clock::time_point &iterationStart);
+	//2026.10.18 bytes of the arrays this object holds now and of the transient SBL and BE structures at their peak
+	void appendStructureBytes(vector<pair<string, size_t> > &structureBytesVec) const;
+	//writes sblTelemetry as TSV (iteration, K, delta, microseconds), prefixed by a label column if not empty.
+	void writeSBLTelemetry(std::ostream &out, const string &label, bool writeHeader);
+
 	//Returns breakpoint list lenght.
 	long SBLandBE();
+	//SBLandBE() in two halves around SBL().
+	//prepareSBL() normalizes the input and sets up Iext, Wext+1, _alpha_array and K for SBL().
+	void prepareSBL();
+	//finishSBLandBE() converts the SBL result to extended notation and runs backward elimination.
+	long finishSBLandBE();
+	//Same contract as SBLandBE(), PELT instead of SBL.
+	long PELTandBE();
+	//SBLandBE() or PELTandBE() depending on segmentationEngine.
+	long runSegmentation();
+	//copy inputDataArray into normalized_data_array, estimate sigma2 if negative, remove the mean.
+	void normalizeInputData();
+	//Returns the number of breakpoints (written into I in SBL notation, sorted) minimizing RSS + K*penalty.
+	long PELT(double *y, long M_total_length, double penalty, long *I);
+
+	long HaarPrefilter( //Returns the number of candidate breakpoints written into I
+			double *y, //I -- mean-removed input signal
+			long M_total_length, //I -- length of y
+			long *I //O -- sorted candidate breakpoints (SBL notation, 0..M_total_length-2)
+			);
 
 	void Project(double *y, long M_total_length, long *I, long L, double *xI, double *wI);
 	void IextToSegLen();
@@ -21,7 +21,9 @@
  */
 #include <boost/program_options.hpp>  //for program options
 #include <boost/tokenizer.hpp>
+#include <chrono>
 #include "BaseGADA.h"
+#include "GADASegmentation.h"
 #include "read_para.h"
 
 using namespace std;
@@ -74,6 +76,22 @@ class GADA
     double convergenceMaxAlpha;  // 1E8 Maximum number of iterations to reach
                                  // convergence...
     double convergenceB;         // a number related to convergence = 1E-20
+    double prefilterThreshold;   // Haar prefilter score threshold, <=0 means full SBL basis
+    int prefilterNoOfScales;
+    long prefilterMargin;
+    int benchmark;  // 1: also run the full-basis SBL and compare
+    string engineName;  // SBL or PELT
+    int segmentationEngine;
+    double peltPenalty;
+    long adaptiveStopWindow;  // 0: off
+    double adaptiveStopDeltaRatio;
+    string telemetryFilePath;  // per-iteration SBL telemetry, empty: off
+    string sblStateFilePath;  // warm start SBL from / save the converged SBL state to, empty: off
+    string incrementalStateFilePath;  // empty: segment the whole input
+    long incrementalMargin;
+    double incrementalMaxChangedFraction;
+    string profileFilePath;  // per-phase timing and counters as JSON, empty: off
+    RunProfile profile;
 
     string input_file_path;
     string output_file_path;
@@ -95,11 +113,9 @@ class GADA
     po::variables_map optionVariableMap;
 
     std::ifstream inputFile;
-    std::ofstream outputFile;
+    RowWriter outputWriter;  // 2026.10.18 gzip-compressed if output_file_path ends in .gz
     boost::iostreams::filtering_streambuf<boost::iostreams::input>
         inputFilterStreamBuffer;
-    boost::iostreams::filtering_streambuf<boost::iostreams::output>
-        outputFilterStreamBuffer;
 
     // 2013.08.28 stream causes error " note: synthesized method ... required
     // here" because stream is noncopyable.
@@ -110,6 +126,8 @@ class GADA
         boost::iostreams::filtering_streambuf<boost::iostreams::input> &
             inputFilterStreamBuffer);
     void readInputFile();
+    void resegmentIncrementally(BaseGADA &baseGADA);
+    void recordMemory(const string &checkpointName, const BaseGADA *baseGADA);
 
     virtual void openOutputFile();
     virtual void closeFiles();
@@ -187,6 +205,50 @@ void GADA::constructOptionDescriptionStructure()
              "one convergence related number, not sure what it does.")
             ("convergenceB", po::value<double>(&convergenceB)->default_value(1E-20),
              "one convergence related number, not sure what it does")
+            ("prefilterThreshold", po::value<double>(&prefilterThreshold)->default_value(0),
+             "Haar wavelet prefilter: only positions whose multiscale step score "
+                     "(|mean difference| in units of noise stddev) reaches this value, plus a margin, "
+                     "enter the initial SBL basis. 3 is a safe choice. <=0 disables it and SBL "
+                     "starts from all M-1 positions.")
+            ("prefilterNoOfScales", po::value<int>(&prefilterNoOfScales)->default_value(10),
+             "number of dyadic scales (half-window 1,2,4,...) scanned by the Haar prefilter")
+            ("prefilterMargin", po::value<long>(&prefilterMargin)->default_value(2),
+             "positions within this many windows of a prefilter hit are kept as well")
+            ("engine", po::value<string>(&engineName)->default_value("SBL"),
+             "segmentation engine before backward elimination. SBL: sparse Bayesian learning (EM, "
+                     "bounded by maxNoOfIterations). PELT: penalized exact change-point detection with "
+                     "pruning, near-linear time. T and MinSegLen apply to both.")
+            ("peltPenalty", po::value<double>(&peltPenalty)->default_value(0),
+             "PELT penalty per breakpoint in units of sigma2. <=0 means 2*log(no of data points) (BIC).")
+            ("adaptiveStopWindow", po::value<long>(&adaptiveStopWindow)->default_value(0),
+             "adaptive stopping for SBL: end EM once the number of active breakpoints has not changed "
+                     "for this many iterations and delta has plateaued (see adaptiveStopDeltaRatio). "
+                     "0 disables it and EM runs until convergenceDelta or maxNoOfIterations.")
+            ("adaptiveStopDeltaRatio", po::value<double>(&adaptiveStopDeltaRatio)->default_value(0.9),
+             "delta has plateaued if it is still above this fraction of its value adaptiveStopWindow "
+                     "iterations earlier")
+            ("telemetryFilePath", po::value<string>(&telemetryFilePath)->default_value(""),
+             "write one line per SBL EM iteration (chromosome_id, iteration, active K after basis reduction, "
+                     "delta, microseconds) to this TSV file")
+            ("sblStateFilePath", po::value<string>(&sblStateFilePath)->default_value(""),
+             "warm start: if this file holds the converged SBL state (active breakpoints, alpha, weights) of "
+                     "the same input, EM continues from it instead of the full basis, e.g. after changing a or "
+                     "sigma2. The converged state of this run is written to it afterwards. Breakpoints pruned "
+                     "in the saved run can not come back.")
+            ("profileFilePath", po::value<string>(&profileFilePath)->default_value(""),
+             "write the time spent reading, segmenting (SBL or PELT), in backward elimination and writing, and "
+                     "counters (data points, EM iterations, breakpoints removed by BE), as JSON to this file")
+            ("incrementalStateFilePath", po::value<string>(&incrementalStateFilePath)->default_value(""),
+             "incremental mode: the breakpoints, weights and segment sums of this chromosome are kept in "
+                     "this file. If it exists, SBL+BE only re-runs on the windows whose values changed or were "
+                     "appended since the last run (plus incrementalMargin, widened to the previous breakpoints) "
+                     "and the result is merged with the untouched segments. The file is (re)written after the run.")
+            ("incrementalMargin", po::value<long>(&incrementalMargin)->default_value(10),
+             "data points added on both sides of a changed run before it is widened to the previous breakpoints")
+            ("incrementalMaxChangedFraction", po::value<double>(&incrementalMaxChangedFraction)->default_value(0.5),
+             "segment the whole chromosome again if the windows to re-run cover more than this fraction of it")
+            ("benchmark", "toggle benchmark mode: also run the full-basis SBL+BE on the same input, "
+                    "report the running time of both and how well the breakpoints agree.")
             ("debug,b", "toggle debug mode")
             ("report,r", "toggle report mode")
             ("reportIntervalDuringBE", po::value<int>(&reportIntervalDuringBE)->default_value(100000),
@@ -239,6 +301,20 @@ void GADA::parseCommandlineOptions()
     {
         report = 0;
     }
+    segmentationEngine = segmentationEngineFromName(engineName);
+    if (segmentationEngine < 0)
+    {
+        cerr << "ERROR: unknown segmentation engine " << engineName << ". Choose SBL or PELT." << endl;
+        exit(2);
+    }
+    if (optionVariableMap.count("benchmark"))
+    {
+        benchmark = 1;
+    }
+    else
+    {
+        benchmark = 0;
+    }
 }
 
 void GADA::openOneInputFile(
@@ -303,24 +379,8 @@ void GADA::openOutputFile()
     if (!output_file_path.empty())
     {
         std::cerr << "Open file " << output_file_path << " for writing ";
-        int outputFnameLength = output_file_path.length();
-        if (output_file_path.substr(outputFnameLength - 3, 3) == ".gz")
-        {
-            // boost::iostreams::gzip_compressor gzipCompressor;
-            outputFilterStreamBuffer.push(boost::iostreams::gzip_compressor());
-            // outputFilterStreamBuffer.push(boost::iostreams::base64_encoder());
-            // outputFile.open(output_file_path.c_str(), std::ios::out |
-            // std::ios::binary);
-            outputFile.open(output_file_path.c_str(),
-                            std::ios::out | std::ios::binary);
-        }
-        else
-        {
-            outputFile.open(output_file_path.c_str(), std::ios::out);
-        }
-        outputFilterStreamBuffer.push(outputFile);
-        // outputStream.rdbuf(&outputFilterStreamBuffer);
-        //(&outputFilterStreamBuffer);
+        if (!outputWriter.open(output_file_path))
+            std::cerr << "Error: could not open " << output_file_path;
         std::cerr << endl;
     }
     else
@@ -338,12 +398,8 @@ void GADA::closeFiles()
     if (!output_file_path.empty())
     {
 
-        // delete outputFilterStreamBuffer;
-        outputFile.flush();
-        // outputFile.close();	//2013.08.21 if output is a .gz, closing it
-        // here would result a truncated .gz file. don't know why.
-        // maybe because the buffer or the gzip compressor filter needs to be
-        // closed beforehand.
+        if (!outputWriter.close())
+            std::cerr << "Error: could not write " << output_file_path;
     }
     std::cerr << std::endl;
 }
@@ -351,23 +407,199 @@ void GADA::closeFiles()
 
 
 
+/*
+ * Count breakpoints of segmentation A that have a breakpoint of B within tolerance windows.
+ * Both are in extended notation (Iext[0]=0, Iext[K+1]=M).
+ */
+long countMatchedBreakpoints(const long *IextA, long KA, const long *IextB, long KB, long tolerance)
+{
+    long noOfMatched = 0;
+    long j = 1;
+    for (long i = 1; i <= KA; i++)
+    {
+        while (j <= KB && IextB[j] < IextA[i] - tolerance)
+        {
+            j++;
+        }
+        if (j <= KB && IextB[j] <= IextA[i] + tolerance)
+        {
+            noOfMatched++;
+        }
+    }
+    return noOfMatched;
+}
+
+// 2026.10.18 memory snapshot for the profile: the input and what baseGADA holds, if it exists yet
+void GADA::recordMemory(const string &checkpointName, const BaseGADA *baseGADA)
+{
+    if (profileFilePath.empty())
+        return;
+    RunProfile::StructureBytes structureBytesVec;
+    structureBytesVec.push_back(make_pair(string("input"), input_array_len * sizeof(double) +
+                                                            vector_bytes(chr_start_pos_vector)));
+    if (baseGADA != NULL)
+        baseGADA->appendStructureBytes(structureBytesVec);
+    profile.addMemorySnapshot(checkpointName, structureBytesVec);
+}
+
+// 2026.10.18 runs resegmentGADA() and hands its result to baseGADA, so the output code below works unchanged.
+void GADA::resegmentIncrementally(BaseGADA &baseGADA)
+{
+    GADAIncrementalState state;
+    if (!state.load(incrementalStateFilePath))
+    {
+        std::cerr << " No incremental state in " << incrementalStateFilePath
+                  << ", segmenting the whole chromosome." << endl;
+    }
+    GADAOptions options;
+    options.sigma2 = sigma2;
+    options.BaseAmp = BaseAmp;
+    options.a = a;
+    options.T = T;
+    options.MinSegLen = MinSegLen;
+    options.convergenceDelta = convergenceDelta;
+    options.maxNoOfIterations = maxNoOfIterations;
+    options.convergenceMaxAlpha = convergenceMaxAlpha;
+    options.convergenceB = convergenceB;
+    options.segmentationEngine = segmentationEngine;
+    options.prefilterThreshold = prefilterThreshold;
+    options.prefilterNoOfScales = prefilterNoOfScales;
+    options.prefilterMargin = prefilterMargin;
+    options.peltPenalty = peltPenalty;
+    options.adaptiveStopWindow = adaptiveStopWindow;
+    options.adaptiveStopDeltaRatio = adaptiveStopDeltaRatio;
+    options.debug = debug;
+    GADAWorkspace workspace;
+    GADAResult result;
+    resegmentGADA(input_array, input_array_len, options, incrementalMargin, incrementalMaxChangedFraction,
+                  workspace, state, result);
+    if (!state.save(incrementalStateFilePath))
+    {
+        std::cerr << "Error: could not write incremental state file " << incrementalStateFilePath << endl;
+        exit(3);
+    }
+    std::cerr << boost::format(" %1% of %2% data points re-segmented in %3% windows.\n") %
+                   result.noOfResegmentedDataPoints % input_array_len % result.noOfResegmentedWindows;
+
+    baseGADA.K = result.K;
+    baseGADA.Iext = (long *)calloc(result.K + 2, sizeof(long));
+    baseGADA.Wext = (double *)calloc(result.K + 1, sizeof(double));
+    std::copy(result.Iext.begin(), result.Iext.end(), baseGADA.Iext);
+    std::copy(result.Wext.begin(), result.Wext.end(), baseGADA.Wext);
+    baseGADA.sigma2 = result.sigma2;
+    baseGADA.ymean = result.ymean;
+    baseGADA.noOfBreakpointsBeforeSBL = result.noOfBreakpointsBeforeSBL;
+    baseGADA.noOfBreakpointsAfterSBL = result.noOfBreakpointsAfterSBL;
+    baseGADA.numEMsteps = result.numEMsteps;
+    baseGADA.delta = result.delta;
+    baseGADA.stoppedAdaptively = result.stoppedAdaptively;
+}
+
 void GADA::run()
 {
     constructOptionDescriptionStructure();
     parseCommandlineOptions();
-    readInputFile();
+    {
+        RunProfile::ScopedPhase phase(profile, "read");
+        readInputFile();
+    }
+    recordMemory("read", NULL);
 
-    std::cerr << "Running SBLandBE ... " << endl;
+    std::cerr << "Running " << engineName << " and backward elimination ... " << endl;
     BaseGADA baseGADA =
         BaseGADA(input_array, input_array_len, sigma2, BaseAmp, a, T, MinSegLen, debug,
                  convergenceDelta, maxNoOfIterations, convergenceMaxAlpha,
                  convergenceB, reportIntervalDuringBE);
-    baseGADA.SBLandBE();
+    baseGADA.prefilterThreshold = prefilterThreshold;
+    baseGADA.prefilterNoOfScales = prefilterNoOfScales;
+    baseGADA.prefilterMargin = prefilterMargin;
+    baseGADA.segmentationEngine = segmentationEngine;
+    baseGADA.peltPenalty = peltPenalty;
+    baseGADA.adaptiveStop.window = adaptiveStopWindow;
+    baseGADA.adaptiveStop.deltaRatio = adaptiveStopDeltaRatio;
+    baseGADA.collectSBLTelemetry = !telemetryFilePath.empty();
+    SBLState sblState;
+    if (!sblStateFilePath.empty())
+    {
+        sblState.load(sblStateFilePath);
+        baseGADA.sblState = &sblState;
+    }
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    if (incrementalStateFilePath.empty())
+        baseGADA.runSegmentation();
+    else
+        resegmentIncrementally(baseGADA);
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (incrementalStateFilePath.empty())
+    {
+        profile.addPhaseSeconds(engineName, runSeconds - baseGADA.beSeconds);
+        profile.addPhaseSeconds("backward_elimination", baseGADA.beSeconds);
+    }
+    else
+    {
+        profile.addPhaseSeconds("resegmentation", runSeconds);
+    }
+    recordMemory("segmentation", &baseGADA);
+    std::cerr << boost::format(" %1% candidate breakpoints before SBL, %2% EM iterations%3%, %4% seconds.\n") %
+                   baseGADA.noOfBreakpointsBeforeSBL % baseGADA.numEMsteps %
+                   (baseGADA.stoppedAdaptively ? " (stopped adaptively)" : "") % runSeconds;
+    if (!sblStateFilePath.empty() && segmentationEngine == kEngineSBL && incrementalStateFilePath.empty())
+    {
+        if (baseGADA.warmStarted)
+        {
+            std::cerr << " Warm-started SBL from " << sblStateFilePath << "." << endl;
+        }
+        if (!sblState.save(sblStateFilePath))
+        {
+            std::cerr << "Error: could not write SBL state file " << sblStateFilePath << endl;
+            exit(3);
+        }
+    }
+    if (!telemetryFilePath.empty())
+    {
+        std::ofstream telemetryFile(telemetryFilePath.c_str());
+        if (!telemetryFile)
+        {
+            std::cerr << "Error: could not open telemetry file " << telemetryFilePath << endl;
+            exit(3);
+        }
+        baseGADA.writeSBLTelemetry(telemetryFile, chromosome_id, true);
+        std::cerr << boost::format(" %1% SBL iterations written to %2%.\n") %
+                       baseGADA.sblTelemetry.size() % telemetryFilePath;
+    }
+
+    if (benchmark)
+    {
+        RunProfile::ScopedPhase phase(profile, "benchmark");
+        std::cerr << "Benchmark: running the full-basis SBLandBE (no adaptive stop) as reference ... " << endl;
+        BaseGADA referenceGADA =
+            BaseGADA(input_array, input_array_len, sigma2, BaseAmp, a, T, MinSegLen, debug,
+                     convergenceDelta, maxNoOfIterations, convergenceMaxAlpha,
+                     convergenceB, reportIntervalDuringBE);
+        startTime = std::chrono::steady_clock::now();
+        referenceGADA.SBLandBE();
+        double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        for (long tolerance = 0; tolerance <= 2; tolerance++)
+        {
+            std::cerr << boost::format("Benchmark: tolerance=%1% windows, %2% of %3% breakpoints in this run and "
+                                       "%4% of %5% reference breakpoints matched.\n") %
+                             tolerance %
+                             countMatchedBreakpoints(baseGADA.Iext, baseGADA.K, referenceGADA.Iext, referenceGADA.K, tolerance) %
+                             baseGADA.K %
+                             countMatchedBreakpoints(referenceGADA.Iext, referenceGADA.K, baseGADA.Iext, baseGADA.K, tolerance) %
+                             referenceGADA.K;
+        }
+        std::cerr << boost::format("Benchmark: this run %1% seconds (%2% initial candidates, %3% EM iterations), "
+                                   "reference %4% seconds (%5% initial candidates, %6% EM iterations), speedup %7%.\n") %
+                         runSeconds % baseGADA.noOfBreakpointsBeforeSBL % baseGADA.numEMsteps %
+                         referenceSeconds % referenceGADA.noOfBreakpointsBeforeSBL % referenceGADA.numEMsteps %
+                         (referenceSeconds / max(runSeconds, 1E-9));
+    }
     // K = SBLandBE(input_array, input_array_len, &sigma2, a, T, MinSegLen, &Iext, &Wext, debug ,
     // delta, numEMsteps, noOfBreakpointsAfterSBL, convergenceDelta,
     // maxNoOfIterations, convergenceMaxAlpha, convergenceB);
-    std::cerr << boost::format(" %1% breakpoints after SBL, %2% breakpoints after BE.\n") %
-                   baseGADA.noOfBreakpointsAfterSBL % baseGADA.K;
+    std::cerr << boost::format(" %1% breakpoints after %2%, %3% breakpoints after BE.\n") %
+                   baseGADA.noOfBreakpointsAfterSBL % engineName % baseGADA.K;
     // std::cerr<< boost::format("Backward elimination (T=%2%) and remove
     // segments that are shorter than %1% ... ") % MinSegLen % T;
     std::cerr << boost::format(
@@ -378,33 +610,27 @@ void GADA::run()
 
     std::cerr << " IextToSegLen() & IextWextToSegAmp() done." << endl;
     std::cerr << "Outputting final result ... ";
+    RunProfile::ScopedPhase output_phase(profile, "output");
     openOutputFile();  // 2013.08.30 open this file here. Do not open it way
                        // before the main writing starts.
     // it will leave a long period of zero-writing-activity (due to
     // computation), which could hang the program sometimes on panfs system
 
-    std::ostream outputStream(&outputFilterStreamBuffer);
-
     //outputStream << "# GADA Genome Alteration Detection Algorithm\n";
     //outputStream << "# Author: www.yfish.org polyactis@gmail.com. Originally from Roger Pique-Regi\n";
-    outputStream << boost::format(
+    outputWriter.write("{}", str(boost::format(
             "# Parameters: a=%1%,T=%2%,MinSegLen=%3%,sigma2=%4%,BaseAmp=%5%, convergenceDelta=%6%, maxNoOfIterations=%7%, "
                     "convergenceMaxAlpha=%8%, convergenceB=%9%.\n") %
             baseGADA.a % baseGADA.T % baseGADA.MinSegLen %
             baseGADA.sigma2 % baseGADA.BaseAmp %
             baseGADA.convergenceDelta % baseGADA.maxNoOfIterations %
-            baseGADA.convergenceMaxAlpha % baseGADA.convergenceB;
-    outputStream << boost::format("# %1% data points in input file\n") %
-                        baseGADA._M_total_length;
-    outputStream << boost::format("# Overall mean %1%\n") % baseGADA.Wext[0];
-    outputStream << boost::format("# Sigma^2=%1%\n") % baseGADA.sigma2;
-    outputStream << boost::format(
-                        "# Convergence: delta=%1% after %2% EM iterations.\n") %
-                        baseGADA.delta % baseGADA.numEMsteps;
-    outputStream << boost::format("# Found %1% breakpoints after SBL\n") %
-                        baseGADA.noOfBreakpointsAfterSBL;
-    outputStream << boost::format("# Kept %1% breakpoints after BE\n") %
-                        baseGADA.K;
+            baseGADA.convergenceMaxAlpha % baseGADA.convergenceB));
+    outputWriter.write("# {} data points in input file\n", baseGADA._M_total_length);
+    outputWriter.write("# Overall mean {:g}\n", baseGADA.Wext[0]);
+    outputWriter.write("# Sigma^2={:g}\n", baseGADA.sigma2);
+    outputWriter.write("# Convergence: delta={:g} after {} EM iterations.\n", baseGADA.delta, baseGADA.numEMsteps);
+    outputWriter.write("# Found {} breakpoints after {}\n", baseGADA.noOfBreakpointsAfterSBL, engineName);
+    outputWriter.write("# Kept {} breakpoints after BE\n", baseGADA.K);
 
 
     if (SelectClassifySegments == 0)
@@ -416,12 +642,8 @@ void GADA::run()
             float segment_mean;
             float segment_stddev;
             calculate_robust_mean_stddev(input_array, baseGADA.Iext[i], baseGADA.Iext[i+1], 40, segment_mean, segment_stddev);
-            outputStream << chromosome_id << "\t" << chr_start_pos
-                         << "\t" << chr_stop_pos
-                         << "\t" << segment_mean
-                         << "\t" << segment_stddev
-                         << "\t" << baseGADA.SegLen[i]
-                         << std::endl;
+            outputWriter.write("{}\t{}\t{}\t{:g}\t{:g}\t{}\n", chromosome_id, chr_start_pos, chr_stop_pos,
+                               segment_mean, segment_stddev, baseGADA.SegLen[i]);
         }
     }
     else if (SelectClassifySegments == 1)
@@ -429,33 +651,46 @@ void GADA::run()
         std::cerr << " Select and Classify Segments ...";
         if (SelectEstimateBaseAmp == 1)
         {
-            outputStream << boost::format("# Estimating BaseAmp\n");
+            outputWriter.write("# Estimating BaseAmp\n");
             baseGADA.CompBaseAmpMedianMethod();
         }
-        outputStream << boost::format("# BaseAmp=%1% \n") % baseGADA.BaseAmp;
+        outputWriter.write("# BaseAmp={:g} \n", baseGADA.BaseAmp);
         // outputStream<< boost::format("# Classify Segments \n", BaseAmp);
 
         baseGADA.CollapseAmpTtest();
 
         std::cerr << " SelectClassifySegments done.\n";
 
-        outputStream << boost::format("Start\tStop\tLength\tAmpl\tState\n");
+        outputWriter.write("Start\tStop\tLength\tAmpl\tState\n");
         for (int i = 0; i < baseGADA.K + 1; i++)
         {
-            outputStream << baseGADA.Iext[i] + 1 << "\t" << baseGADA.Iext[i + 1]
-                         << "\t" << baseGADA.SegLen[i] << "\t"
-                         << baseGADA.SegAmp[i];
+            const char *state = "N";
             if (baseGADA.SegState[i] > baseGADA.BaseAmp)
-                outputStream << "G";
+                state = "G";
             else if (baseGADA.SegState[i] < baseGADA.BaseAmp)
-                outputStream << "L";
-            else
-                outputStream << "N";
-            outputStream << endl;
+                state = "L";
+            //no tab before the state, as the stream output before RowWriter wrote it
+            outputWriter.write("{}\t{}\t{}\t{:g}{}\n", baseGADA.Iext[i] + 1, baseGADA.Iext[i + 1],
+                               baseGADA.SegLen[i], baseGADA.SegAmp[i], state);
         }
     }
     std::cerr << " output done." << endl;
     closeFiles();
+    output_phase.stop();
+    recordMemory("output", &baseGADA);
+    if (!profileFilePath.empty())
+    {
+        profile.setCount("data_points", input_array_len);
+        profile.setCount("em_iterations", baseGADA.numEMsteps);
+        profile.setCount("breakpoints_before_sbl", baseGADA.noOfBreakpointsBeforeSBL);
+        profile.setCount("breakpoints_after_sbl", baseGADA.noOfBreakpointsAfterSBL);
+        profile.setCount("be_removals", baseGADA.noOfBreakpointsAfterSBL - baseGADA.K);
+        profile.setCount("segments", baseGADA.K + 1);
+        if (segmentationEngine == kEnginePELT)
+            profile.setCount("pelt_candidates_evaluated", baseGADA.peltNoOfCandidatesEvaluated);
+        if (!profile.writeJSON(profileFilePath, "GADA"))
+            std::cerr << "Error: could not write profile file " << profileFilePath << endl;
+    }
 }
 
 int main(int argc, char *argv[])
@@ -0,0 +1,301 @@
+/*=================================================================
+ * GADASegmentation.cc
+ * Library entry point, see GADASegmentation.h.
+ *=================================================================*/
+#include "GADASegmentation.h"
+
+long segmentGADA(const double *y, long M, const GADAOptions &options, GADAWorkspace &workspace, GADAResult &result) {
+	result = GADAResult();
+	if (M < 1)
+		return -1;
+	if (M == 1) {
+		//one segment, nothing for SBL to do
+		result.Iext.push_back(0);
+		result.Iext.push_back(1);
+		result.Wext.push_back(y[0]);
+		result.SegLen.push_back(1);
+		result.SegAmp.push_back(y[0]);
+		//no adjacent differences to estimate the noise variance from
+		result.sigma2 = options.sigma2 < 0 ? 0 : options.sigma2;
+		result.ymean = y[0];
+		result.noOfResegmentedDataPoints = 1;
+		result.noOfResegmentedWindows = 1;
+		return 0;
+	}
+	//BaseGADA only reads inputDataArray (normalizeInputData() copies it into the workspace).
+	BaseGADA baseGADA(const_cast<double*>(y), M, options.sigma2, options.BaseAmp, options.a, options.T,
+			options.MinSegLen, options.debug, options.convergenceDelta, options.maxNoOfIterations,
+			options.convergenceMaxAlpha, options.convergenceB, 100000);
+	baseGADA.workspace = &workspace;
+	baseGADA.segmentationEngine = options.segmentationEngine;
+	baseGADA.prefilterThreshold = options.prefilterThreshold;
+	baseGADA.prefilterNoOfScales = options.prefilterNoOfScales;
+	baseGADA.prefilterMargin = options.prefilterMargin;
+	baseGADA.peltPenalty = options.peltPenalty;
+	baseGADA.adaptiveStop.window = options.adaptiveStopWindow;
+	baseGADA.adaptiveStop.deltaRatio = options.adaptiveStopDeltaRatio;
+	baseGADA.collectSBLTelemetry = options.collectSBLTelemetry;
+	baseGADA.numEMsteps = 0;
+	baseGADA.delta = 0;
+
+	baseGADA.runSegmentation();
+	baseGADA.IextToSegLen();
+	baseGADA.IextWextToSegAmp();
+
+	result.K = baseGADA.K;
+	result.Iext.assign(baseGADA.Iext, baseGADA.Iext + baseGADA.K + 2);
+	result.Wext.assign(baseGADA.Wext, baseGADA.Wext + baseGADA.K + 1);
+	result.SegLen.assign(baseGADA.SegLen, baseGADA.SegLen + baseGADA.K + 1);
+	result.SegAmp.assign(baseGADA.SegAmp, baseGADA.SegAmp + baseGADA.K + 1);
+	result.sigma2 = baseGADA.sigma2;
+	result.ymean = baseGADA.ymean;
+	result.noOfBreakpointsBeforeSBL = baseGADA.noOfBreakpointsBeforeSBL;
+	result.noOfBreakpointsAfterSBL = baseGADA.noOfBreakpointsAfterSBL;
+	result.numEMsteps = baseGADA.numEMsteps;
+	result.delta = baseGADA.delta;
+	result.stoppedAdaptively = baseGADA.stoppedAdaptively;
+	result.sblTelemetry.swap(baseGADA.sblTelemetry);
+	result.noOfResegmentedDataPoints = M;
+	result.noOfResegmentedWindows = 1;
+	baseGADA.releaseArrays();
+	return result.K;
+}
+
+static const char incrementalStateMagic[8] = {'G', 'A', 'D', 'A', 'I', 'N', 'C', '1'};
+
+bool GADAIncrementalState::save(const string &path) const {
+	std::ofstream stateFile(path.c_str(), std::ios::binary);
+	if (!stateFile)
+		return false;
+	long M = (long) y.size();
+	long K = this->K();
+	stateFile.write(incrementalStateMagic, sizeof(incrementalStateMagic));
+	stateFile.write((const char*) &M, sizeof(long));
+	stateFile.write((const char*) &K, sizeof(long));
+	stateFile.write((const char*) &sigma2, sizeof(double));
+	stateFile.write((const char*) y.data(), M * sizeof(double));
+	stateFile.write((const char*) Iext.data(), (K + 2) * sizeof(long));
+	stateFile.write((const char*) Wext.data(), (K + 1) * sizeof(double));
+	stateFile.write((const char*) segmentSum.data(), (K + 1) * sizeof(double));
+	stateFile.write((const char*) segmentSumOfSquares.data(), (K + 1) * sizeof(double));
+	return (bool) stateFile;
+}
+
+bool GADAIncrementalState::load(const string &path) {
+	std::ifstream stateFile(path.c_str(), std::ios::binary);
+	if (!stateFile)
+		return false;
+	char magic[sizeof(incrementalStateMagic)];
+	long M, K;
+	stateFile.read(magic, sizeof(magic));
+	stateFile.read((char*) &M, sizeof(long));
+	stateFile.read((char*) &K, sizeof(long));
+	stateFile.read((char*) &sigma2, sizeof(double));
+	if (!stateFile || memcmp(magic, incrementalStateMagic, sizeof(magic)) != 0 || M < 1 || K < 0 || K >= M)
+		return false;
+	y.resize(M);
+	Iext.resize(K + 2);
+	Wext.resize(K + 1);
+	segmentSum.resize(K + 1);
+	segmentSumOfSquares.resize(K + 1);
+	stateFile.read((char*) y.data(), M * sizeof(double));
+	stateFile.read((char*) Iext.data(), (K + 2) * sizeof(long));
+	stateFile.read((char*) Wext.data(), (K + 1) * sizeof(double));
+	stateFile.read((char*) segmentSum.data(), (K + 1) * sizeof(double));
+	stateFile.read((char*) segmentSumOfSquares.data(), (K + 1) * sizeof(double));
+	if (!stateFile || Iext[0] != 0 || Iext[K + 1] != M) {
+		*this = GADAIncrementalState();
+		return false;
+	}
+	return true;
+}
+
+//sums of y and y^2 over [start, end)
+static void sumSegment(const double *y, long start, long end, double &sum, double &sumOfSquares) {
+	sum = 0;
+	sumOfSquares = 0;
+	for (long i = start; i < end; i++) {
+		sum += y[i];
+		sumOfSquares += y[i] * y[i];
+	}
+}
+
+//state := the run that produced result on y
+static void storeIncrementalState(const double *y, long M, const GADAResult &result, const vector<double> &segmentSum,
+		const vector<double> &segmentSumOfSquares, GADAIncrementalState &state) {
+	state.y.assign(y, y + M);
+	state.sigma2 = result.sigma2;
+	state.Iext = result.Iext;
+	state.Wext = result.Wext;
+	state.segmentSum = segmentSum;
+	state.segmentSumOfSquares = segmentSumOfSquares;
+}
+
+static long segmentAndStore(const double *y, long M, const GADAOptions &options, GADAWorkspace &workspace,
+		GADAIncrementalState &state, GADAResult &result) {
+	if (segmentGADA(y, M, options, workspace, result) < 0)
+		return -1;
+	vector<double> segmentSum(result.K + 1), segmentSumOfSquares(result.K + 1);
+	for (long k = 0; k <= result.K; k++)
+		sumSegment(y, result.Iext[k], result.Iext[k + 1], segmentSum[k], segmentSumOfSquares[k]);
+	storeIncrementalState(y, M, result, segmentSum, segmentSumOfSquares, state);
+	return result.K;
+}
+
+//result from a breakpoint set with weights, optionally after backward elimination with options.T and options.MinSegLen
+static void fillResultFromIextWext(const double *y, long M, const GADAOptions &options, double sigma2,
+		const vector<long> &Iext, const vector<double> &Wext, bool backwardElimination, GADAResult &result) {
+	BaseGADA baseGADA(const_cast<double*>(y), M, sigma2, options.BaseAmp, options.a, options.T,
+			options.MinSegLen, options.debug, options.convergenceDelta, options.maxNoOfIterations,
+			options.convergenceMaxAlpha, options.convergenceB, 100000);
+	baseGADA.K = (long) Iext.size() - 2;
+	baseGADA.Iext = (long*) malloc(Iext.size() * sizeof(long));
+	baseGADA.Wext = (double*) malloc(Wext.size() * sizeof(double));
+	std::copy(Iext.begin(), Iext.end(), baseGADA.Iext);
+	std::copy(Wext.begin(), Wext.end(), baseGADA.Wext);
+	baseGADA.ymean = Wext[0];
+	if (backwardElimination)
+		baseGADA.BEwTandMinLen(baseGADA.Wext, baseGADA.Iext, &baseGADA.K, baseGADA.sigma2, baseGADA.T,
+				baseGADA.MinSegLen, baseGADA.debug);
+	baseGADA.IextToSegLen();
+	baseGADA.IextWextToSegAmp();
+
+	result = GADAResult();
+	result.K = baseGADA.K;
+	result.Iext.assign(baseGADA.Iext, baseGADA.Iext + baseGADA.K + 2);
+	result.Wext.assign(baseGADA.Wext, baseGADA.Wext + baseGADA.K + 1);
+	result.SegLen.assign(baseGADA.SegLen, baseGADA.SegLen + baseGADA.K + 1);
+	result.SegAmp.assign(baseGADA.SegAmp, baseGADA.SegAmp + baseGADA.K + 1);
+	result.sigma2 = baseGADA.sigma2;
+	result.ymean = baseGADA.ymean;
+	baseGADA.releaseArrays();
+}
+
+long resegmentGADA(const double *y, long M, const GADAOptions &options, long margin, double maxChangedFraction,
+		GADAWorkspace &workspace, GADAIncrementalState &state, GADAResult &result) {
+	long Mold = (long) state.y.size();
+	long i, k, start, end;
+	if (state.empty() || M < Mold || M < 2 || state.sigma2 <= 0)
+		return segmentAndStore(y, M, options, workspace, state, result);
+	margin = max(margin, 0L);
+
+	//windows [start, end) around changed values, merged where they overlap
+	vector<long> windowStart, windowEnd;
+	for (i = 0; i < M; i++) {
+		if (i < Mold && y[i] == state.y[i])
+			continue;
+		start = max(i - margin, 0L);
+		end = (i < Mold) ? min(i + margin + 1, M) : M;
+		if (!windowEnd.empty() && start <= windowEnd.back())
+			windowEnd.back() = max(windowEnd.back(), end);
+		else {
+			windowStart.push_back(start);
+			windowEnd.push_back(end);
+		}
+		if (i >= Mold)
+			break;
+	}
+	if (windowStart.empty()) {
+		//nothing changed, the previous breakpoints stand
+		fillResultFromIextWext(y, M, options, state.sigma2, state.Iext, state.Wext, false, result);
+		result.noOfBreakpointsAfterSBL = result.K;
+		return result.K;
+	}
+
+	//widen each window out to the previous breakpoints (the appended tail reaches M) and merge again
+	const vector<long> &oldIext = state.Iext;
+	vector<long> regionStart, regionEnd;
+	long noOfResegmentedDataPoints = 0;
+	for (size_t w = 0; w < windowStart.size(); w++) {
+		start = *(std::upper_bound(oldIext.begin(), oldIext.end(), windowStart[w]) - 1);
+		end = (windowEnd[w] > Mold) ? M : *std::lower_bound(oldIext.begin(), oldIext.end(), windowEnd[w]);
+		if (!regionEnd.empty() && start <= regionEnd.back())
+			regionEnd.back() = max(regionEnd.back(), end);
+		else {
+			regionStart.push_back(start);
+			regionEnd.push_back(end);
+		}
+	}
+	for (size_t r = 0; r < regionStart.size(); r++)
+		noOfResegmentedDataPoints += regionEnd[r] - regionStart[r];
+	if (noOfResegmentedDataPoints > maxChangedFraction * M)
+		return segmentAndStore(y, M, options, workspace, state, result);
+
+	//breakpoints: old ones outside every region, region boundaries, and those found inside each region
+	GADAOptions regionOptions = options;
+	regionOptions.sigma2 = state.sigma2;
+	regionOptions.collectSBLTelemetry = false;
+	GADAResult regionResult;
+	vector<long> breakpoints;
+	long numEMsteps = 0, noOfBreakpointsBeforeSBL = 0;
+	size_t r = 0;
+	for (k = 1; k <= state.K(); k++) {
+		while (r < regionStart.size() && regionEnd[r] <= oldIext[k])
+			r++;
+		if (r == regionStart.size() || oldIext[k] <= regionStart[r])
+			breakpoints.push_back(oldIext[k]);
+	}
+	for (r = 0; r < regionStart.size(); r++) {
+		breakpoints.push_back(regionStart[r]);
+		breakpoints.push_back(regionEnd[r]);
+		segmentGADA(y + regionStart[r], regionEnd[r] - regionStart[r], regionOptions, workspace, regionResult);
+		for (k = 1; k <= regionResult.K; k++)
+			breakpoints.push_back(regionStart[r] + regionResult.Iext[k]);
+		numEMsteps += regionResult.numEMsteps;
+		noOfBreakpointsBeforeSBL += regionResult.noOfBreakpointsBeforeSBL;
+	}
+	breakpoints.push_back(0);
+	breakpoints.push_back(M);
+	std::sort(breakpoints.begin(), breakpoints.end());
+	breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()), breakpoints.end());
+
+	//sufficient statistics of the merged segments: reused for old segments, summed up inside regions
+	long K = (long) breakpoints.size() - 2;
+	vector<double> segmentSum(K + 1), segmentSumOfSquares(K + 1);
+	r = 0;
+	for (k = 0; k <= K; k++) {
+		start = breakpoints[k];
+		end = breakpoints[k + 1];
+		while (r < regionStart.size() && regionEnd[r] <= start)
+			r++;
+		if (r == regionStart.size() || end <= regionStart[r]) {
+			vector<long>::const_iterator old = std::lower_bound(oldIext.begin(), oldIext.end(), start);
+			if (old != oldIext.end() && *old == start && old + 1 != oldIext.end() && *(old + 1) == end) {
+				segmentSum[k] = state.segmentSum[old - oldIext.begin()];
+				segmentSumOfSquares[k] = state.segmentSumOfSquares[old - oldIext.begin()];
+				continue;
+			}
+		}
+		sumSegment(y, start, end, segmentSum[k], segmentSumOfSquares[k]);
+	}
+
+	//weights from the segment means as in PELTandBE(), then one backward elimination over everything
+	vector<double> Wext(K + 1);
+	double totalSum = 0;
+	for (k = 0; k <= K; k++)
+		totalSum += segmentSum[k];
+	Wext[0] = totalSum / M;
+	for (k = 1; k <= K; k++) {
+		double leftMean = segmentSum[k - 1] / (breakpoints[k] - breakpoints[k - 1]);
+		double rightMean = segmentSum[k] / (breakpoints[k + 1] - breakpoints[k]);
+		Wext[k] = (rightMean - leftMean) * sqrt((double) (M - breakpoints[k]) * (double) breakpoints[k] / M);
+	}
+	fillResultFromIextWext(y, M, options, state.sigma2, breakpoints, Wext, true, result);
+	result.noOfBreakpointsBeforeSBL = noOfBreakpointsBeforeSBL;
+	result.noOfBreakpointsAfterSBL = K;
+	result.numEMsteps = numEMsteps;
+	result.noOfResegmentedDataPoints = noOfResegmentedDataPoints;
+	result.noOfResegmentedWindows = (long) regionStart.size();
+
+	//the final breakpoints are a subset of the merged ones, so their statistics add up
+	vector<double> finalSum(result.K + 1, 0), finalSumOfSquares(result.K + 1, 0);
+	long j = 0;
+	for (k = 0; k <= K; k++) {
+		while (breakpoints[k] >= result.Iext[j + 1])
+			j++;
+		finalSum[j] += segmentSum[k];
+		finalSumOfSquares[j] += segmentSumOfSquares[k];
+	}
+	storeIncrementalState(y, M, result, finalSum, finalSumOfSquares, state);
+	return result.K;
+}
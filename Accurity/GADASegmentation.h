@@ -0,0 +1,113 @@
+/*=================================================================
+ * GADASegmentation.h
+ * Library entry point: segment one array with SBL/PELT + backward elimination.
+ *=================================================================*/
+/*
+ 2026.10.18 segmentGADA() wraps BaseGADA for callers that embed segmentation
+ (Infer, bindings, services). The input is read-only, options and results are
+ plain structs, all arrays BaseGADA allocates are freed before returning and
+ nothing is written to stdout/stderr unless options.debug>0.
+
+ Thread safety: every call has its own BaseGADA, so any number of calls may
+ run at the same time as long as each uses its own GADAWorkspace.
+ */
+
+#ifndef _GADASegmentation_H_
+#define _GADASegmentation_H_
+
+#include "BaseGADA.h"
+
+//defaults are those of the GADA program
+struct GADAOptions{
+	double sigma2;	//noise variance, <0: estimated from the differences of adjacent values
+	double BaseAmp;
+	double a;	//SBL hyperprior parameter
+	double T;	//backward elimination threshold, in units of noise stddev
+	long MinSegLen;
+	double convergenceDelta;
+	long maxNoOfIterations;
+	double convergenceMaxAlpha;
+	double convergenceB;
+	int segmentationEngine;	//kEngineSBL or kEnginePELT
+	double prefilterThreshold;
+	int prefilterNoOfScales;
+	long prefilterMargin;
+	double peltPenalty;
+	long adaptiveStopWindow;
+	double adaptiveStopDeltaRatio;
+	bool collectSBLTelemetry;
+	long debug;
+
+	GADAOptions():
+		sigma2(-1), BaseAmp(0), a(0.5), T(5.0), MinSegLen(0), convergenceDelta(1E-8), maxNoOfIterations(50000),
+		convergenceMaxAlpha(1E8), convergenceB(1E-20), segmentationEngine(kEngineSBL), prefilterThreshold(0),
+		prefilterNoOfScales(10), prefilterMargin(2), peltPenalty(0), adaptiveStopWindow(0),
+		adaptiveStopDeltaRatio(0.9), collectSBLTelemetry(false), debug(0){
+	}
+};
+
+struct GADAResult{
+	long K;	//number of breakpoints after backward elimination
+	vector<long> Iext;	//K+2 segment boundaries: 0, the K breakpoints, M
+	vector<double> Wext;	//K+1: overall mean, then the breakpoint weights
+	vector<long> SegLen;	//K+1 segment lengths
+	vector<double> SegAmp;	//K+1 segment amplitudes
+	double sigma2;	//noise variance used (estimated if options.sigma2<0)
+	double ymean;	//mean of the input
+	long noOfBreakpointsBeforeSBL;
+	long noOfBreakpointsAfterSBL;	//after SBL or PELT, before backward elimination
+	long numEMsteps;
+	double delta;
+	bool stoppedAdaptively;
+	vector<SBLIterationRecord> sblTelemetry;	//only if options.collectSBLTelemetry
+	long noOfResegmentedDataPoints;	//data points SBL/PELT ran on, M unless resegmentGADA() reused segments
+	long noOfResegmentedWindows;	//windows segmented separately by resegmentGADA(), 1 for a full run
+
+	GADAResult():
+		K(0), sigma2(0), ymean(0), noOfBreakpointsBeforeSBL(0), noOfBreakpointsAfterSBL(0), numEMsteps(0),
+		delta(0), stoppedAdaptively(false), noOfResegmentedDataPoints(0), noOfResegmentedWindows(0){
+	}
+};
+
+/*
+ 2026.10.18 What resegmentGADA() keeps of the previous run on one track (chromosome): its input, the
+ final breakpoints and weights, and per segment sufficient statistics, so untouched segments are
+ reused without reading their data again. sigma2 is that of the first full run and stays fixed,
+ so T means the same in every window.
+ */
+struct GADAIncrementalState{
+	vector<double> y;	//input of the previous run, to find what changed
+	double sigma2;
+	vector<long> Iext;	//K+2
+	vector<double> Wext;	//K+1
+	vector<double> segmentSum;	//K+1, sum of y over each segment
+	vector<double> segmentSumOfSquares;	//K+1
+
+	GADAIncrementalState():
+		sigma2(-1){
+	}
+	bool empty() const {
+		return y.empty();
+	}
+	long K() const {
+		return (long) Iext.size() - 2;
+	}
+	//binary file. Both return false on an I/O error or, for load(), a file that is not a state file.
+	bool save(const string &path) const;
+	bool load(const string &path);
+};
+
+//Segments y like segmentGADA(), but SBL+BE only re-runs on windows that differ from state.y (data appended
+// to the end included). Each changed run is widened by margin and then out to the nearest previous
+// breakpoints on both sides; the windows are segmented on their own, merged with the untouched
+// segments, and one more backward elimination runs over the merged breakpoints.
+//Falls back to a full segmentGADA() if state is empty, y is shorter than state.y, or the windows cover
+// more than maxChangedFraction of y. state is updated to this run. Returns result.K, or -1 if M<1.
+long resegmentGADA(const double *y, long M, const GADAOptions &options, long margin, double maxChangedFraction,
+		GADAWorkspace &workspace, GADAIncrementalState &state, GADAResult &result);
+
+//Segments y[0..M-1] into result. workspace keeps scratch memory between calls, one per thread.
+//Returns result.K, or -1 if M<1. M==1 is one segment, with result.sigma2 0 if options.sigma2<0 asked for an estimate.
+long segmentGADA(const double *y, long M, const GADAOptions &options, GADAWorkspace &workspace, GADAResult &result);
+
+#endif //_GADASegmentation_H_
@@ -34,6 +34,7 @@ typedef RedBlackTreeNode<BreakPointKey, rbNodeDataType > rbNodeType;
 #include <boost/format.hpp>
 #include "misc.h"
 #include <cstring>      //for strcat
+#include <vector>
 using namespace std;
 
 //  CONVENTIONS:
@@ -154,6 +155,9 @@ template<typename keyType, typename dataType>
 class RedBlackTree {
 protected:
 	long _noOfNodes;	//size() is expensive, use this to keep track.
+	//2026.10.18 not copyable, the destructor frees the nodes
+	RedBlackTree(const RedBlackTree&);
+	RedBlackTree& operator=(const RedBlackTree&);
 	short isValidRedBlackTreeRecur_(RedBlackTreeNode<keyType, dataType> *nodePtr) {
 		if (nodePtr == nil)
 			return 1;
@@ -467,33 +471,27 @@ public:
 	}
 	~RedBlackTree() {
 		/*
-		 RedBlackTreeNode<keyType, dataType> * x = root->left;
-		 TemplateStack<RedBlackTreeNode<keyType, dataType> *> stuffToFree;
-
-		 if (x != nil) {
-		 if (x->left != nil) {
-		 stuffToFree.Push(x->left);
-		 }
-		 if (x->right != nil) {
-		 stuffToFree.Push(x->right);
-		 }
-		 // delete x->storedEntry;
-		 delete x;
-		 while (stuffToFree.NotEmpty()) {
-		 x = stuffToFree.Pop();
-		 if (x->left != nil) {
-		 stuffToFree.Push(x->left);
-		 }
-		 if (x->right != nil) {
-		 stuffToFree.Push(x->right);
-		 }
-		 // delete x->storedEntry;
-		 delete x;
-		 }
-		 }
-		 delete nil;
-		 delete root;
+		 * 2026.10.18 free all remaining nodes and the two sentinels (the stack-based version of the
+		 * original code, which had been commented out). Node data (dataPtr) is owned by the caller.
 		 */
+		std::vector<RedBlackTreeNode<keyType, dataType> *> stuffToFree;
+		RedBlackTreeNode<keyType, dataType> * x = root->left;
+		if (x != nil) {
+			stuffToFree.push_back(x);
+		}
+		while (!stuffToFree.empty()) {
+			x = stuffToFree.back();
+			stuffToFree.pop_back();
+			if (x->left != nil) {
+				stuffToFree.push_back(x->left);
+			}
+			if (x->right != nil) {
+				stuffToFree.push_back(x->right);
+			}
+			delete x;
+		}
+		delete nil;
+		delete root;
 	}
 	void print() {
 		TreePrintHelper(root->left);
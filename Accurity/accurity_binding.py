@@ -0,0 +1,244 @@
+#!/usr/bin/env python
+"""
+2026.10.18 In-process access to GADA segmentation and infer through libaccurity.so (accurity_capi.h), for
+notebooks and scripts that would otherwise run the GADA and infer programs and parse their files.
+
+NumPy arrays of the expected dtype and contiguous layout are handed to the library without copies, and
+results come back as NumPy arrays. The GIL is released during every library call, so chromosomes or samples
+run in parallel from Python threads (see segment_ratio_tracks()).
+
+	import accurity_binding as ab
+	segments = ab.segment_ratio_tracks({"chr1": (window_start, ratio), ...}, threads=8)
+	result = ab.infer(segments, snps, configure_filepath="configure")
+	print(result["purity"], result["ploidy"])
+
+snps: a mapping (dict, pandas DataFrame, structured array) with columns chr (1..22), pos, maf, coverage.
+segments: a mapping with columns chr, start, end, ratio, stddev, no_of_windows, as GADA output.
+"""
+import ctypes
+import os
+from multiprocessing.pool import ThreadPool
+import numpy as np
+
+_c_int_p = np.ctypeslib.ndpointer(dtype=np.int32, flags="C_CONTIGUOUS")
+_c_long_p = np.ctypeslib.ndpointer(dtype=np.int64, flags="C_CONTIGUOUS")
+_c_float_p = np.ctypeslib.ndpointer(dtype=np.float32, flags="C_CONTIGUOUS")
+_c_double_p = np.ctypeslib.ndpointer(dtype=np.float64, flags="C_CONTIGUOUS")
+
+segmentation_engine_dict = {"SBL": 0, "PELT": 1}
+
+
+class InferOptions(ctypes.Structure):
+	_fields_ = [("config_file_path", ctypes.c_char_p), ("output_dir", ctypes.c_char_p),
+				("write_artifacts", ctypes.c_int), ("segment_stddev_divider", ctypes.c_float),
+				("snp_coverage_min", ctypes.c_int), ("snp_coverage_var_vs_mean_ratio", ctypes.c_float),
+				("no_of_peaks_for_logL", ctypes.c_int), ("debug", ctypes.c_int), ("auto_", ctypes.c_int),
+				("segmentation_engine", ctypes.c_int), ("no_of_reader_threads", ctypes.c_int)]
+
+
+class InferSummary(ctypes.Structure):
+	_fields_ = [("return_code", ctypes.c_int), ("status", ctypes.c_int), ("purity", ctypes.c_double),
+				("ploidy", ctypes.c_double), ("purity_naive", ctypes.c_double), ("ploidy_naive", ctypes.c_double),
+				("rc_ratio_of_cp_2", ctypes.c_double), ("Q", ctypes.c_double), ("logL", ctypes.c_double),
+				("period_int", ctypes.c_int), ("best_no_of_copy_nos_bf_1st_peak", ctypes.c_int),
+				("first_peak_int", ctypes.c_int), ("ploidy_cnv_all", ctypes.c_double),
+				("ploidy_clonal", ctypes.c_double), ("no_of_segments", ctypes.c_int),
+				("no_of_segments_used", ctypes.c_int), ("no_of_snps", ctypes.c_int),
+				("no_of_snps_used", ctypes.c_int), ("no_of_cn_segments", ctypes.c_long),
+				("no_of_logL_rows", ctypes.c_long)]
+
+
+logL_table_columns = ("period", "logL", "logL_rc", "logL_rc_penalty", "best_logL_snp", "best_lod_snp",
+					  "best_logL_snp_penalty", "best_logL_snp_no_of_parameters", "best_no_of_copy_nos_bf_1st_peak",
+					  "first_peak_int", "best_purity", "best_ploidy")
+
+_lib = None
+_error_message_size = 1024
+
+
+def load_library(library_path=None):
+	"""
+	Loads libaccurity.so, by default the one next to this file. ctypes.CDLL (not PyDLL) releases the GIL
+	around each call.
+	"""
+	global _lib
+	is_default = library_path is None
+	if is_default and _lib is not None:
+		return _lib
+	if is_default:
+		library_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libaccurity.so")
+	lib = ctypes.CDLL(library_path)
+	lib.accurity_infer_default_options.argtypes = [ctypes.POINTER(InferOptions)]
+	lib.accurity_infer_default_options.restype = None
+	lib.accurity_infer.argtypes = [ctypes.POINTER(InferOptions), ctypes.c_long, _c_int_p, _c_int_p, _c_int_p,
+								   _c_float_p, _c_float_p, _c_int_p, ctypes.c_long, _c_int_p, _c_int_p, _c_float_p,
+								   _c_int_p, ctypes.POINTER(InferSummary)]
+	lib.accurity_infer.restype = ctypes.c_void_p
+	lib.accurity_inferStatusName.argtypes = [ctypes.c_int]
+	lib.accurity_inferStatusName.restype = ctypes.c_char_p
+	lib.accurity_result_message.argtypes = [ctypes.c_void_p]
+	lib.accurity_result_message.restype = ctypes.c_char_p
+	lib.accurity_result_cn_segments.argtypes = [ctypes.c_void_p, _c_int_p, _c_int_p, _c_int_p, _c_double_p,
+												_c_int_p, _c_double_p, _c_double_p, _c_double_p, _c_double_p,
+												_c_double_p]
+	lib.accurity_result_cn_segments.restype = None
+	lib.accurity_result_logL_table.argtypes = [ctypes.c_void_p, _c_double_p]
+	lib.accurity_result_logL_table.restype = None
+	lib.accurity_result_free.argtypes = [ctypes.c_void_p]
+	lib.accurity_result_free.restype = None
+	lib.accurity_segment.argtypes = [_c_double_p, ctypes.c_long, ctypes.c_double, ctypes.c_long, ctypes.c_int,
+									 ctypes.c_double, _c_long_p, _c_double_p, ctypes.c_char_p, ctypes.c_long]
+	lib.accurity_segment.restype = ctypes.c_long
+	lib.accurity_segment_ratio_track.argtypes = [_c_int_p, _c_double_p, ctypes.c_long, ctypes.c_double,
+												 ctypes.c_long, ctypes.c_int, _c_int_p, _c_int_p, _c_float_p,
+												 _c_float_p, _c_int_p, ctypes.c_char_p, ctypes.c_long]
+	lib.accurity_segment_ratio_track.restype = ctypes.c_long
+	if is_default:
+		_lib = lib
+	return lib
+
+
+def _column(table, name, dtype):
+	#no copy if the column already has this dtype and is contiguous
+	return np.ascontiguousarray(table[name], dtype=dtype)
+
+
+def _encode(string):
+	if string is None:
+		return None
+	return string.encode() if not isinstance(string, bytes) else string
+
+
+def chromosome_number(chr_name):
+	"""chr1 or 1 -> 1. Other chromosomes (chrX, ...) -> 0, which infer skips."""
+	chr_name = str(chr_name)
+	if chr_name.startswith("chr"):
+		chr_name = chr_name[3:]
+	return int(chr_name) if chr_name.isdigit() else 0
+
+
+def segment(y, T=20, min_segment_len=50, segmentation_engine="SBL", sigma2=-1):
+	"""
+	GADA segmentation of one array. Returns (boundaries, amplitudes): the K+2 segment boundaries
+	(0, the breakpoints, len(y)) and the K+1 segment amplitudes.
+	"""
+	lib = load_library()
+	y = np.ascontiguousarray(y, dtype=np.float64)
+	boundaries = np.empty(len(y) + 1, dtype=np.int64)
+	amplitudes = np.empty(len(y) + 1, dtype=np.float64)
+	error_message = ctypes.create_string_buffer(_error_message_size)
+	no_of_segments = lib.accurity_segment(y, len(y), T, min_segment_len,
+										  segmentation_engine_dict[segmentation_engine], sigma2, boundaries,
+										  amplitudes, error_message, _error_message_size)
+	if no_of_segments < 0:
+		raise ValueError(error_message.value.decode())
+	return boundaries[:no_of_segments + 1], amplitudes[:no_of_segments]
+
+
+def segment_ratio_track(window_start, ratio, T=20, min_segment_len=50, segmentation_engine="SBL"):
+	"""
+	Segments one chromosome's read count ratio track as infer does for ratio tracks (*.csv). Returns a dict
+	of arrays start, end, ratio, stddev, no_of_windows.
+	"""
+	lib = load_library()
+	window_start = np.ascontiguousarray(window_start, dtype=np.int32)
+	ratio = np.ascontiguousarray(ratio, dtype=np.float64)
+	M = len(ratio)
+	segments = {"start": np.empty(M, dtype=np.int32), "end": np.empty(M, dtype=np.int32),
+				"ratio": np.empty(M, dtype=np.float32), "stddev": np.empty(M, dtype=np.float32),
+				"no_of_windows": np.empty(M, dtype=np.int32)}
+	error_message = ctypes.create_string_buffer(_error_message_size)
+	no_of_segments = lib.accurity_segment_ratio_track(window_start, ratio, M, T, min_segment_len,
+													  segmentation_engine_dict[segmentation_engine],
+													  segments["start"], segments["end"], segments["ratio"],
+													  segments["stddev"], segments["no_of_windows"],
+													  error_message, _error_message_size)
+	if no_of_segments < 0:
+		raise RuntimeError(error_message.value.decode())
+	for key in segments:
+		segments[key] = segments[key][:no_of_segments]
+	return segments
+
+
+def segment_ratio_tracks(track_dict, threads=None, T=20, min_segment_len=50, segmentation_engine="SBL"):
+	"""
+	Segments the ratio tracks of several chromosomes, track_dict: chromosome -> (window_start, ratio), in
+	parallel threads. Returns the segments of all chromosomes (with a chr column), ready for infer().
+	"""
+	chr_name_list = sorted(track_dict.keys(), key=chromosome_number)
+
+	def segment_one(chr_name):
+		window_start, ratio = track_dict[chr_name]
+		return segment_ratio_track(window_start, ratio, T=T, min_segment_len=min_segment_len,
+								   segmentation_engine=segmentation_engine)
+
+	pool = ThreadPool(threads)
+	try:
+		segments_list = pool.map(segment_one, chr_name_list)
+	finally:
+		pool.close()
+	segments = {}
+	for key in ("start", "end", "ratio", "stddev", "no_of_windows"):
+		segments[key] = np.concatenate([chr_segments[key] for chr_segments in segments_list])
+	segments["chr"] = np.concatenate([np.full(len(chr_segments["start"]), chromosome_number(chr_name), np.int32)
+									  for chr_name, chr_segments in zip(chr_name_list, segments_list)])
+	return segments
+
+
+def infer(segments, snps, configure_filepath=None, output_dir=None, segment_stddev_divider=20, snp_coverage_min=2,
+		  snp_coverage_var_vs_mean_ratio=10.0, max_no_of_peaks_for_logL=3, auto=1, segmentation_engine="SBL",
+		  debug=0, reader_threads=0):
+	"""
+	Infers purity and ploidy. Parameters as main.py; output_dir also writes the usual infer output files
+	there. Returns a dict of the scalar results (purity, ploidy, Q, status, ...), cn_segments (dict of
+	arrays, as cnv.output.tsv) and logL_table (one row per candidate period, columns logL_table_columns).
+	Raises RuntimeError on an error.
+	"""
+	lib = load_library()
+	options = InferOptions()
+	lib.accurity_infer_default_options(ctypes.byref(options))
+	options.config_file_path = _encode(configure_filepath)
+	options.output_dir = _encode(output_dir)
+	options.write_artifacts = 1 if output_dir else 0
+	options.segment_stddev_divider = segment_stddev_divider
+	options.snp_coverage_min = snp_coverage_min
+	options.snp_coverage_var_vs_mean_ratio = snp_coverage_var_vs_mean_ratio
+	options.no_of_peaks_for_logL = max_no_of_peaks_for_logL
+	options.auto_ = auto
+	options.segmentation_engine = segmentation_engine_dict[segmentation_engine]
+	options.debug = debug
+	options.no_of_reader_threads = reader_threads
+
+	segment_columns = [_column(segments, "chr", np.int32), _column(segments, "start", np.int32),
+					   _column(segments, "end", np.int32), _column(segments, "ratio", np.float32),
+					   _column(segments, "stddev", np.float32), _column(segments, "no_of_windows", np.int32)]
+	snp_columns = [_column(snps, "chr", np.int32), _column(snps, "pos", np.int32), _column(snps, "maf", np.float32),
+				   _column(snps, "coverage", np.int32)]
+	summary = InferSummary()
+	handle = lib.accurity_infer(ctypes.byref(options), len(segment_columns[0]), *(segment_columns +
+								[len(snp_columns[0])] + snp_columns + [ctypes.byref(summary)]))
+	if not handle:
+		raise MemoryError("libaccurity could not allocate the infer result.")
+	try:
+		if summary.return_code != 0:
+			raise RuntimeError(lib.accurity_result_message(handle).decode())
+		result = dict((name, getattr(summary, name)) for name, _ in InferSummary._fields_)
+		result["status"] = lib.accurity_inferStatusName(summary.status).decode()
+		result["message"] = lib.accurity_result_message(handle).decode()
+		n = summary.no_of_cn_segments
+		cn_segments = {"chr": np.empty(n, np.int32), "start": np.empty(n, np.int32), "end": np.empty(n, np.int32),
+					   "cp": np.empty(n, np.float64), "major_allele_cp": np.empty(n, np.int32),
+					   "copy_no_float": np.empty(n, np.float64), "stddev": np.empty(n, np.float64),
+					   "maf_mean": np.empty(n, np.float64), "maf_stddev": np.empty(n, np.float64),
+					   "maf_expected": np.empty(n, np.float64)}
+		lib.accurity_result_cn_segments(handle, cn_segments["chr"], cn_segments["start"], cn_segments["end"],
+										cn_segments["cp"], cn_segments["major_allele_cp"],
+										cn_segments["copy_no_float"], cn_segments["stddev"], cn_segments["maf_mean"],
+										cn_segments["maf_stddev"], cn_segments["maf_expected"])
+		result["cn_segments"] = cn_segments
+		logL_table = np.empty((summary.no_of_logL_rows, len(logL_table_columns)), np.float64)
+		lib.accurity_result_logL_table(handle, logL_table)
+		result["logL_table"] = logL_table
+	finally:
+		lib.accurity_result_free(handle)
+	return result
@@ -0,0 +1,275 @@
+/*
+ * 2026.10.18 C interface of libaccurity.so over inferPurityPloidy() and segmentGADA(), see accurity_capi.h.
+ */
+#include "accurity_capi.h"
+#include "infer.h"
+using namespace std;
+
+struct AccurityInferResult
+{
+    InferResult result;
+};
+
+static string chromosome_name(int chr)
+{
+    //out-of-range chromosomes get a name infer skips, like those of other species
+    if (chr < 1 || chr > NUM_AUTO_CHR)
+        return string();
+    return chromosomeNameArray[chr - 1];
+}
+
+//the message of an exception caught at the C boundary, truncated to the caller's buffer
+static void copy_error_message(const char *message, char *error_message, long error_message_size)
+{
+    if (error_message && error_message_size > 0)
+        snprintf(error_message, error_message_size, "%s", message);
+}
+
+void accurity_infer_default_options(AccurityInferOptions *options)
+{
+    InferOptions default_options;
+    options->config_file_path = NULL;
+    options->output_dir = NULL;
+    options->write_artifacts = 0;
+    options->segment_stddev_divider = default_options.segment_stddev_divider;
+    options->snp_coverage_min = default_options.snp_coverage_min;
+    options->snp_coverage_var_vs_mean_ratio = default_options.snp_coverage_var_vs_mean_ratio;
+    options->no_of_peaks_for_logL = default_options.no_of_peaks_for_logL;
+    options->debug = default_options.debug;
+    options->auto_ = default_options.auto_;
+    options->segmentation_engine = default_options.segmentation_engine;
+    options->no_of_reader_threads = default_options.no_of_reader_threads;
+}
+
+//an exception caught at the C boundary as an error result, NULL if not even the result could be allocated
+static AccurityInferResult *infer_error_result(AccurityInferResult *handle, const char *message,
+                                               AccurityInferSummary *summary)
+{
+    summary->return_code = 3;
+    summary->status = kInferError;
+    summary->no_of_cn_segments = 0;
+    summary->no_of_logL_rows = 0;
+    if (!handle)
+        return NULL;
+    handle->result.status = kInferError;
+    try
+    {
+        handle->result.message = message;
+    }
+    catch (...)
+    {
+        //bad_alloc again, the message stays empty
+    }
+    return handle;
+}
+
+AccurityInferResult *accurity_infer(const AccurityInferOptions *options, long no_of_segments,
+                                    const int *segment_chr, const int *segment_start, const int *segment_end,
+                                    const float *segment_ratio, const float *segment_stddev,
+                                    const int *segment_no_of_windows, long no_of_snps, const int *snp_chr,
+                                    const int *snp_pos, const float *snp_maf, const int *snp_coverage,
+                                    AccurityInferSummary *summary)
+{
+    AccurityInferResult *handle = NULL;
+    try
+    {
+        handle = new AccurityInferResult();
+        InferOptions infer_options;
+        infer_options.config_file_path = options->config_file_path ? options->config_file_path : "";
+        infer_options.output_dir = options->output_dir ? options->output_dir : "";
+        infer_options.write_artifacts = options->write_artifacts != 0;
+        infer_options.segment_stddev_divider = options->segment_stddev_divider;
+        infer_options.snp_coverage_min = options->snp_coverage_min;
+        infer_options.snp_coverage_var_vs_mean_ratio = options->snp_coverage_var_vs_mean_ratio;
+        infer_options.no_of_peaks_for_logL = options->no_of_peaks_for_logL;
+        infer_options.debug = options->debug;
+        infer_options.auto_ = options->auto_;
+        infer_options.segmentation_engine = options->segmentation_engine;
+        infer_options.no_of_reader_threads = options->no_of_reader_threads;
+
+        //the records carry the chromosome as a name, so the columns are gathered once into them
+        vector<SegmentRecord> segment_vec(no_of_segments);
+        for (long i = 0; i < no_of_segments; i++)
+        {
+            SegmentRecord &record = segment_vec[i];
+            record.chr_string = chromosome_name(segment_chr[i]);
+            record.start = segment_start[i];
+            record.end = segment_end[i];
+            record.read_count_ratio = segment_ratio[i];
+            record.ratio_stddev = segment_stddev[i];
+            record.no_of_valid_windows = segment_no_of_windows[i];
+            record.no_of_snps_used = 0;
+        }
+        vector<SNPRecord> snp_vec(no_of_snps);
+        for (long i = 0; i < no_of_snps; i++)
+        {
+            SNPRecord &snp = snp_vec[i];
+            snp.chr_string = chromosome_name(snp_chr[i]);
+            snp.pos = snp_pos[i];
+            snp.maf = snp_maf[i];
+            snp.coverage = snp_coverage[i];
+        }
+        InferInput input;
+        input.segments = segment_vec.data();
+        input.no_of_segments = segment_vec.size();
+        input.snps = snp_vec.data();
+        input.no_of_snps = snp_vec.size();
+
+        const InferResult &result = handle->result;
+        summary->return_code = inferPurityPloidy(input, infer_options, handle->result);
+        summary->status = result.status;
+        summary->purity = result.purity;
+        summary->ploidy = result.ploidy;
+        summary->purity_naive = result.purity_naive;
+        summary->ploidy_naive = result.ploidy_naive;
+        summary->rc_ratio_of_cp_2 = result.rc_ratio_of_cp_2;
+        summary->Q = result.Q;
+        summary->logL = result.logL;
+        summary->period_int = result.period_int;
+        summary->best_no_of_copy_nos_bf_1st_peak = result.best_no_of_copy_nos_bf_1st_peak;
+        summary->first_peak_int = result.first_peak_int;
+        summary->ploidy_cnv_all = result.ploidy_cnv_all;
+        summary->ploidy_clonal = result.ploidy_clonal;
+        summary->no_of_segments = result.no_of_segments;
+        summary->no_of_segments_used = result.no_of_segments_used;
+        summary->no_of_snps = result.no_of_snps;
+        summary->no_of_snps_used = result.no_of_snps_used;
+        summary->no_of_cn_segments = result.cn_segments.size();
+        summary->no_of_logL_rows = result.logL_table.size();
+    }
+    //nothing may unwind into the C caller: an exception becomes an error result
+    catch (const std::exception &e)
+    {
+        return infer_error_result(handle, e.what(), summary);
+    }
+    catch (...)
+    {
+        return infer_error_result(handle, "unknown exception", summary);
+    }
+    return handle;
+}
+
+const char *accurity_inferStatusName(int status)
+{
+    return inferStatusName(status);
+}
+
+const char *accurity_result_message(const AccurityInferResult *result)
+{
+    return result->result.message.c_str();
+}
+
+void accurity_result_cn_segments(const AccurityInferResult *result, int *chr, int *start, int *end, double *cp,
+                                 int *major_allele_cp, double *copy_no_float, double *stddev, double *maf_mean,
+                                 double *maf_stddev, double *maf_expected)
+{
+    const vector<InferCNSegment> &cn_segments = result->result.cn_segments;
+    for (size_t i = 0; i < cn_segments.size(); i++)
+    {
+        chr[i] = cn_segments[i].chr;
+        start[i] = cn_segments[i].start;
+        end[i] = cn_segments[i].end;
+        cp[i] = cn_segments[i].cp;
+        major_allele_cp[i] = cn_segments[i].major_allele_cp;
+        copy_no_float[i] = cn_segments[i].copy_no_float;
+        stddev[i] = cn_segments[i].stddev;
+        maf_mean[i] = cn_segments[i].maf_mean;
+        maf_stddev[i] = cn_segments[i].maf_stddev;
+        maf_expected[i] = cn_segments[i].maf_expected;
+    }
+}
+
+void accurity_result_logL_table(const AccurityInferResult *result, double *table)
+{
+    for (const InferLogLRow &row : result->result.logL_table)
+    {
+        *table++ = row.period_int;
+        *table++ = row.logL;
+        *table++ = row.logL_rc;
+        *table++ = row.logL_rc_penalty;
+        *table++ = row.best_logL_snp;
+        *table++ = row.best_lod_snp;
+        *table++ = row.best_logL_snp_penalty;
+        *table++ = row.best_logL_snp_no_of_parameters;
+        *table++ = row.best_no_of_copy_nos_bf_1st_peak;
+        *table++ = row.first_peak_int;
+        *table++ = row.best_purity;
+        *table++ = row.best_ploidy;
+    }
+}
+
+void accurity_result_free(AccurityInferResult *result)
+{
+    delete result;
+}
+
+long accurity_segment(const double *y, long M, double T, long min_segment_len, int segmentation_engine,
+                      double sigma2, long *boundaries, double *amplitudes, char *error_message,
+                      long error_message_size)
+{
+    try
+    {
+        GADAOptions gada_options;
+        gada_options.T = T;
+        gada_options.MinSegLen = min_segment_len;
+        gada_options.segmentationEngine = segmentation_engine;
+        gada_options.sigma2 = sigma2;
+        GADAWorkspace gada_workspace;
+        GADAResult gada_result;
+        if (segmentGADA(y, M, gada_options, gada_workspace, gada_result) < 0)
+        {
+            copy_error_message("nothing to segment.", error_message, error_message_size);
+            return -1;
+        }
+        std::copy(gada_result.Iext.begin(), gada_result.Iext.end(), boundaries);
+        std::copy(gada_result.SegAmp.begin(), gada_result.SegAmp.end(), amplitudes);
+        return gada_result.K + 1;
+    }
+    catch (const std::exception &e)
+    {
+        copy_error_message(e.what(), error_message, error_message_size);
+    }
+    catch (...)
+    {
+        copy_error_message("unknown exception", error_message, error_message_size);
+    }
+    return -1;
+}
+
+//the same segments as Infer::segmentRatioTrack()
+long accurity_segment_ratio_track(const int *window_start, const double *ratio, long M, double T,
+                                  long min_segment_len, int segmentation_engine, int *segment_start,
+                                  int *segment_end, float *segment_ratio, float *segment_stddev,
+                                  int *segment_no_of_windows, char *error_message, long error_message_size)
+{
+    try
+    {
+        GADAOptions gada_options;
+        gada_options.MinSegLen = min_segment_len;
+        gada_options.T = T;
+        gada_options.segmentationEngine = segmentation_engine;
+        GADAWorkspace gada_workspace;
+        GADAResult gada_result;
+        if (segmentGADA(ratio, M, gada_options, gada_workspace, gada_result) < 0)
+            return 0;
+        for (long i = 0; i < gada_result.K + 1; i++)
+        {
+            segment_start[i] = window_start[gada_result.Iext[i]];
+            segment_end[i] = window_start[gada_result.Iext[i + 1] - 1];
+            //only reads the array
+            calculate_robust_mean_stddev(const_cast<double *>(ratio), gada_result.Iext[i], gada_result.Iext[i + 1],
+                                         40, segment_ratio[i], segment_stddev[i]);
+            segment_no_of_windows[i] = gada_result.SegLen[i];
+        }
+        return gada_result.K + 1;
+    }
+    catch (const std::exception &e)
+    {
+        copy_error_message(e.what(), error_message, error_message_size);
+    }
+    catch (...)
+    {
+        copy_error_message("unknown exception", error_message, error_message_size);
+    }
+    return -1;
+}
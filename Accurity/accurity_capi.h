@@ -0,0 +1,106 @@
+/*
+ * 2026.10.18 C interface of libaccurity.so, for in-process callers that cannot use the C++ structs
+ * (accurity_binding.py through ctypes). Arrays are passed as plain column pointers, so NumPy arrays go in
+ * and come back without copies on the caller's side. No call touches process-wide state; calls may run
+ * concurrently from several threads. No C++ exception leaves a call: accurity_infer() turns one into an
+ * error result, the segmentation calls return -1 with its message in the caller's error_message buffer.
+ *
+ * Chromosomes are numbers 1..22, as in cnv.output.tsv.
+ */
+#ifndef _ACCURITY_CAPI_H_
+#define _ACCURITY_CAPI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//InferOptions, see infer.h. NULL strings are empty ones.
+typedef struct
+{
+    const char *config_file_path;
+    const char *output_dir;
+    int write_artifacts;
+    float segment_stddev_divider;
+    int snp_coverage_min;
+    float snp_coverage_var_vs_mean_ratio;
+    int no_of_peaks_for_logL;
+    int debug;
+    int auto_;
+    int segmentation_engine;  // 0: SBL, 1: PELT
+    int no_of_reader_threads;
+} AccurityInferOptions;
+
+//the scalar part of InferResult
+typedef struct
+{
+    int return_code;  // 0 or 3, as inferPurityPloidy()
+    int status;  // InferStatus
+    double purity;
+    double ploidy;
+    double purity_naive;
+    double ploidy_naive;
+    double rc_ratio_of_cp_2;
+    double Q;
+    double logL;
+    int period_int;
+    int best_no_of_copy_nos_bf_1st_peak;
+    int first_peak_int;
+    double ploidy_cnv_all;
+    double ploidy_clonal;
+    int no_of_segments;
+    int no_of_segments_used;
+    int no_of_snps;
+    int no_of_snps_used;
+    long no_of_cn_segments;
+    long no_of_logL_rows;
+} AccurityInferSummary;
+
+//InferResult of one run, owned by the caller until accurity_result_free()
+typedef struct AccurityInferResult AccurityInferResult;
+
+void accurity_infer_default_options(AccurityInferOptions *options);
+
+//Runs inference on segments (chromosome, start, end, read count ratio, ratio stddev, number of windows; as
+// GADA output) and heterozygous SNPs (chromosome, position, MAF, coverage). Fills summary and returns the
+// full result, also on an error (summary->return_code 3, see accurity_result_message()). Returns NULL, with
+// summary->return_code 3, only if not even the result could be allocated.
+AccurityInferResult *accurity_infer(const AccurityInferOptions *options, long no_of_segments,
+                                    const int *segment_chr, const int *segment_start, const int *segment_end,
+                                    const float *segment_ratio, const float *segment_stddev,
+                                    const int *segment_no_of_windows, long no_of_snps, const int *snp_chr,
+                                    const int *snp_pos, const float *snp_maf, const int *snp_coverage,
+                                    AccurityInferSummary *summary);
+const char *accurity_inferStatusName(int status);
+const char *accurity_result_message(const AccurityInferResult *result);
+//copies the copy number segments (cnv.output.tsv) into arrays of summary->no_of_cn_segments
+void accurity_result_cn_segments(const AccurityInferResult *result, int *chr, int *start, int *end, double *cp,
+                                 int *major_allele_cp, double *copy_no_float, double *stddev, double *maf_mean,
+                                 double *maf_stddev, double *maf_expected);
+//copies the candidate periods (infer.out.details.tsv) row by row into a summary->no_of_logL_rows x 12 array:
+// period, logL, logL_rc, logL_rc_penalty, best_logL_snp, best_lod_snp, best_logL_snp_penalty,
+// best_logL_snp_no_of_parameters, best_no_of_copy_nos_bf_1st_peak, first_peak_int, best_purity, best_ploidy
+void accurity_result_logL_table(const AccurityInferResult *result, double *table);
+void accurity_result_free(AccurityInferResult *result);
+
+//Segments y[0..M-1] as GADA does (segmentGADA()). boundaries gets the K+2 segment boundaries (0, the K
+// breakpoints, M) and amplitudes the K+1 segment amplitudes, so both need room for M+1 values.
+// sigma2<0 estimates the noise variance. Returns the number of segments K+1, or -1 (with the reason in
+// error_message, up to error_message_size bytes) if M<1 or on an error.
+long accurity_segment(const double *y, long M, double T, long min_segment_len, int segmentation_engine,
+                      double sigma2, long *boundaries, double *amplitudes, char *error_message,
+                      long error_message_size);
+
+//Segments one chromosome's read count ratio track (window start positions and ratios) into segments as
+// infer does for ratio tracks: start, end, robust mean and stddev of the ratio, number of windows.
+// The output arrays need room for M values. Returns the number of segments, 0 if M<1, or -1 on an error
+// (as accurity_segment()).
+long accurity_segment_ratio_track(const int *window_start, const double *ratio, long M, double T,
+                                  long min_segment_len, int segmentation_engine, int *segment_start,
+                                  int *segment_end, float *segment_ratio, float *segment_stddev,
+                                  int *segment_no_of_windows, char *error_message, long error_message_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_ACCURITY_CAPI_H_
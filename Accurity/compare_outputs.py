@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+"""
+2026.10.18 Compares the outputs of two runs (two files, or the files two output folders have in common), to
+check that a change keeps them as they were:
+
+	# byte-identical outputs of two builds (e.g. infer.out.tsv, cnv.output.tsv, GADA output, .gz or plain)
+	compare_outputs.py old_output_dir new_output_dir
+	# a warm-started GADA run against a cold one with the same -a: breakpoints (in bp, 500 per window) may
+	# move by a few windows, segment means slightly
+	compare_outputs.py cold.tsv warm.tsv --int_tolerance 10000 --float_tolerance 0.01
+
+Without tolerances the files must have the same lines (gzipped ones are compared inflated). With them, lines
+starting with '#' (GADA's run statistics) are skipped unless --with_comments. Exits with 1 if any file
+differs, printing its first differing line.
+"""
+import argparse
+import gzip
+import os
+import sys
+
+parser = argparse.ArgumentParser()
+parser.add_argument('old_path', help='output file or folder of the reference run')
+parser.add_argument('new_path', help='output file or folder of the run to check')
+parser.add_argument('--int_tolerance', type=int, default=0,
+					help='largest difference of integer fields (positions, lengths) taken as equal')
+parser.add_argument('--float_tolerance', type=float, default=0,
+					help='largest relative difference of other numeric fields taken as equal')
+parser.add_argument('--with_comments', action='store_true', help='compare the # lines also with tolerances')
+args = parser.parse_args()
+
+
+def read_lines(file_path, with_comments):
+	opener = gzip.open if file_path.endswith(".gz") else open
+	with opener(file_path, "rt") as input_file:
+		return [line.rstrip("\n") for line in input_file if with_comments or not line.startswith("#")]
+
+
+def fields_match(old_field, new_field, int_tolerance, float_tolerance):
+	if old_field == new_field:
+		return True
+	try:
+		return abs(int(old_field) - int(new_field)) <= int_tolerance
+	except ValueError:
+		pass
+	try:
+		old_value = float(old_field)
+		new_value = float(new_field)
+	except ValueError:
+		return False
+	return abs(old_value - new_value) <= float_tolerance * max(abs(old_value), abs(new_value))
+
+
+def compare_file(old_file_path, new_file_path):
+	"""Returns None if the files match, otherwise a description of the first difference."""
+	exact = args.int_tolerance == 0 and args.float_tolerance == 0
+	old_lines = read_lines(old_file_path, exact or args.with_comments)
+	new_lines = read_lines(new_file_path, exact or args.with_comments)
+	for line_no, (old_line, new_line) in enumerate(zip(old_lines, new_lines), 1):
+		if old_line == new_line:
+			continue
+		if exact:
+			return "line %s:\n\t< %s\n\t> %s" % (line_no, old_line, new_line)
+		old_fields = old_line.split("\t")
+		new_fields = new_line.split("\t")
+		if len(old_fields) != len(new_fields) or not all(
+				fields_match(old_field, new_field, args.int_tolerance, args.float_tolerance)
+				for old_field, new_field in zip(old_fields, new_fields)):
+			return "line %s:\n\t< %s\n\t> %s" % (line_no, old_line, new_line)
+	if len(old_lines) != len(new_lines):
+		return "%s lines, %s before" % (len(new_lines), len(old_lines))
+	return None
+
+
+def main():
+	if os.path.isdir(args.old_path):
+		file_name_list = sorted(set(os.listdir(args.old_path)) & set(os.listdir(args.new_path)))
+		path_pair_list = [(os.path.join(args.old_path, file_name), os.path.join(args.new_path, file_name))
+						  for file_name in file_name_list
+						  if os.path.isfile(os.path.join(args.old_path, file_name))]
+	else:
+		path_pair_list = [(args.old_path, args.new_path)]
+	no_of_differences = 0
+	for old_file_path, new_file_path in path_pair_list:
+		difference = compare_file(old_file_path, new_file_path)
+		if difference is None:
+			sys.stderr.write("same: %s\n" % new_file_path)
+		else:
+			no_of_differences += 1
+			sys.stderr.write("DIFFERENT: %s %s\n" % (new_file_path, difference))
+	sys.stderr.write("%s of %s files differ.\n" % (no_of_differences, len(path_pair_list)))
+	sys.exit(1 if no_of_differences > 0 else 0)
+
+
+if __name__ == "__main__":
+	main()
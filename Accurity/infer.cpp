@@ -1,4 +1,6 @@
+#include <boost/program_options.hpp>
 #include "infer.h"
+namespace po = boost::program_options;
 using namespace std;
 
 //20171228 sort peak in descending order by no_of_windows
@@ -10,47 +12,87 @@ struct peak_greater_no_of_windows
     }
 };
 
-Infer::Infer(string configFilepath, string segment_data_input_path,
-             string snp_data_input_path,
-             string output_dir,
-             float segment_stddev_divider,
-             int snp_coverage_min, float snp_coverage_var_vs_mean_ratio,
-             int no_of_peaks_for_logL,
-             int debug, int auto_)
-        : _configFilepath(configFilepath),
-          _segment_data_input_path(segment_data_input_path),
-          _snp_data_input_path(snp_data_input_path),
-          _output_dir(output_dir),
-          _segment_stddev_divider(segment_stddev_divider),
-          _snp_coverage_min(snp_coverage_min),
-          _snp_coverage_var_vs_mean_ratio(snp_coverage_var_vs_mean_ratio),
-          _no_of_peaks_for_logL(no_of_peaks_for_logL),
-          _debug(debug),
-          _auto(auto_)
+//2026.10.18 events of the debug logs of the hot loops, see trace.h
+enum InferTraceEventType
+{
+    kTraceRCLogLPeriod,
+    kTraceRCLogLPeak,
+    kTraceSNPMafExpVsAdj,
+    kTraceSNPLogL,
+    kTraceSNPLogLOfRCPeak
+};
+
+//the rows as the log files had them when streamed directly, floats were widened to double there too
+static void decode_rc_logL_period(ostream &out, const TraceEvent &event)
+{
+    const double *v = event.values;
+    out << "period_int" << "\t" << int(v[0]) << "\t" << "half-width" << "\t" << int(v[1]) << "\n";
+    out << "peak_index" << "\t" << "peak_center_float" << "\t" << "logL_peak" << "\t" << "candidate_period.logL"
+        << "\n";
+}
+
+static void decode_rc_logL_peak(ostream &out, const TraceEvent &event)
+{
+    const double *v = event.values;
+    out << int(v[0]) << "\t" << v[1] << "\t" << v[2] << "\t" << v[3] << "\n";
+}
+
+static void decode_snp_maf_exp_vs_adj(ostream &out, const TraceEvent &event)
+{
+    const double *v = event.values;
+    out << int(v[0]) << "\t" << int(v[1]) << "\t" << int(v[2]) << "\t" << int(v[3]) << "\t" << int(v[4]) << "\t"
+        << int(v[5]) << "\t" << v[6] << "\t" << v[7] << "\t" << v[8] << "\t" << v[9] << "\t" << v[10] << "\t"
+        << int(v[11]) << "\t" << v[12] << "\n";
+}
+
+static void decode_snp_logL(ostream &out, const TraceEvent &event)
+{
+    const double *v = event.values;
+    out << int(v[0]) << "\t" << int(v[1]) << "\t" << int(v[2]) << "\t" << int(v[3]) << "\t" << int(v[4]) << "\t"
+        << int(v[5]);
+    for (int i = 6; i < 15; i++)
+        out << "\t" << v[i];
+    out << "\t" << int(v[15]) << "\t" << int(v[16]) << "\n";
+}
+
+//the summary row of one read count peak, -1 in the columns of single MAF peaks
+static void decode_snp_logL_of_rc_peak(ostream &out, const TraceEvent &event)
+{
+    const double *v = event.values;
+    out << int(v[0]) << "\t" << int(v[1]) << "\t" << int(v[2]);
+    for (int i = 0; i < 7; i++)
+        out << "\t" << -1;
+    out << "\t" << v[3] << "\t" << v[4] << "\t" << -1 << "\t" << v[5] << "\t" << v[6] << "\t" << int(v[7])
+        << "\t" << -1 << "\n";
+}
+
+Infer::Infer(const InferOptions &options)
+        : _configFilepath(options.config_file_path),
+          _output_dir(options.output_dir),
+          _write_artifacts(options.write_artifacts),
+          _log(options.log ? options.log->rdbuf() : NULL),
+          _result(NULL),
+          _segment_stddev_divider(options.segment_stddev_divider),
+          _snp_coverage_min(options.snp_coverage_min),
+          _snp_coverage_var_vs_mean_ratio(options.snp_coverage_var_vs_mean_ratio),
+          _no_of_peaks_for_logL(options.no_of_peaks_for_logL),
+          //_debug>0 only adds diagnostic files and messages
+          _debug(options.write_artifacts ? options.debug : 0),
+          _auto(options.auto_),
+          _segmentation_engine(options.segmentation_engine),
+          _segment_stream_timeout(options.segment_stream_timeout),
+          _segment_min_len(options.segment_min_len),
+          _segment_t_score(options.segment_t_score),
+          _no_of_reader_threads(options.no_of_reader_threads),
+          _maf_cache(options.maf_cache),
+          _cache_dir(options.cache_dir),
+          _prepare_segments(true)
 {
     _periodObjVector.reserve(5);
     _snp_maf_stddev_divider = 20.0;
-    if (_segment_stddev_divider<=0){
-        cerr << fmt::format("ERROR: _segment_stddev_divider {} less than or equal to 0.\n", _segment_stddev_divider);
-        exit(3);
-    }
-    if (_snp_coverage_min<=0){
-        cerr << fmt::format("ERROR: _snp_coverage_min {} less than or equal to 0.\n", _snp_coverage_min);
-        exit(3);
-    }
-    if (_snp_coverage_var_vs_mean_ratio<=0){
-        cerr << fmt::format("ERROR: _snp_coverage_var_vs_mean_ratio {} less than or equal to 0.\n",
-                            _snp_coverage_var_vs_mean_ratio);
-        exit(3);
-    }
-    if (_no_of_peaks_for_logL<=0){
-        cerr << fmt::format("ERROR: _no_of_peaks_for_logL {} less than or equal to 0.\n",
-                            _no_of_peaks_for_logL);
-        exit(3);
-    }
 
     _returnCode = 0;
-    _SNPs.resize(NUM_AUTO_CHR, vector<OneSNP>());
+    _SNPs.resize(NUM_AUTO_CHR);
     _rc_ratio_segments.resize(MAX_RATIO_RANGE_HIGH_RES + 1,
                               vector<OneSegment>());
     _total_no_of_snps = 0;
@@ -66,59 +108,13 @@ Infer::Infer(string configFilepath, string segment_data_input_path,
 
     _probInstance = Prob();
     _period_obj_from_autocor = OnePeriod();
-    _config = read_para(_configFilepath);
 
     // initialize all arrays
     for (int rc_ratio_int = 0; rc_ratio_int < MAX_RATIO_HIGH_RES+1;
          rc_ratio_int++)
         _ratio_int_pdf_vec.push_back(0.0);
     for (int i = 0; i <= kPeriodMax; i++) _cor_array[i] = 0.0;
-
-    string tmp_file_path;
-    _infer_outf.open(fmt::format("{}/infer.out.tsv", _output_dir).c_str());
-    _infer_details_outf.open(fmt::format("{}/infer.out.details.tsv", _output_dir).c_str());
-
-    if (_debug > 0)
-    {
-        tmp_file_path = _output_dir + "/rc_logLikelihood.log.tsv";
-        _rc_logL_outf.open(tmp_file_path.c_str(), ios::trunc);
-
-        tmp_file_path = _output_dir + "/snp_maf_exp_vs_adj.tsv";
-        _snp_maf_exp_vs_adj_outf.open(tmp_file_path.c_str(),
-                                      ios::trunc);
-        _snp_maf_exp_vs_adj_outf
-                << "period_int" << "\t" << "no_of_copy_nos_bf_1st_peak" << "\t" <<
-                "peak_index" << "\t" << "cp" << "\t" << "major_allele_cp" << "\t" <<
-                "fpeak" << "\t" << "purity" << "\t" << "ploidy" << "\t" <<
-                "major_allele_fraction_exp" << "\t" <<
-                "snp_coverage_mean_of_one_peak" << "\t" <<
-                "snp_coverage_var_of_one_peak" << "\t" <<
-                "no_of_snps.peak" << "\t" << "maf_exp_adjusted" << endl;
-
-        tmp_file_path = _output_dir + "/snp_logL.log.tsv";
-        _snp_logL_outf.open(tmp_file_path.c_str(), ios::trunc);
-        _snp_logL_outf << "period_int" << "\t" <<
-                       "no_of_copy_nos_bf_1st_peak" << "\t" <<
-                       "peak_index" << "\t" <<
-                       "peak_obj.no_of_maf_peaks" << "\t" <<
-                       "index.maf_peak" << "\t" <<
-                       "seg_count_per_maf_peak[i]" << "\t" <<
-                       "var_of_maf_per_maf_peak[i]" << "\t" <<
-                       "sq_diff_per_maf_peak[i]" << "\t" <<
-                       "no_of_snps_per_maf_peak[i]" << "\t" <<
-                       "std_per_maf_peak[i]" << "\t" << "lod_snp" << "\t" <<
-                       "logL_snp" << "\t" << "logL_of_one_maf_peak" << "\t" <<
-                       "ssum_sq_diff" << "\t" <<
-                       "peak_obj.snp_maf_var" << "\t" <<
-                       "no_of_snps_of_one_rc_peak" << "\t" <<
-                       "currentPeriodObj.no_of_maf_peaks" << endl;
-    }
-    cerr <<"_segment_stddev_divider=" << _segment_stddev_divider << endl;
-    cerr <<"_snp_maf_stddev_divider=" << _snp_maf_stddev_divider << endl;
-    cerr <<"_snp_covearge_min=" << _snp_coverage_min << endl;
-    cerr <<"_snp_coverage_var_vs_mean_ratio=" << _snp_coverage_var_vs_mean_ratio << endl;
-    cerr <<"_no_of_peaks_for_logL=" << _no_of_peaks_for_logL << endl;
-
+    for (int i = 0; i <= MAX_RATIO_HIGH_RES; i++) _pool_hist[i] = 0.0;
 }
 
 Infer::~Infer()
@@ -127,49 +123,647 @@ Infer::~Infer()
     _rc_ratio_segments.clear();
     _infer_outf.close();
     _infer_details_outf.close();
+}
 
-    if (_debug > 0)
+//2026.10.18 records message as the error of the current run and returns the error code of infer, 3
+int Infer::setError(const string &message)
+{
+    _log << "ERROR: " << message << endl;
+    _result->status = kInferError;
+    _result->message = message;
+    return 3;
+}
+
+int inferPurityPloidy(const InferInput &input, const InferOptions &options, InferResult &result)
+{
+    Infer infInstance(options);
+    return infInstance.run(input, result);
+}
+
+int loadInferInput(const InferInput &input, const InferOptions &options, vector<SNPRecord> &snp_vec,
+                   vector<SegmentRecord> &segment_vec, InferResult &result)
+{
+    Infer infInstance(options);
+    return infInstance.load(input, snp_vec, segment_vec, result);
+}
+
+//the quantile of sorted_vec at fraction, interpolating between the closest values
+static double percentile(const vector<double> &sorted_vec, double fraction)
+{
+    double position = fraction * (sorted_vec.size() - 1);
+    size_t lower_index = (size_t) floor(position);
+    size_t upper_index = min(lower_index + 1, sorted_vec.size() - 1);
+    return sorted_vec[lower_index] + (position - lower_index) * (sorted_vec[upper_index] - sorted_vec[lower_index]);
+}
+
+static BootstrapInterval percentile_interval(vector<double> value_vec, double confidence)
+{
+    BootstrapInterval interval;
+    if (value_vec.empty())
+        return interval;
+    std::sort(value_vec.begin(), value_vec.end());
+    interval.lower = percentile(value_vec, (1 - confidence) / 2);
+    interval.upper = percentile(value_vec, 1 - (1 - confidence) / 2);
+    return interval;
+}
+
+int bootstrapPurityPloidy(const InferInput &input, const InferOptions &options,
+                          const BootstrapOptions &bootstrap_options, BootstrapResult &result)
+{
+    result = BootstrapResult();
+    vector<SNPRecord> snp_vec;
+    vector<SegmentRecord> loaded_segment_vec;
+    InferInput point_input = input;
+    if (!input.segments_prepared)
+    {
+        InferOptions load_options = options;
+        load_options.write_artifacts = false;
+        load_options.log = NULL;
+        int return_code = loadInferInput(input, load_options, snp_vec, loaded_segment_vec, result.point);
+        if (return_code != 0)
+            return return_code;
+        point_input = InferInput();
+        point_input.segments = loaded_segment_vec.data();
+        point_input.no_of_segments = loaded_segment_vec.size();
+        point_input.snps = snp_vec.data();
+        point_input.no_of_snps = snp_vec.size();
+        point_input.segments_prepared = true;
+    }
+    AdjustedMafCache local_maf_cache;
+    InferOptions point_options = options;
+    if (!point_options.maf_cache)
+        point_options.maf_cache = &local_maf_cache;
+    int return_code = inferPurityPloidy(point_input, point_options, result.point);
+    if (return_code != 0 || point_input.no_of_segments == 0)
+        return return_code;
+
+    InferOptions replicate_options = point_options;
+    replicate_options.write_artifacts = false;
+    replicate_options.log = NULL;
+    replicate_options.no_of_reader_threads = 1;
+    result.replicate_vec.resize(max(bootstrap_options.no_of_replicates, 0));
+    int no_of_threads = bootstrap_options.no_of_threads;
+    if (no_of_threads <= 0)
+        no_of_threads = max(1u, std::thread::hardware_concurrency());
+    no_of_threads = max(1, min<int>(no_of_threads, result.replicate_vec.size()));
+    std::atomic<size_t> next_replicate_index(0);
+    auto run_replicates = [&]() {
+        vector<SegmentRecord> segment_vec(point_input.no_of_segments);
+        vector<size_t> index_vec(point_input.no_of_segments);
+        for (size_t replicate_index = next_replicate_index++; replicate_index < result.replicate_vec.size();
+             replicate_index = next_replicate_index++)
+        {
+            std::mt19937 random_engine(bootstrap_options.seed + replicate_index);
+            std::uniform_int_distribution<size_t> index_distribution(0, point_input.no_of_segments - 1);
+            for (size_t &segment_index : index_vec)
+                segment_index = index_distribution(random_engine);
+            //drawn segments keep the order of the input
+            std::sort(index_vec.begin(), index_vec.end());
+            for (size_t i = 0; i < index_vec.size(); i++)
+                segment_vec[i] = point_input.segments[index_vec[i]];
+            InferInput replicate_input;
+            replicate_input.segments = segment_vec.data();
+            replicate_input.no_of_segments = segment_vec.size();
+            replicate_input.segments_prepared = true;
+            InferResult replicate_result;
+            inferPurityPloidy(replicate_input, replicate_options, replicate_result);
+            BootstrapReplicate &replicate = result.replicate_vec[replicate_index];
+            replicate.status = replicate_result.status;
+            replicate.purity = replicate_result.purity;
+            replicate.ploidy = replicate_result.ploidy;
+            replicate.Q = replicate_result.Q;
+        }
+    };
+    vector<std::thread> thread_vec;
+    for (int thread_index = 1; thread_index < no_of_threads; thread_index++)
+        thread_vec.push_back(std::thread(run_replicates));
+    run_replicates();
+    for (std::thread &worker_thread : thread_vec)
+        worker_thread.join();
+
+    vector<double> purity_vec, ploidy_vec, Q_vec;
+    for (const BootstrapReplicate &replicate : result.replicate_vec)
+    {
+        if (replicate.status != kInferSolved)
+            continue;
+        purity_vec.push_back(replicate.purity);
+        ploidy_vec.push_back(replicate.ploidy);
+        Q_vec.push_back(replicate.Q);
+    }
+    result.no_of_replicates_solved = purity_vec.size();
+    result.purity = percentile_interval(purity_vec, bootstrap_options.confidence);
+    result.ploidy = percentile_interval(ploidy_vec, bootstrap_options.confidence);
+    result.Q = percentile_interval(Q_vec, bootstrap_options.confidence);
+    return 0;
+}
+
+int sweepPurityPloidy(const InferInput &input, const InferOptions &options, const SweepGrid &grid,
+                      vector<SweepPoint> &point_vec)
+{
+    //an empty axis keeps the value of options
+    vector<float> divider_vec = grid.segment_stddev_divider_vec;
+    if (divider_vec.empty())
+        divider_vec.push_back(options.segment_stddev_divider);
+    vector<int> coverage_min_vec = grid.snp_coverage_min_vec;
+    if (coverage_min_vec.empty())
+        coverage_min_vec.push_back(options.snp_coverage_min);
+    vector<float> var_vs_mean_ratio_vec = grid.snp_coverage_var_vs_mean_ratio_vec;
+    if (var_vs_mean_ratio_vec.empty())
+        var_vs_mean_ratio_vec.push_back(options.snp_coverage_var_vs_mean_ratio);
+    vector<int> no_of_peaks_vec = grid.no_of_peaks_for_logL_vec;
+    if (no_of_peaks_vec.empty())
+        no_of_peaks_vec.push_back(options.no_of_peaks_for_logL);
+    point_vec.clear();
+    for (float segment_stddev_divider : divider_vec)
+        for (int snp_coverage_min : coverage_min_vec)
+            for (float snp_coverage_var_vs_mean_ratio : var_vs_mean_ratio_vec)
+                for (int no_of_peaks_for_logL : no_of_peaks_vec)
+                {
+                    SweepPoint point;
+                    point.segment_stddev_divider = segment_stddev_divider;
+                    point.snp_coverage_min = snp_coverage_min;
+                    point.snp_coverage_var_vs_mean_ratio = snp_coverage_var_vs_mean_ratio;
+                    point.no_of_peaks_for_logL = no_of_peaks_for_logL;
+                    point_vec.push_back(point);
+                }
+
+    vector<SNPRecord> snp_vec;
+    vector<SegmentRecord> segment_vec;
+    InferInput prepared_input = input;
+    if (!input.segments_prepared)
+    {
+        InferOptions load_options = options;
+        load_options.write_artifacts = false;
+        load_options.log = NULL;
+        InferResult load_result;
+        int return_code = loadInferInput(input, load_options, snp_vec, segment_vec, load_result);
+        if (return_code != 0)
+        {
+            for (SweepPoint &point : point_vec)
+                point.result = load_result;
+            return return_code;
+        }
+        prepared_input = InferInput();
+        prepared_input.segments = segment_vec.data();
+        prepared_input.no_of_segments = segment_vec.size();
+        prepared_input.snps = snp_vec.data();
+        prepared_input.no_of_snps = snp_vec.size();
+        prepared_input.segments_prepared = true;
+    }
+
+    int no_of_threads = grid.no_of_threads;
+    if (no_of_threads <= 0)
+        no_of_threads = max(1u, std::thread::hardware_concurrency());
+    //a unit is a run of points with one segment_stddev_divider, split so that every thread gets one
+    size_t unit_size = max<size_t>(1, (point_vec.size() + no_of_threads - 1) / no_of_threads);
+    size_t points_per_divider = point_vec.size() / divider_vec.size();
+    vector<pair<size_t, size_t> > unit_vec;
+    for (size_t divider_start = 0; divider_start < point_vec.size(); divider_start += points_per_divider)
+        for (size_t unit_start = divider_start; unit_start < divider_start + points_per_divider;
+             unit_start += unit_size)
+            unit_vec.push_back(make_pair(unit_start, min(unit_start + unit_size, divider_start + points_per_divider)));
+    no_of_threads = max(1, min<int>(no_of_threads, unit_vec.size()));
+
+    AdjustedMafCache local_maf_cache;
+    InferOptions unit_options = options;
+    unit_options.write_artifacts = false;
+    unit_options.log = NULL;
+    unit_options.no_of_reader_threads = 1;
+    if (!unit_options.maf_cache)
+        unit_options.maf_cache = &local_maf_cache;
+    vector<int> return_code_vec(unit_vec.size(), 0);
+    std::atomic<size_t> next_unit_index(0);
+    auto run_units = [&]() {
+        for (size_t unit_index = next_unit_index++; unit_index < unit_vec.size(); unit_index = next_unit_index++)
+        {
+            SweepPoint &first_point = point_vec[unit_vec[unit_index].first];
+            InferOptions point_options = unit_options;
+            point_options.segment_stddev_divider = first_point.segment_stddev_divider;
+            point_options.snp_coverage_min = first_point.snp_coverage_min;
+            point_options.snp_coverage_var_vs_mean_ratio = first_point.snp_coverage_var_vs_mean_ratio;
+            point_options.no_of_peaks_for_logL = first_point.no_of_peaks_for_logL;
+            Infer infInstance(point_options);
+            return_code_vec[unit_index] = infInstance.sweep(prepared_input, &first_point,
+                                                            unit_vec[unit_index].second - unit_vec[unit_index].first);
+        }
+    };
+    vector<std::thread> thread_vec;
+    for (int thread_index = 1; thread_index < no_of_threads; thread_index++)
+        thread_vec.push_back(std::thread(run_units));
+    run_units();
+    for (std::thread &worker_thread : thread_vec)
+        worker_thread.join();
+    for (int return_code : return_code_vec)
+        if (return_code != 0)
+            return return_code;
+    return 0;
+}
+
+//every stride-th of the index_vec.size() items from offset on, in their original order
+static void take_every(const vector<size_t> &index_vec, size_t stride, size_t offset, vector<size_t> &taken_vec)
+{
+    for (size_t rank = offset; rank < index_vec.size(); rank += stride)
+        taken_vec.push_back(index_vec[rank]);
+    std::sort(taken_vec.begin(), taken_vec.end());
+}
+
+int previewPurityPloidy(const InferInput &input, const InferOptions &options, const PreviewOptions &preview_options,
+                        PreviewResult &result)
+{
+    result = PreviewResult();
+    InferOptions load_options = options;
+    load_options.write_artifacts = false;
+    load_options.log = NULL;
+    vector<SNPRecord> snp_vec;
+    vector<SegmentRecord> segment_vec;
     {
-        _rc_logL_outf.close();
-        _snp_maf_exp_vs_adj_outf.close();
-        _snp_logL_outf.close();
-        rc_ratio_by_chr_out_file.flush();
-        rc_ratio_by_chr_out_file.close();
+        Infer infInstance(load_options);
+        int return_code = infInstance.load(input, snp_vec, segment_vec, result.subsample_result_array[0], false);
+        if (return_code != 0)
+        {
+            result.subsample_result_array[1] = result.subsample_result_array[0];
+            return return_code;
+        }
     }
+
+    //subsample 0 takes the items of rank 0, stride, 2*stride, ..., subsample 1 those half a stride later
+    size_t snp_stride = max<size_t>(2, min<size_t>((size_t) round(1 / preview_options.snp_fraction),
+                                                   snp_vec.size() / max<size_t>(1, preview_options.min_no_of_snps)));
+    size_t segment_stride = max<size_t>(2, (size_t) round(1 / preview_options.segment_fraction));
+    map<string, vector<size_t> > snp_index_vec_by_chr;
+    for (size_t snp_index = 0; snp_index < snp_vec.size(); snp_index++)
+        snp_index_vec_by_chr[snp_vec[snp_index].chr_string].push_back(snp_index);
+    vector<size_t> segment_index_vec(segment_vec.size());
+    for (size_t segment_index = 0; segment_index < segment_vec.size(); segment_index++)
+        segment_index_vec[segment_index] = segment_index;
+    std::stable_sort(segment_index_vec.begin(), segment_index_vec.end(), [&](size_t i, size_t j) {
+        return segment_vec[i].no_of_valid_windows < segment_vec[j].no_of_valid_windows;
+    });
+
+    vector<SNPRecord> subsample_snp_vec_array[2];
+    vector<SegmentRecord> subsample_segment_vec_array[2];
+    for (int subsample_index = 0; subsample_index < 2; subsample_index++)
+    {
+        vector<size_t> taken_snp_index_vec;
+        for (const auto &chr_snp_index_vec : snp_index_vec_by_chr)
+        {
+            vector<size_t> taken_vec;
+            take_every(chr_snp_index_vec.second, snp_stride, subsample_index * snp_stride / 2, taken_vec);
+            taken_snp_index_vec.insert(taken_snp_index_vec.end(), taken_vec.begin(), taken_vec.end());
+        }
+        std::sort(taken_snp_index_vec.begin(), taken_snp_index_vec.end());
+        for (size_t snp_index : taken_snp_index_vec)
+            subsample_snp_vec_array[subsample_index].push_back(snp_vec[snp_index]);
+        vector<size_t> taken_segment_index_vec;
+        take_every(segment_index_vec, segment_stride, subsample_index * segment_stride / 2, taken_segment_index_vec);
+        for (size_t segment_index : taken_segment_index_vec)
+            subsample_segment_vec_array[subsample_index].push_back(segment_vec[segment_index]);
+    }
+    result.no_of_snps_per_subsample = subsample_snp_vec_array[0].size();
+    result.no_of_segments_per_subsample = subsample_segment_vec_array[0].size();
+
+    AdjustedMafCache local_maf_cache;
+    InferOptions subsample_options = load_options;
+    subsample_options.no_of_reader_threads = 1;
+    if (!subsample_options.maf_cache)
+        subsample_options.maf_cache = &local_maf_cache;
+    int return_code_array[2] = {0, 0};
+    auto run_subsample = [&](int subsample_index) {
+        InferInput subsample_input;
+        subsample_input.snps = subsample_snp_vec_array[subsample_index].data();
+        subsample_input.no_of_snps = subsample_snp_vec_array[subsample_index].size();
+        subsample_input.segments = subsample_segment_vec_array[subsample_index].data();
+        subsample_input.no_of_segments = subsample_segment_vec_array[subsample_index].size();
+        return_code_array[subsample_index] = inferPurityPloidy(subsample_input, subsample_options,
+                                                               result.subsample_result_array[subsample_index]);
+    };
+    std::thread subsample_thread(run_subsample, 1);
+    run_subsample(0);
+    subsample_thread.join();
+
+    const InferResult &first_result = result.subsample_result_array[0];
+    const InferResult &second_result = result.subsample_result_array[1];
+    if (first_result.status == kInferSolved && second_result.status == kInferSolved)
+    {
+        result.purity = (first_result.purity + second_result.purity) / 2;
+        result.ploidy = (first_result.ploidy + second_result.ploidy) / 2;
+        result.purity_difference = fabs(first_result.purity - second_result.purity);
+        result.ploidy_difference = fabs(first_result.ploidy - second_result.ploidy);
+        result.stable = result.purity_difference <= preview_options.purity_tolerance &&
+                        result.ploidy_difference <= preview_options.ploidy_tolerance;
+    }
+    return return_code_array[0] != 0 ? return_code_array[0] : return_code_array[1];
+}
+
+//reads SNPs and segments as run() would, but keeps them as records instead of going on
+int Infer::load(const InferInput &input, vector<SNPRecord> &snp_vec, vector<SegmentRecord> &segment_vec,
+                InferResult &result, bool prepare_segments)
+{
+    result = InferResult();
+    _result = &result;
+    _prepare_segments = prepare_segments;
+    if (_segmentation_engine!=kEngineSBL && _segmentation_engine!=kEnginePELT)
+        return setError(fmt::format("unknown _segmentation_engine {}.", _segmentation_engine));
+    snp_vec.clear();
+    segment_vec.clear();
+    _returnCode = getSNPDataFromFile(input.snp_data_input_path, &snp_vec);
+    if (_returnCode != 0)
+        return _returnCode;
+    vector<vector<SegmentRecord> > record_vec_by_file;
+    _returnCode = readSegmentFiles(input.segment_data_input_path, record_vec_by_file);
+    if (_returnCode != 0)
+        return _returnCode;
+    for (const vector<SegmentRecord> &record_vec : record_vec_by_file)
+        segment_vec.insert(segment_vec.end(), record_vec.begin(), record_vec.end());
+    _result->status = kInferSolved;
+    _result->no_of_segments = segment_vec.size();
+    _result->no_of_snps = _total_no_of_snps;
+    return 0;
 }
 
 void Infer::recalibrate_Q_and_purity_based_on_cnv_ploidy(OnePeriod &best_period_obj){
-    cerr << "Recalibrating Q and purity based on CNV ploidy ..." ;
+    _log << "Recalibrating Q and purity based on CNV ploidy ..." ;
     best_period_obj.rc_ratio_int_of_cp_2_corrected = FRESOLUTION -
                                                      (best_period_obj.ploidy_corrected-2.0)*best_period_obj.period_int;
     best_period_obj.purity_corrected = 2.0*best_period_obj.period_int
                                        /best_period_obj.rc_ratio_int_of_cp_2_corrected;
-    cerr<< "Q=" << best_period_obj.rc_ratio_int_of_cp_2_corrected
+    _log<< "Q=" << best_period_obj.rc_ratio_int_of_cp_2_corrected
         << " purity=" << best_period_obj.purity_corrected
         << " ploidy=" << best_period_obj.ploidy_corrected
         << endl;
 }
 
-int Infer::run()
+//a run reads the input, so an Infer instance is good for one run
+int Infer::run(const InferInput &input, InferResult &result)
+{
+    result = InferResult();
+    _result = &result;
+    int returnCode = runPhases(input);
+    if (_write_artifacts)
+    {
+        recordMemory("end");
+        if (_tracer.active())
+        {
+            RunProfile::ScopedPhase trace_phase(_profile, "trace_decode");
+            _tracer.finish();
+        }
+        //2026.10.18 where the time went, next to infer.out.tsv
+        _profile.setCount("segments", _result->no_of_segments);
+        _profile.setCount("segments_used", _result->no_of_segments_used);
+        _profile.setCount("snps", _result->no_of_snps);
+        _profile.setCount("snps_used", _result->no_of_snps_used);
+        _profile.setCount("candidate_periods", _result->logL_table.size());
+        _profile.setCount("cn_segments", _result->cn_segments.size());
+        _profile.setCount("status", _result->status);
+        _profile.writeJSON(fmt::format("{}/infer.profile.json", _output_dir), "infer");
+    }
+    return returnCode;
+}
+
+static size_t period_bytes(const OnePeriod &period_obj)
+{
+    size_t bytes = sizeof(OnePeriod) + vector_bytes(period_obj.logL_snp_vector) +
+                   vector_bytes(period_obj.lod_snp_vector) + vector_bytes(period_obj.snp_penalty_vector) +
+                   vector_bytes(period_obj.snp_no_of_parameters_vector) + vector_bytes(period_obj.purity_vector) +
+                   vector_bytes(period_obj.ploidy_vector) + vector_bytes(period_obj.no_of_copy_nos_bf_1st_peak_vector) +
+                   vector_bytes(period_obj.peak_obj_vector);
+    for (const OnePeak &peak_obj : period_obj.peak_obj_vector)
+        bytes += vector_bytes(peak_obj.segment_rc_ratio_vector) + vector_bytes(peak_obj.maf_int_pdf_vec) +
+                 vector_bytes(peak_obj.segment_obj_vector);
+    return bytes;
+}
+
+//2026.10.18 memory snapshot of the main structures for the profile, plus transient ones of the caller
+void Infer::recordMemory(const string &checkpoint_name, const RunProfile::StructureBytes &transient_vec)
+{
+    if (!_write_artifacts)
+        return;
+    RunProfile::StructureBytes structure_bytes_vec;
+    size_t snp_bytes = vector_bytes(_SNPs);
+    for (const ChrSNPStore &chr_snp_store : _SNPs)
+        snp_bytes += chr_snp_store.bytes();
+    structure_bytes_vec.push_back(make_pair(string("snps"), snp_bytes));
+    size_t segment_bytes = vector_bytes(_rc_ratio_segments);
+    for (const vector<OneSegment> &segment_vec : _rc_ratio_segments)
+        segment_bytes += vector_bytes(segment_vec);
+    structure_bytes_vec.push_back(make_pair(string("rc_ratio_segments"), segment_bytes));
+    structure_bytes_vec.push_back(make_pair(string("ratio_pdf_and_autocor"), vector_bytes(_ratio_int_pdf_vec) +
+                                                                             sizeof(_cor_array) + sizeof(_pool_hist)));
+    size_t period_and_peak_bytes = vector_bytes(_periodObjVector) + period_bytes(_period_obj_from_autocor) +
+                                   period_bytes(_period_obj_from_logL);
+    for (const OnePeriod &period_obj : _periodObjVector)
+        period_and_peak_bytes += period_bytes(period_obj) - sizeof(OnePeriod);
+    structure_bytes_vec.push_back(make_pair(string("periods_and_peaks"), period_and_peak_bytes));
+    structure_bytes_vec.push_back(make_pair(string("result"), vector_bytes(_result->logL_table) +
+                                                              vector_bytes(_result->cn_segments)));
+    //the other debug outputs are written and closed within one phase
+    structure_bytes_vec.push_back(make_pair(string("trace_buffers"), _tracer.bytes()));
+    structure_bytes_vec.insert(structure_bytes_vec.end(), transient_vec.begin(), transient_vec.end());
+    _profile.addMemorySnapshot(checkpoint_name, structure_bytes_vec);
+}
+
+//the parameters a sweep changes
+int Infer::checkParameters()
+{
+    if (_segment_stddev_divider<=0)
+        return setError(fmt::format("_segment_stddev_divider {} less than or equal to 0.", _segment_stddev_divider));
+    if (_snp_coverage_min<=0)
+        return setError(fmt::format("_snp_coverage_min {} less than or equal to 0.", _snp_coverage_min));
+    if (_snp_coverage_var_vs_mean_ratio<=0)
+        return setError(fmt::format("_snp_coverage_var_vs_mean_ratio {} less than or equal to 0.",
+                                    _snp_coverage_var_vs_mean_ratio));
+    if (_no_of_peaks_for_logL<=0)
+        return setError(fmt::format("_no_of_peaks_for_logL {} less than or equal to 0.", _no_of_peaks_for_logL));
+    return 0;
+}
+
+int Infer::runPhases(const InferInput &input)
+{
+    vector<OnePeriod> candidate_period_vec;
+    int returnCode = detectCandidatePeriods(input, candidate_period_vec);
+    //a detection that ends the run sets the status
+    if (returnCode != 0 || _result->status != kInferError)
+        return returnCode;
+    return selectPeriodByLogL(candidate_period_vec);
+}
+
+//2026.10.18 runs the grid points of the segment_stddev_divider of this Infer on one input: the segments are folded
+// and the candidate periods detected once, only the likelihoods and copy numbers are redone for each point
+int Infer::sweep(const InferInput &input, SweepPoint *points, size_t no_of_points)
+{
+    InferResult detection_result;
+    _result = &detection_result;
+    vector<OnePeriod> candidate_period_vec;
+    int returnCode = detectCandidatePeriods(input, candidate_period_vec);
+    bool detection_ended_run = returnCode != 0 || detection_result.status != kInferError;
+    for (size_t point_index = 0; point_index < no_of_points; point_index++)
+    {
+        SweepPoint &point = points[point_index];
+        point.result = detection_result;
+        if (detection_ended_run)
+            continue;
+        _result = &point.result;
+        _snp_coverage_min = point.snp_coverage_min;
+        _snp_coverage_var_vs_mean_ratio = point.snp_coverage_var_vs_mean_ratio;
+        _no_of_peaks_for_logL = point.no_of_peaks_for_logL;
+        if (checkParameters() != 0)
+            continue;
+        _periodObjVector.clear();
+        _period_obj_from_logL = OnePeriod();
+        //the logL stage refines the peaks of the candidates in place
+        vector<OnePeriod> point_candidate_period_vec = candidate_period_vec;
+        selectPeriodByLogL(point_candidate_period_vec);
+    }
+    _result = NULL;
+    return returnCode;
+}
+
+//everything before the likelihoods: parameters, SNPs, segments, the ratio histogram and the candidate periods
+int Infer::detectCandidatePeriods(const InferInput &input, vector<OnePeriod> &candidate_period_vec)
 {
-    getSNPDataFromFile(_snp_data_input_path);
-    getSegmentDataFromFile(_segment_data_input_path);
-    calculate_autocor();
+    RunProfile::ScopedPhase setup_phase(_profile, "setup");
+    int returnCode = checkParameters();
+    if (returnCode != 0)
+        return returnCode;
+    if (_segmentation_engine!=kEngineSBL && _segmentation_engine!=kEnginePELT)
+        return setError(fmt::format("unknown _segmentation_engine {}.", _segmentation_engine));
+    if (!_configFilepath.empty())
+    {
+        string error_msg;
+        if (!read_para(_configFilepath, _config, error_msg))
+            return setError(error_msg);
+        _log << "Data from configure file:\n" TabMACRO
+                "genome name " TabMACRO _config.ref NewLineMACRO TabMACRO
+                "read length " TabMACRO _config.readlength NewLineMACRO TabMACRO
+                "window size " TabMACRO _config.window NewLineMACRO TabMACRO
+                "reference genome index folder " TabMACRO _config.path_to_ref NewLineMACRO TabMACRO
+                "accurity path " TabMACRO _config.path NewLineMACRO;
+    }
+
+    if (_write_artifacts)
+    {
+        _infer_outf.open(fmt::format("{}/infer.out.tsv", _output_dir).c_str());
+        _infer_details_outf.open(fmt::format("{}/infer.out.details.tsv", _output_dir).c_str());
+        if (!_infer_outf || !_infer_details_outf)
+            return setError(fmt::format("could not write to output folder {}.", _output_dir));
+    }
+    //2026.10.18 the logs of the hot loops are traced, so only builds with ACCURITY_TRACE write them
+    if (_debug > 0 && !kTraceEnabled)
+        _log << "Built without ACCURITY_TRACE, no rc_logLikelihood.log.tsv, snp_maf_exp_vs_adj.tsv or "
+                "snp_logL.log.tsv. Build with 'make TRACE=1' (as the debug tarball is) to write them." << endl;
+    if (_debug > 0 && kTraceEnabled)
+    {
+        int sink = _tracer.addSink(_output_dir + "/rc_logLikelihood.log.tsv", "");
+        _tracer.addEventType(kTraceRCLogLPeriod, sink, decode_rc_logL_period);
+        _tracer.addEventType(kTraceRCLogLPeak, sink, decode_rc_logL_peak);
+
+        sink = _tracer.addSink(_output_dir + "/snp_maf_exp_vs_adj.tsv",
+                               "period_int\tno_of_copy_nos_bf_1st_peak\tpeak_index\tcp\tmajor_allele_cp\t"
+                               "fpeak\tpurity\tploidy\tmajor_allele_fraction_exp\t"
+                               "snp_coverage_mean_of_one_peak\tsnp_coverage_var_of_one_peak\t"
+                               "no_of_snps.peak\tmaf_exp_adjusted\n");
+        _tracer.addEventType(kTraceSNPMafExpVsAdj, sink, decode_snp_maf_exp_vs_adj);
+
+        sink = _tracer.addSink(_output_dir + "/snp_logL.log.tsv",
+                               "period_int\tno_of_copy_nos_bf_1st_peak\tpeak_index\tpeak_obj.no_of_maf_peaks\t"
+                               "index.maf_peak\tseg_count_per_maf_peak[i]\tvar_of_maf_per_maf_peak[i]\t"
+                               "sq_diff_per_maf_peak[i]\tno_of_snps_per_maf_peak[i]\tstd_per_maf_peak[i]\t"
+                               "lod_snp\tlogL_snp\tlogL_of_one_maf_peak\tssum_sq_diff\tpeak_obj.snp_maf_var\t"
+                               "no_of_snps_of_one_rc_peak\tcurrentPeriodObj.no_of_maf_peaks\n");
+        _tracer.addEventType(kTraceSNPLogL, sink, decode_snp_logL);
+        _tracer.addEventType(kTraceSNPLogLOfRCPeak, sink, decode_snp_logL_of_rc_peak);
+    }
+    _log <<"_segment_stddev_divider=" << _segment_stddev_divider << endl;
+    _log <<"_snp_maf_stddev_divider=" << _snp_maf_stddev_divider << endl;
+    _log <<"_snp_covearge_min=" << _snp_coverage_min << endl;
+    _log <<"_snp_coverage_var_vs_mean_ratio=" << _snp_coverage_var_vs_mean_ratio << endl;
+    _log <<"_no_of_peaks_for_logL=" << _no_of_peaks_for_logL << endl;
+    _log <<"_segmentation_engine=" << (_segmentation_engine==kEnginePELT ? "PELT" : "SBL") << endl;
+    setup_phase.stop();
+
+    //2026.10.18 with a cache folder, files read by an earlier run come as its prepared segments (SNP statistics
+    // included) and, for the same _segment_stddev_divider, its ratio histogram and autocorrelation. The diagnostic
+    // outputs of _debug>0 need the SNPs and window counts, so they always read the files.
+    uint64_t segment_cache_key = 0;
+    bool use_cache = !_cache_dir.empty() && _debug == 0 && _segment_stream_timeout == 0 &&
+                     input.no_of_snps == 0 && input.no_of_segments == 0;
+    bool segments_cached = false;
+    bool histogram_cached = false;
+    vector<vector<SegmentRecord> > cached_record_vec_by_file(1);
+    if (use_cache)
+    {
+        RunProfile::ScopedPhase phase(_profile, "cache_lookup");
+        use_cache = segmentCacheKey(input, segment_cache_key);
+        segments_cached = use_cache && readSegmentCache(segment_cache_key, cached_record_vec_by_file[0]);
+        histogram_cached = segments_cached && readHistogramCache(histogramCacheKey(segment_cache_key));
+        _profile.setCount("segment_cache_hit", segments_cached);
+        _profile.setCount("histogram_cache_hit", histogram_cached);
+    }
+    {
+        RunProfile::ScopedPhase phase(_profile, "snp_load");
+        if (segments_cached)
+            _returnCode = 0;
+        else if (input.no_of_snps > 0)
+            _returnCode = getSNPDataFromRecords(input.snps, input.no_of_snps);
+        else if (input.segments_prepared && input.snp_data_input_path.empty())
+            //2026.10.18 prepared segments carry their SNP statistics, a run needs no SNPs (bootstrap replicates)
+            _returnCode = 0;
+        else
+            _returnCode = getSNPDataFromFile(input.snp_data_input_path);
+    }
+    if (_returnCode != 0)
+        return _returnCode;
+    recordMemory("snp_load");
+    {
+        RunProfile::ScopedPhase phase(_profile, "segment_load");
+        if (input.no_of_segments > 0)
+            _returnCode = getSegmentDataFromRecords(input.segments, input.no_of_segments, input.segments_prepared);
+        else if (segments_cached)
+            //the cached histogram already holds the smoothed segments
+            foldSegmentFiles(cached_record_vec_by_file, !histogram_cached);
+        else if (use_cache)
+        {
+            vector<vector<SegmentRecord> > record_vec_by_file;
+            _returnCode = readSegmentFiles(input.segment_data_input_path, record_vec_by_file);
+            if (_returnCode == 0)
+            {
+                writeSegmentCache(segment_cache_key, record_vec_by_file);
+                foldSegmentFiles(record_vec_by_file);
+            }
+        }
+        else
+            _returnCode = getSegmentDataFromFile(input.segment_data_input_path);
+    }
+    if (_returnCode != 0)
+        return _returnCode;
+    recordMemory("segment_load");
+    _result->no_of_segments = _total_no_of_segments;
+    _result->no_of_segments_used = _total_no_of_segments_used;
+    _result->no_of_snps = _total_no_of_snps;
+    _result->no_of_snps_used = _total_no_of_snps_used;
+    RunProfile::ScopedPhase autocor_phase(_profile, "autocor");
+    if (!histogram_cached)
+    {
+        calculate_autocor();
+        if (use_cache)
+            writeHistogramCache(histogramCacheKey(segment_cache_key));
+    }
     if (_debug > 0) {
-        string output_filepath = _output_dir + "/auto.tsv";
-        ofstream tmp2(output_filepath.c_str());
-        tmp2 << "read_count_ratio" << "\t" << "correlation"
-             << "\n";
+        RowWriter auto_writer;
+        auto_writer.open(_output_dir + "/auto.tsv");
+        auto_writer.write("read_count_ratio\tcorrelation\n");
         for (int i = 0; i <= kPeriodMax; i++)
-            tmp2 << i / FRESOLUTION << "\t" << _cor_array[i] << "\n";
-        tmp2.close();
+            auto_writer.write("{:g}\t{:g}\n", i / FRESOLUTION, _cor_array[i]);
+        auto_writer.close();
 
         output_snp_maf_by_segment();
     }
+    autocor_phase.stop();
+    recordMemory("autocor");
     /*** will be updated as the one to find the largest difference with the
      * smallest valley OnePeriod ***/
 
-    vector<OnePeriod> candidate_period_vec;
+    RunProfile::ScopedPhase period_detection_phase(_profile, "period_detection");
     if (_auto > 0) {
         double left_x, right_x;
         double autocor_shift_diff[kPeriodMax];
@@ -193,42 +787,89 @@ int Infer::run()
                 break;
             case 1:
                 _infer_outf << "CNV profile too noisy!\n";
-                cerr << "CNV profile too noisy!\n";
+                _log << "CNV profile too noisy!\n";
+                _result->status = kInferTooNoisy;
+                _result->message = "CNV profile too noisy!";
                 return 0;
             case 2:
                 _infer_outf << "Not enough copy number variation!\n";
-                cerr << "Not enough copy number variation!\n";
+                _log << "Not enough copy number variation!\n";
+                _result->status = kInferNotEnoughCNV;
+                _result->message = "Not enough copy number variation!";
                 return 0;
             default:
                 return _returnCode;
         }
     }
+    period_detection_phase.stop();
+    recordMemory("period_detection");
+    return 0;
+}
 
+//picks the best candidate period by likelihood and outputs its copy numbers
+int Infer::selectPeriodByLogL(vector<OnePeriod> &candidate_period_vec)
+{
     if(candidate_period_vec.empty()){
         string status_msg = "ERROR: No candidate period discovered.\n";
         _infer_outf << status_msg;
-        cerr << status_msg;
+        _log << status_msg;
+        _result->status = kInferNoCandidatePeriod;
+        _result->message = "No candidate period discovered.";
         return 0;
     }
 
     _period_obj_from_logL = infer_best_period_by_logL(candidate_period_vec);
+    for (const OnePeriod &period_obj : _periodObjVector)
+    {
+        InferLogLRow logL_row;
+        logL_row.period_int = period_obj.period_int;
+        logL_row.logL = period_obj.logL;
+        logL_row.logL_rc = period_obj.logL_rc;
+        logL_row.logL_rc_penalty = period_obj.logL_rc_penalty;
+        logL_row.best_logL_snp = period_obj.best_logL_snp;
+        logL_row.best_lod_snp = period_obj.best_lod_snp;
+        logL_row.best_logL_snp_penalty = period_obj.best_logL_snp_penalty;
+        logL_row.best_logL_snp_no_of_parameters = period_obj.best_logL_snp_no_of_parameters;
+        logL_row.best_no_of_copy_nos_bf_1st_peak = period_obj.best_no_of_copy_nos_bf_1st_peak;
+        logL_row.first_peak_int = period_obj.first_peak_int;
+        logL_row.best_purity = period_obj.best_purity;
+        logL_row.best_ploidy = period_obj.best_ploidy;
+        _result->logL_table.push_back(logL_row);
+    }
+    recordMemory("candidate_logL");
 
     if (_period_obj_from_logL.logL>0 && _period_obj_from_logL.best_purity>0) {
-
+        RunProfile::ScopedPhase phase(_profile, "cn_output");
         _period_obj_from_logL.ploidy_corrected = output_copy_number_segments(_period_obj_from_logL,
                                                                              _period_obj_from_logL.peak_obj_vector);
         recalibrate_Q_and_purity_based_on_cnv_ploidy(_period_obj_from_logL);
+        _result->purity = _period_obj_from_logL.purity_corrected;
+        _result->ploidy = _period_obj_from_logL.ploidy_corrected;
+        _result->purity_naive = _period_obj_from_logL.best_purity;
+        _result->ploidy_naive = _period_obj_from_logL.best_ploidy;
+        _result->rc_ratio_of_cp_2 = _period_obj_from_logL.rc_ratio_int_of_cp_2;
+        _result->Q = _period_obj_from_logL.rc_ratio_int_of_cp_2_corrected;
+        _result->logL = _period_obj_from_logL.logL;
+        _result->period_int = _period_obj_from_logL.period_int;
+        _result->best_no_of_copy_nos_bf_1st_peak = _period_obj_from_logL.best_no_of_copy_nos_bf_1st_peak;
+        _result->first_peak_int = _period_obj_from_logL.first_peak_int;
+        _result->ploidy_cnv_all = _ploidy_cnv_all;
+        _result->ploidy_clonal = _ploidy_clonal;
 
         if (_period_obj_from_logL.purity_corrected>0 &&
             _period_obj_from_logL.purity_corrected<=1 &&
             _period_obj_from_logL.ploidy_corrected>=MIN_PLOIDY && _period_obj_from_logL.ploidy_corrected<=MAX_PLOIDY) {
             output_logL(_period_obj_from_logL, _periodObjVector);
+            _result->status = kInferSolved;
         } else {
-            cerr << fmt::format("ERROR: purity_corrected {} not in (0,1] or ploidy_corrected {} not in [{}, {}].\n",
-                                _period_obj_from_logL.purity_corrected,
-                                _period_obj_from_logL.ploidy_corrected,
-                                MIN_PLOIDY,
-                                MAX_PLOIDY);
+            string status_msg = fmt::format("purity_corrected {} not in (0,1] or ploidy_corrected {} not in [{}, {}].",
+                                            _period_obj_from_logL.purity_corrected,
+                                            _period_obj_from_logL.ploidy_corrected,
+                                            MIN_PLOIDY,
+                                            MAX_PLOIDY);
+            _log << "ERROR: " << status_msg << "\n";
+            _result->status = kInferNoSolution;
+            _result->message = status_msg;
         }
         if (_debug > 0) {
             output_snp_maf_by_peak(_period_obj_from_logL.peak_obj_vector);
@@ -236,22 +877,25 @@ int Infer::run()
             output_peak_bounds(_period_obj_from_logL.peak_obj_vector);
         }
     } else {
-        cerr << fmt::format("ERROR: logL {}<=0 or best_purity {} <=0!\n",
-                            _period_obj_from_logL.logL,
-                            _period_obj_from_logL.best_purity);
+        string status_msg = fmt::format("logL {}<=0 or best_purity {} <=0!",
+                                        _period_obj_from_logL.logL,
+                                        _period_obj_from_logL.best_purity);
+        _log << "ERROR: " << status_msg << "\n";
+        _result->status = kInferNoSolution;
+        _result->message = status_msg;
         return 0;
     }
 
     if (_debug > 2) {
+        RunProfile::ScopedPhase phase(_profile, "subclone_peaks");
         // below is about subclone peaks
-        _sub_outf.open(fmt::format("{}/sub.tsv", _output_dir).c_str());
-        _sub_outf << "period_int" << "\t" <<
-                  "pool_hist_smooth[_half_period_int + period_int]"
-                  << endl;
+        RowWriter sub_writer;
+        sub_writer.open(fmt::format("{}/sub.tsv", _output_dir));
+        sub_writer.write("period_int\tpool_hist_smooth[_half_period_int + period_int]\n");
 
-        _sub_peak_outf.open(fmt::format("{}/sub_peaks.final.tsv", _output_dir).c_str());
-        _sub_peak_outf << "(_opt_purity / best_period * abs(called_peaks[i]))"
-                       << endl;
+        RowWriter sub_peak_writer;
+        sub_peak_writer.open(fmt::format("{}/sub_peaks.final.tsv", _output_dir));
+        sub_peak_writer.write("(_opt_purity / best_period * abs(called_peaks[i]))\n");
 
         _half_period_int = _period_obj_from_logL.period_int / 2;
         for (int peak = _first_peak_obj.peak_center_int;
@@ -274,8 +918,8 @@ int Infer::run()
 
         for (int candidate_period_int = -_half_period_int;
              candidate_period_int <= 30; candidate_period_int++) {
-            _sub_outf << candidate_period_int << "\t" << pool_hist_smooth
-            [_half_period_int + candidate_period_int] << endl;
+            sub_writer.write("{}\t{:g}\n", candidate_period_int,
+                             pool_hist_smooth[_half_period_int + candidate_period_int]);
         }
 
         vector<double> called_peaks =
@@ -283,14 +927,13 @@ int Infer::run()
 
         for (unsigned int i = 0; i < called_peaks.size(); i++) {
             if (i % 7 == 0)
-                _sub_peak_outf << (_period_obj_from_logL.best_purity /
-                                   _period_obj_from_logL.period_int *
-                                   abs(called_peaks[i])) << "\t";
+                sub_peak_writer.write("{:g}\t", _period_obj_from_logL.best_purity /
+                                                 _period_obj_from_logL.period_int * abs(called_peaks[i]));
             // _sub_peak_outf<<called_peaks[i]<<" ";
-            if (i % 7 == 6) _sub_peak_outf << endl;
+            if (i % 7 == 6) sub_peak_writer.write("\n");
         }
-        _sub_outf.close();
-        _sub_peak_outf.close();
+        sub_writer.close();
+        sub_peak_writer.close();
     }
     return _returnCode;
 }
@@ -303,7 +946,7 @@ void Infer::calculate_autocor()
     /*** correlation is calculated using the largest MAX_NUM_OF_COR_TO_SUM
      * number
      * of summands.  ***/
-    cerr << "Calculating auto correlation ...";
+    _log << "Calculating auto correlation ...";
     double cor_raw_array[kPeriodMax + 1];
     for (int shift = 0; shift <= kPeriodMax; shift++) {
         double sum_cor = 0;
@@ -350,16 +993,16 @@ void Infer::calculate_autocor()
             (cor_raw_array[kPeriodMax - 2] + cor_raw_array[kPeriodMax - 1] +
              cor_raw_array[kPeriodMax]) /
             3.0;
-    cerr << "Done.\n";
+    _log << "Done.\n";
 }
 
 void Infer::calc_autocor_shift_diff(double* all_diff, double &left_x, double &right_x) {
-    cerr << "Calculating auto correlation shift-1 difference ..." << endl;
+    _log << "Calculating auto correlation shift-1 difference ..." << endl;
     double shift_diff;
-    string tmp_file_path = _output_dir + "/GADA.in.tsv";
-    ofstream gada_input_file;
-    gada_input_file.open(tmp_file_path.c_str(), ios::trunc);
-    gada_input_file << "period" << "\t" << "cor_shift_diff" << "\t" << "round_int" << endl;
+    RowWriter gada_input_writer;
+    if (_write_artifacts)
+        gada_input_writer.open(_output_dir + "/GADA.in.tsv");
+    gada_input_writer.write("period\tcor_shift_diff\tround_int\n");
 
     // add the GSL library to estimate shift_diff_min;
     double scale_cor;
@@ -376,13 +1019,7 @@ void Infer::calc_autocor_shift_diff(double* all_diff, double &left_x, double &ri
             shift_diff = (log10(_cor_array[i + 1]) / scale_cor) - (log10(_cor_array[i]) / scale_cor);
         }
         all_diff[i] = shift_diff;
-        if (shift_diff > 0) {
-            gada_input_file << i << "\t" << shift_diff
-                            << "\t" << 1 << endl;
-        } else {
-            gada_input_file << i << "\t" << shift_diff
-                            << "\t" << -1 << endl;
-        }
+        gada_input_writer.write("{}\t{:g}\t{}\n", i, shift_diff, shift_diff > 0 ? 1 : -1);
 
     }
 
@@ -397,18 +1034,18 @@ void Infer::calc_autocor_shift_diff(double* all_diff, double &left_x, double &ri
     left_x = gsl_cdf_gaussian_Pinv(0.4, sigma) + mean;
     right_x = gsl_cdf_gaussian_Qinv(0.4, sigma) + mean;
     string status_msg = fmt::format("#mean is: {}, sigma is: {}\n", mean, sigma);
-    cerr << status_msg;
-    gada_input_file << status_msg;
+    _log << status_msg;
+    gada_input_writer.write("{}", status_msg);
     status_msg = fmt::format("#shift_diff exclusion zone is : {} {}\n", left_x, right_x);
-    gada_input_file << status_msg;
-    gada_input_file.close();
-    cerr << "Done.\n";
+    gada_input_writer.write("{}", status_msg);
+    gada_input_writer.close();
+    _log << "Done.\n";
 }
 vector<OnePeriod> Infer:: infer_candidate_period_by_GADA(double* all_diff, double left_x, double right_x, int run_type)
 {
     //run_type 1: require positive and negative slope distinction + normal distribution threshold
     //run_type 2: only normal distribution threshold
-    cerr << fmt::format("Inferring candidate periods through GADA, run_type={}, left_x={}, right_x={} ...\n",
+    _log << fmt::format("Inferring candidate periods through GADA, run_type={}, left_x={}, right_x={} ...\n",
                         run_type, left_x, right_x);
     vector<int> period_int_vec;
     vector<double> _cor_array_shift_one_vec;
@@ -433,79 +1070,47 @@ vector<OnePeriod> Infer:: infer_candidate_period_by_GADA(double* all_diff, doubl
         }
 
     }
-    cerr << fmt::format("Initiating GADA instance ...");
-    //initiate a GADA instance
-    long M=_cor_array_shift_one_vec.size();    // no of data points in *input_array
-    double *input_array=(double *)calloc(M, sizeof(double));
-    for (int i=0; i<M; i++){
-        input_array[i] = _cor_array_shift_one_vec[i];
-    }
-
-    double sigma2=-1;  //variance observed, if negative value, it will be estimated by the mean of the differences
-    // I would recommend to be estimated on all the chromosomes and as a trimmed mean
-    double BaseAmp=0.0;
-    double a=0.5; //SBL hyper prior parameter
-    double T=5.0; //backward elimination threshold
-    long MinSegLen=10; // minimal length of a segment
-    long debug=0;// verbosity ... set equal to 1 to see messages of SBLandBE(). 0 to not see them
-    double convergenceDelta=1E-8;//1E-10 or 1E-8 seems to work well for this parameter. -- => ++ conv time
-    //1E8 better than 1E10 seems to work well for this parameter. -- => -- conv time
-    long maxNoOfInterations=50000; // 10000 id enough usually
-    double convergenceMaxAlpha=1E8; // 1E8 maximum number of iterations to reach convergence ...
-    double convergenceB=1E-20; //a number related to convergence = 1E-20
-    int reportIntervalDuringBE=100000; // how often to report progress during backward elimination, default is 100k
-
-    BaseGADA baseGADA = BaseGADA(
-            input_array,
-            M,
-            sigma2,
-            BaseAmp,
-            a,
-            T,
-            MinSegLen,
-            debug,
-            convergenceDelta,
-            maxNoOfInterations,
-            convergenceMaxAlpha,
-            convergenceB,
-            reportIntervalDuringBE);
-    baseGADA.SBLandBE();
-    baseGADA.IextToSegLen();
-    baseGADA.IextWextToSegAmp();
-    cerr << fmt::format("GADA done\n");
+    _log << fmt::format("Initiating GADA instance ...");
+    GADAOptions gada_options;
+    gada_options.MinSegLen = 10; // minimal length of a segment
+    gada_options.segmentationEngine = _segmentation_engine;
+    GADAWorkspace gada_workspace;
+    GADAResult gada_result;
+    segmentGADA(_cor_array_shift_one_vec.data(), _cor_array_shift_one_vec.size(), gada_options,
+                gada_workspace, gada_result);
+    _log << fmt::format("GADA done\n");
+    _profile.addCount("period_detection_em_iterations", gada_result.numEMsteps);
+    _profile.addCount("period_detection_be_removals", gada_result.noOfBreakpointsAfterSBL - gada_result.K);
 
     if (_debug>0) {
         //output the result
-        ofstream _gada_seg_outf;
-        _gada_seg_outf.open(fmt::format("{}/GADA.out.tsv", _output_dir).c_str(), ios::trunc);
-        _gada_seg_outf << "Start" << "\t" << "End" << "\t" << "Length" << "\t" << "Ampl" << endl;
-        for (int i = 0; i < baseGADA.K + 1; i++) {
-            int period_start = period_int_vec[baseGADA.Iext[i]];
-            int period_end = period_int_vec[baseGADA.Iext[i + 1] - 1];
-            _gada_seg_outf << period_start << "\t"
-                           << period_end << "\t"
-                           << baseGADA.SegLen[i] << "\t"
-                           << baseGADA.SegAmp[i] << endl;
+        RowWriter gada_seg_writer;
+        gada_seg_writer.open(fmt::format("{}/GADA.out.tsv", _output_dir));
+        gada_seg_writer.write("Start\tEnd\tLength\tAmpl\n");
+        for (int i = 0; i < gada_result.K + 1; i++) {
+            int period_start = period_int_vec[gada_result.Iext[i]];
+            int period_end = period_int_vec[gada_result.Iext[i + 1] - 1];
+            gada_seg_writer.write("{}\t{}\t{}\t{:g}\n", period_start, period_end, gada_result.SegLen[i],
+                                  gada_result.SegAmp[i]);
         }
-        _gada_seg_outf.close();
+        gada_seg_writer.close();
     }
 
     //select the candidate period
     vector<OnePeriod> candidate_period_vec;
     int min_period_segment_len = 10;
     int max_period_int = 600;
-    for (int i = 0; i < baseGADA.K ; i++) {
-        double delta = baseGADA.SegAmp[i] - baseGADA.SegAmp[i + 1];
-        long current_segment_len = baseGADA.SegLen[i];
-        long next_segment_len = baseGADA.SegLen[i];
-        if (baseGADA.SegAmp[i] > 0 && baseGADA.SegAmp[i + 1] < 0 &&
+    for (int i = 0; i < gada_result.K ; i++) {
+        long current_segment_len = gada_result.SegLen[i];
+        long next_segment_len = gada_result.SegLen[i];
+        if (gada_result.SegAmp[i] > 0 && gada_result.SegAmp[i + 1] < 0 &&
             current_segment_len>=min_period_segment_len && next_segment_len >=min_period_segment_len) {
             //find the period with highest auto-correlation between positive and negative slopes
             double max_auto_cor = -1;
             int candidate_period_int = -1;
             if (run_type==1) {
-                for (int period_int_tmp = period_int_vec[baseGADA.Iext[i + 1] - 1];
-                     period_int_tmp < min(max_period_int, period_int_vec[baseGADA.Iext[i + 1]]);
+                for (int period_int_tmp = period_int_vec[gada_result.Iext[i + 1] - 1];
+                     period_int_tmp < min(max_period_int, period_int_vec[gada_result.Iext[i + 1]]);
                      period_int_tmp++) {
                     double auto_cor_tmp = _cor_array[period_int_tmp];
                     if (auto_cor_tmp > max_auto_cor) {
@@ -514,7 +1119,7 @@ vector<OnePeriod> Infer:: infer_candidate_period_by_GADA(double* all_diff, doubl
                     }
                 }
             } else {
-                candidate_period_int = (period_int_vec[baseGADA.Iext[i + 1] - 1] + period_int_vec[baseGADA.Iext[i + 1]])/2;
+                candidate_period_int = (period_int_vec[gada_result.Iext[i + 1] - 1] + period_int_vec[gada_result.Iext[i + 1]])/2;
             }
             //lowe_bound and upper_bound are same. no more refining. THIS is the period.
             if (candidate_period_int>0 && candidate_period_int<=max_period_int) {
@@ -543,15 +1148,13 @@ vector<OnePeriod> Infer:: infer_candidate_period_by_GADA(double* all_diff, doubl
         candidate_period_top_two = candidate_period_vec;
     }
 
-    //free input_array?
-    //free(input_array);
-    cerr << fmt::format("Found {} candidate periods.\n", candidate_period_vec.size());
+    _log << fmt::format("Found {} candidate periods.\n", candidate_period_vec.size());
     return candidate_period_top_two;
 }
 
 int Infer::infer_candidate_period_by_autocor(OnePeriod &period_obj)
 {
-    cerr << "Inferring best period from auto-correlation data ..." << endl;
+    _log << "Inferring best period from auto-correlation data ..." << endl;
     // find the best period
     // ppe_v6 consider the following cases:
     // 	1) a subset of cases with Whole Genome Duplications
@@ -666,7 +1269,7 @@ int Infer::infer_candidate_period_by_autocor(OnePeriod &period_obj)
                 dmax_idx = autocor_hist_peak_pos_vector[i];
                 double peak_cor = _cor_array[dmax_idx];
                 thre = DEV1 * peak_cor;
-                cerr << dmax_idx << "\t" << peak_cor << "\t" << thre NewLineMACRO;
+                _log << dmax_idx << "\t" << peak_cor << "\t" << thre NewLineMACRO;
                 period_min = dmax_idx - 1;
                 for (; period_min > kPeriodMin &&
                        (_cor_array[period_min] > thre ||
@@ -687,7 +1290,7 @@ int Infer::infer_candidate_period_by_autocor(OnePeriod &period_obj)
     period_obj.period_int = dmax_idx;
     period_obj.lower_bound_int = period_min;
     period_obj.upper_bound_int = period_max;
-    cerr << "best period from autocorrelation: " << "\t" << dmax_idx << "\t" <<
+    _log << "best period from autocorrelation: " << "\t" << dmax_idx << "\t" <<
          "lower bound: " << "\t" << period_min << "\t" <<
          "upper bound: " << "\t" << period_max NewLineMACRO;
     return 0;
@@ -697,10 +1300,10 @@ OnePeak Infer::find_first_peak_ab_init(int candidate_period_int)
 {
     OnePeak first_peak_obj = find_first_peak_given_bounds(
             candidate_period_int, kFirstPeakMin, kFirstPeakMax + kPeakHalfWidthMax);
-    cerr << " Find_first_peak_ab_init() for period: " << candidate_period_int << endl
+    _log << " Find_first_peak_ab_init() for period: " << candidate_period_int << endl
          << "  first peak: " << first_peak_obj.peak_center_int << endl;
-    cerr << "  lower bound: " << first_peak_obj.lower_bound_int << endl;
-    cerr << "  upper bound: " << first_peak_obj.upper_bound_int << endl;
+    _log << "  lower bound: " << first_peak_obj.lower_bound_int << endl;
+    _log << "  upper bound: " << first_peak_obj.upper_bound_int << endl;
     return first_peak_obj;
 }
 
@@ -716,7 +1319,7 @@ OnePeak Infer::find_first_peak_given_bounds(int candidate_period_int,
     ***/
     if (_debug > 0)
     {
-        cerr << "Finding first peak, period_int: "
+        _log << "Finding first peak, period_int: "
              << candidate_period_int << ", within bounds of ("
              << first_peak_lower_bound_int << "-" << first_peak_upper_bound_int
              << ")... " << endl;
@@ -789,7 +1392,7 @@ OnePeak Infer::find_first_peak_given_bounds(int candidate_period_int,
             first_peak_obj.peak_center_int + candidate_peak_half_width;
     if (_debug > 0)
     {
-        cerr << "  best_first_peak center: " << best_first_peak << endl
+        _log << "  best_first_peak center: " << best_first_peak << endl
              << "  sum of window count at all periodic peaks: "
              << all_sum[best_first_peak] << endl
              << "  half_width_int: " << candidate_peak_half_width << endl;
@@ -888,7 +1491,7 @@ vector<OnePeak> Infer::find_peaks(OnePeriod &period_obj,
     }
 
     if (_debug>0){
-        cerr << fmt::format("Found {} peaks.\n", peak_obj_vector.size());
+        _log << fmt::format("Found {} peaks.\n", peak_obj_vector.size());
     }
     return peak_obj_vector;
 }
@@ -896,17 +1499,16 @@ vector<OnePeak> Infer::find_peaks(OnePeriod &period_obj,
 int Infer::output_peak_bounds(vector<OnePeak> &peak_obj_vector)
 {
     string tmp_file_path = _output_dir + "/peak_bounds.tsv";
-    cerr << fmt::format("Outputting peak bounds to {} ... ", tmp_file_path);
-    ofstream peak_bounds_outf;
-    peak_bounds_outf.open(tmp_file_path.c_str());
-    peak_bounds_outf << "lowerBound\tupperBound\n";
+    _log << fmt::format("Outputting peak bounds to {} ... ", tmp_file_path);
+    RowWriter peak_bounds_writer;
+    peak_bounds_writer.open(tmp_file_path);
+    peak_bounds_writer.write("lowerBound\tupperBound\n");
     vector<OnePeak>::iterator it = peak_obj_vector.begin();
     int counter = 0;
     for (; it != peak_obj_vector.end(); it++)
     {
         counter++;
-        peak_bounds_outf << fmt::format("{}\t{}\n", it->lower_bound_int / FRESOLUTION,
-                                        it->upper_bound_int / FRESOLUTION);
+        peak_bounds_writer.write("{}\t{}\n", it->lower_bound_int / FRESOLUTION, it->upper_bound_int / FRESOLUTION);
     }
     /*
     // cerr<<"no_of_snps_in_peak "<<no_of_snps_in_peak<<"\n";
@@ -921,14 +1523,14 @@ int Infer::output_peak_bounds(vector<OnePeak> &peak_obj_vector)
       snp_plot.close();
     }
     */
-    peak_bounds_outf.close();
-    cerr << fmt::format(" {} peaks.\n", counter);
+    peak_bounds_writer.close();
+    _log << fmt::format(" {} peaks.\n", counter);
     return 0;
 }
 
 OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_vec)
 {
-    cerr << fmt::format("Inferring the best period by log likelihood from {} candidates ... \n",
+    _log << fmt::format("Inferring the best period by log likelihood from {} candidates ... \n",
                         candidate_period_vec.size());
     double best_period_logL = (-1e99);
     OnePeriod best_period_obj = OnePeriod();
@@ -936,11 +1538,12 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
          candidate_period_index<candidate_period_vec.size();
          candidate_period_index++)
     {
+        RunProfile::ScopedPhase phase(_profile, "candidate_logL");
         OnePeriod &candidate_period = candidate_period_vec[candidate_period_index];
         int candidate_period_int = candidate_period.period_int;
 
         string status_msg = fmt::format("### candidate period_int: {}\n", candidate_period_int);
-        cerr << status_msg;
+        _log << status_msg;
         _infer_details_outf << status_msg;
         candidate_period.first_peak_obj = find_first_peak_ab_init(candidate_period_int);
         candidate_period.first_peak_int = candidate_period.first_peak_obj.peak_center_int;
@@ -960,16 +1563,9 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
         // for each period, sum likelihood of all peaks (segments and snps)
         candidate_period.ResetCounters();
         double sum_adj_logL = 0;
-        if (_debug > 0)
-        {
-            _rc_logL_outf << "period_int" << "\t"
-                          << candidate_period_int << "\t"
-                          << "half-width" << "\t"
-                          << candidate_period.period_int - candidate_period.lower_bound_int << endl;
-            _rc_logL_outf << "peak_index" << "\t" << "peak_center_float" << "\t"
-                          << "logL_peak" << "\t" << "candidate_period.logL"
-                          << endl;
-        }
+        if (_tracer.active())
+            _tracer.record(kTraceRCLogLPeriod, candidate_period_int,
+                           candidate_period.period_int - candidate_period.lower_bound_int);
         //set no_of_peaks_for_logL for this period
         candidate_period.no_of_peaks_for_logL = min(_no_of_peaks_for_logL, int(candidate_period.peak_obj_vector.size()));
         for (unsigned int peak_index = 0;
@@ -984,12 +1580,8 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
                     peak_center_float, peak_obj, candidate_period, adj_logL);
             candidate_period.logL += logL_peak;
             sum_adj_logL += adj_logL;
-            if (_debug > 0)
-            {
-                _rc_logL_outf << peak_index << "\t" << peak_center_float << "\t"
-                              << logL_peak << "\t"
-                              << candidate_period.logL << endl;
-            }
+            if (_tracer.active())
+                _tracer.record(kTraceRCLogLPeak, peak_index, peak_center_float, logL_peak, candidate_period.logL);
         }
         if (candidate_period.no_of_windows <= 0) continue;
         // float
@@ -1012,11 +1604,11 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
         //20171229 take average
         candidate_period.logL = candidate_period.logL/candidate_period.no_of_peaks_for_logL;
         if (_debug>0) {
-            cerr << fmt::format(" best_logL_snp: {}\n", candidate_period.best_logL_snp);
-            cerr << fmt::format(" no_of_peaks_for_logL: {}\n", candidate_period.no_of_peaks_for_logL);
-            cerr << fmt::format(" purity: {}\n", candidate_period.best_purity);
-            cerr << fmt::format(" ploidy: {}\n", candidate_period.best_ploidy);
-            cerr << fmt::format(" logL: {}\n", candidate_period.logL);
+            _log << fmt::format(" best_logL_snp: {}\n", candidate_period.best_logL_snp);
+            _log << fmt::format(" no_of_peaks_for_logL: {}\n", candidate_period.no_of_peaks_for_logL);
+            _log << fmt::format(" purity: {}\n", candidate_period.best_purity);
+            _log << fmt::format(" ploidy: {}\n", candidate_period.best_ploidy);
+            _log << fmt::format(" logL: {}\n", candidate_period.logL);
         }
         if (candidate_period.best_purity>0 && candidate_period.logL > best_period_logL){
             best_period_logL = candidate_period.logL;
@@ -1025,7 +1617,7 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
         }
         _periodObjVector.push_back(candidate_period);
     }
-    cerr << fmt::format("### Best period from likelihood: {}\n", best_period_obj.period_int)
+    _log << fmt::format("### Best period from likelihood: {}\n", best_period_obj.period_int)
          << "  best_purity: " << best_period_obj.best_purity << endl
          << "  best_ploidy: " << best_period_obj.best_ploidy << endl
          << "  Q: " << best_period_obj.rc_ratio_int_of_cp_2 << endl
@@ -1038,7 +1630,7 @@ OnePeriod Infer::infer_best_period_by_logL(vector<OnePeriod> &candidate_period_v
 int Infer::output_logL(OnePeriod &best_period_obj,
                        vector<OnePeriod> &period_obj_vector)
 {
-    cerr << "Outputting logL ...";
+    _log << "Outputting logL ...";
     int best_period_int = best_period_obj.period_int;
     double best_period_logL = best_period_obj.logL;
 
@@ -1148,17 +1740,17 @@ int Infer::output_logL(OnePeriod &best_period_obj,
                     << endl;
         }
     }
-    cerr << "Done." << endl;
+    _log << "Done." << endl;
     return 0;
 }
 
 double Infer::getReadDepthFromRegCoeffFile(string inputFname)
 {
-    cerr << "Reading depth from " << inputFname << " ...";
+    _log << "Reading depth from " << inputFname << " ...";
     double depth;
     if (!isfile(inputFname)){
-        cerr << inputFname << " does not exist. ERROR!" << endl;
-        exit(3);
+        _log << inputFname << " does not exist. ERROR!" << endl;
+        return -1;
     }
     ifstream reg_inf(inputFname.c_str());
     string line;
@@ -1167,7 +1759,7 @@ double Infer::getReadDepthFromRegCoeffFile(string inputFname)
     reg_inf >> depth;
     reg_inf.close();
     depth = (depth * 100 / _config.window);
-    cerr << "Depth=" << depth << endl;
+    _log << "Depth=" << depth << endl;
     return depth;
 }
 
@@ -1185,13 +1777,13 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
     OnePeak &tallest_peak = peak_obj_vector[0];
 
     if (_debug>0) {
-        cerr << fmt::format("  Tallest peak index={}, peak_center_int={}, no_of_windows={}.\n",
+        _log << fmt::format("  Tallest peak index={}, peak_center_int={}, no_of_windows={}.\n",
                             tallest_peak.peak_index, tallest_peak.peak_center_int,
                             tallest_peak.no_of_windows);
 
     }
     if (tallest_peak.peak_index>2){
-        cerr << fmt::format("  WARNING: return now as tallest_peak.peak_index {} is bigger than 2. Not correct.\n",
+        _log << fmt::format("  WARNING: return now as tallest_peak.peak_index {} is bigger than 2. Not correct.\n",
                             tallest_peak.peak_index);
         //something wrong
         //The tallest peak's copy number is more than 2 due to the order of peaks.
@@ -1201,7 +1793,7 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
     //sort the peak_obj_vector back to its original order by peak_center_int
     sort(peak_obj_vector.begin(), peak_obj_vector.end());
     if (_debug>0) {
-        cerr << fmt::format("  First peak's peak_index={}, peak_center_int={}, no_of_windows={}.\n",
+        _log << fmt::format("  First peak's peak_index={}, peak_center_int={}, no_of_windows={}.\n",
                             peak_obj_vector[0].peak_index, peak_obj_vector[0].peak_center_int,
                             peak_obj_vector[0].no_of_windows);
     }
@@ -1215,7 +1807,7 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
         max_no_of_copy_nos_bf_1st_peak = no_of_copy_nos_bf_1st_peak_prior;
     }
     if (_debug>0) {
-        cerr << fmt::format("  no_of_copy_nos_bf_1st_peak_prior={}\n  max_no_of_copy_nos_bf_1st_peak={}\n",
+        _log << fmt::format("  no_of_copy_nos_bf_1st_peak_prior={}\n  max_no_of_copy_nos_bf_1st_peak={}\n",
                             no_of_copy_nos_bf_1st_peak_prior, max_no_of_copy_nos_bf_1st_peak);
     }
     OneSegmentSNPs oneSegmentSNPs;
@@ -1264,24 +1856,11 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
                 double maf_exp_adjusted = adjust_maf_expect(maf_expected, peak_obj.snp_coverage_mean,
                                                             peak_obj.snp_coverage_mean*_snp_coverage_var_vs_mean_ratio);
                 maf_expected_vector.push_back(maf_exp_adjusted);
-                if (_debug > 0)
-                {
-                    _snp_maf_exp_vs_adj_outf
-                            << period_int << "\t"
-                            << no_of_copy_nos_bf_1st_peak << "\t"
-                            << peak_index << "\t"
-                            << cp << "\t"
-                            << major_allele_cp << "\t"
-                            << first_peak_int << "\t"
-                            << purity << "\t"
-                            << ploidy << "\t"
-                            << maf_expected << "\t"
-                            << peak_obj.snp_coverage_mean << "\t"
-                            << peak_obj.snp_coverage_var << "\t"
-                            << peak_obj.no_of_snps << "\t"
-                            << pow(10, maf_exp_adjusted)
-                            << endl;
-                }
+                if (_tracer.active())
+                    _tracer.record(kTraceSNPMafExpVsAdj, period_int, no_of_copy_nos_bf_1st_peak, peak_index, cp,
+                                   major_allele_cp, first_peak_int, purity, ploidy, maf_expected,
+                                   peak_obj.snp_coverage_mean, peak_obj.snp_coverage_var, peak_obj.no_of_snps,
+                                   pow(10, maf_exp_adjusted));
             }  // all snp maf peaks
 
             // double std_h0 = sqrt(0.5 / 3 /
@@ -1367,27 +1946,12 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
                 //		float
                 // snp_logL_penalty=-0.5*num_of_freq_peak*log(peak_obj.no_of_snps*1.0);
                 //		logL_snp+=snp_logL_penalty;
-                if (_debug)
-                {
-                    _snp_logL_outf << period_int << "\t"
-                                   << no_of_copy_nos_bf_1st_peak << "\t"
-                                   << peak_index << "\t"
-                                   << peak_obj.no_of_maf_peaks << "\t"
-                                   << i << "\t"
-                                   << seg_count_per_maf_peak[i] << "\t"
-                                   << var_of_maf_per_maf_peak[i] << "\t"
-                                   << sq_diff_per_maf_peak[i] << "\t"
-                                   << no_of_snps_per_maf_peak[i] << "\t"
-                                   << std_per_maf_peak[i] << "\t"
-                                   << lod_snp << "\t"
-                                   << logL_snp << "\t"
-                                   << logL_of_one_maf_peak << "\t"
-                                   << ssum_sq_diff << "\t"
-                                   << peak_obj.snp_maf_var << "\t"
-                                   << peak_obj.no_of_snps << "\t"
-                                   << candidate_period.no_of_maf_peaks
-                                   << endl;  // add on 2016-12-19
-                }
+                if (_tracer.active())
+                    _tracer.record(kTraceSNPLogL, period_int, no_of_copy_nos_bf_1st_peak, peak_index,
+                                   peak_obj.no_of_maf_peaks, i, seg_count_per_maf_peak[i],
+                                   var_of_maf_per_maf_peak[i], sq_diff_per_maf_peak[i], no_of_snps_per_maf_peak[i],
+                                   std_per_maf_peak[i], lod_snp, logL_snp, logL_of_one_maf_peak, ssum_sq_diff,
+                                   peak_obj.snp_maf_var, peak_obj.no_of_snps, candidate_period.no_of_maf_peaks);
             }  // all maf peaks of one rc_peak
             if (peak_obj.no_of_snps <= 5 || peak_obj.snp_maf_var<=0) continue;
             candidate_period.no_of_snps += peak_obj.no_of_snps;
@@ -1398,27 +1962,9 @@ double Infer::infer_no_of_copy_nos_bf_1st_peak_for_one_period_by_logL_snp(
                     log(peak_obj.no_of_maf_peaks * 2 * sqrt(12.0)) *
                     peak_obj.no_of_snps;
             lod_snp += lod_of_one_rc_peak;
-            if (_debug)
-            {
-                _snp_logL_outf << period_int << "\t"
-                               << no_of_copy_nos_bf_1st_peak << "\t"
-                               << peak_index << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << -1 << "\t"
-                               << lod_snp << "\t"
-                               << logL_snp << "\t"
-                               << -1 << "\t"
-                               << ssum_sq_diff << "\t"
-                               << peak_obj.snp_maf_var << "\t"
-                               << peak_obj.no_of_snps << "\t"
-                               << -1
-                               << endl;  // add on 2016-12-19
-            }
+            if (_tracer.active())
+                _tracer.record(kTraceSNPLogLOfRCPeak, period_int, no_of_copy_nos_bf_1st_peak, peak_index, lod_snp,
+                               logL_snp, ssum_sq_diff, peak_obj.snp_maf_var, peak_obj.no_of_snps);
 
         }  // each rc peak
         //     logL_snp = (-log(maf_stddev) * candidate_period.no_of_snps);
@@ -1481,7 +2027,6 @@ double Infer::calc_one_peak_logL_rc(float peak_center_float, OnePeak &peak_obj,
         {
             OneSegment oneSegment = *it;
             float rc_ratio = oneSegment.rc_ratio;
-            double stddev = oneSegment.stddev;
             int no_of_windows = oneSegment.no_of_windows;
             double sq_diff = (rc_ratio - peak_center_float) *
                              (rc_ratio - peak_center_float) * no_of_windows;
@@ -1532,7 +2077,10 @@ double Infer::adjust_maf_expect(double maf_expected,
   double maf_expected, double snp_coverage_mean , double
   snp_coverage_var
     */
+    AdjustedMafCache::Key cache_key(maf_expected, snp_coverage_mean, snp_coverage_var, _snp_coverage_min);
     double freq = 0;
+    if (_maf_cache && _maf_cache->find(cache_key, freq))
+        return freq;
     double pdf = 0;
     double cdf = 0;
     double neg_bi_p, neg_bi_r;
@@ -1555,17 +2103,52 @@ double Infer::adjust_maf_expect(double maf_expected,
         }
     }
     freq /= cdf;
+    if (_maf_cache)
+        _maf_cache->insert(cache_key, freq);
     return freq;
 }
 
-int Infer::getSNPDataFromFile(string input_file_path)
+//2026.10.18 whole-field numbers for the file readers, which report bad input instead of throwing like stoi()
+static bool parse_int(const string &field, int &value)
+{
+    char *end = NULL;
+    errno = 0;
+    long parsed = strtol(field.c_str(), &end, 10);
+    if (field.empty() || *end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX)
+        return false;
+    value = (int) parsed;
+    return true;
+}
+
+static bool parse_float(const string &field, float &value)
+{
+    char *end = NULL;
+    errno = 0;
+    double parsed = strtod(field.c_str(), &end);
+    if (field.empty() || *end != '\0' || errno == ERANGE)
+        return false;
+    value = (float) parsed;
+    return true;
+}
+
+static bool parse_double(const string &field, double &value)
+{
+    char *end = NULL;
+    errno = 0;
+    double parsed = strtod(field.c_str(), &end);
+    if (field.empty() || *end != '\0' || errno == ERANGE)
+        return false;
+    value = parsed;
+    return true;
+}
+
+int Infer::getSNPDataFromFile(string input_file_path, vector<SNPRecord> *snp_record_vec)
 {
     /*** read in SNP data from inputFname and store data in 3-d array _SNPs
      * ***/
-    cerr << "Reading SNPs from " << input_file_path << " ..." << endl;
+    _log << "Reading SNPs from " << input_file_path << " ..." << endl;
     if (!isfile(input_file_path)){
-        cerr << input_file_path << " does not exist. ERROR!" << endl;
-        exit(3);
+        return setError(fmt::format("{} does not exist.", input_file_path));
     }
     ifstream input_file;
     input_file.open(input_file_path.c_str(), std::ios::in | std::ios::binary);
@@ -1575,103 +2158,369 @@ int Infer::getSNPDataFromFile(string input_file_path)
     std::istream input_stream(&input_filter_stream_buffer);
 
     string line, chr_string;
-    int loc, chr_index, coverage;
-    float maf;
     _total_no_of_snps = 0;
     int noOfLines = 0;
 
-    std::getline(input_stream, line);
-    while (!line.empty())
+    //a corrupt gzip stream sets badbit, a failed allocation throws
+    try
     {
-        noOfLines++;
-        std::vector<std::string> element_vec = string_split(line, "\t");
-        chr_string = element_vec[0];
         std::getline(input_stream, line);
-        if (chr_string[0]=='#' || element_vec[1]=="pos") {
-            //ignore comments and header
-            continue;
-        } else if (chr_string[0] == 'c') {
-            chr_string = chr_string.substr(3);
-        }
-        chr_index = atoi(chr_string.c_str()) - 1;
-        if (chr_index == -1) {
-            continue;
+        while (!line.empty())
+        {
+            noOfLines++;
+            std::vector<std::string> element_vec = string_split(line, "\t");
+            std::getline(input_stream, line);
+            if (element_vec.empty())
+                return setError(fmt::format("{} line {}: expected chromosome, position, MAF and coverage.",
+                                            input_file_path, noOfLines));
+            chr_string = element_vec[0];
+            if (chr_string[0]=='#' || (element_vec.size() > 1 && element_vec[1]=="pos")) {
+                //ignore comments and header
+                continue;
+            }
+            SNPRecord snp_record = {chr_string, 0, 0, 0};
+            if (element_vec.size() < 4 || !parse_int(element_vec[1], snp_record.pos) ||
+                !parse_float(element_vec[2], snp_record.maf) || !parse_int(element_vec[3], snp_record.coverage))
+                return setError(fmt::format("{} line {}: expected chromosome, position, MAF and coverage.",
+                                            input_file_path, noOfLines));
+            addSNP(snp_record.chr_string, snp_record.pos, snp_record.maf, snp_record.coverage);
+            if (snp_record_vec)
+                snp_record_vec->push_back(snp_record);
         }
-        loc = stoi(element_vec[1]);
-        maf = stof(element_vec[2]);
-        coverage = stoi(element_vec[3]);
-        //20171227 take log10
-        OneSNP oneSNP(chr_index, loc, maf >= 0.5 ? log10(maf) : log10(1 - maf), coverage);
-        _SNPs[chr_index].push_back(oneSNP);
-        _total_no_of_snps++;
     }
+    catch (const std::exception &e)
+    {
+        return setError(fmt::format("could not read {}: {}", input_file_path, e.what()));
+    }
+    if (input_stream.bad())
+        return setError(fmt::format("{} is corrupt after line {}.", input_file_path, noOfLines));
     input_file.close();
-    cerr << _SNPs.size() << " chromosomes, " << _total_no_of_snps << " SNPs, "
+    for (ChrSNPStore &chr_snp_store : _SNPs)
+        chr_snp_store.finish();
+    _log << _SNPs.size() << " chromosomes, " << _total_no_of_snps << " SNPs, "
          << noOfLines << " lines." << endl;
+    _profile.setCount("snp_rows_parsed", noOfLines);
     return 0;
 }
 
-// read in the results from BIC-seq for the read count data
-int Infer::getSegmentDataFromFile(string input_file_path)
+//2026.10.18 SNPs handed over in memory
+int Infer::getSNPDataFromRecords(const SNPRecord *snps, size_t no_of_snps)
 {
-    /*** read in segmentation data from inputFname and store data in 3-d
-     * array
-     * _SNPs _rc_ratio_segments ***/
-    cerr << "Reading in segments from " << input_file_path << " ...\n";
-    if (!isfile(input_file_path)){
-        cerr << input_file_path << " does not exist. ERROR!" << endl;
-        exit(3);
+    _total_no_of_snps = 0;
+    for (size_t i = 0; i < no_of_snps; i++)
+        addSNP(snps[i].chr_string, snps[i].pos, snps[i].maf, snps[i].coverage);
+    for (ChrSNPStore &chr_snp_store : _SNPs)
+        chr_snp_store.finish();
+    _log << _total_no_of_snps << " SNPs taken from memory." << endl;
+    return 0;
+}
+
+void Infer::addSNP(string chr_string, int pos, float maf, int coverage)
+{
+    if (chr_string[0] == 'c') {
+        chr_string = chr_string.substr(3);
     }
-    ifstream input_file;
+    int chr_index = atoi(chr_string.c_str()) - 1;
+    if (chr_index < 0 || chr_index >= NUM_AUTO_CHR) {
+        return;
+    }
+    //20171227 take log10
+    _SNPs[chr_index].add(pos, maf >= 0.5 ? log10(maf) : log10(1 - maf), coverage);
+    _total_no_of_snps++;
+}
+
+//"chr2" before "chr10": runs of digits compare by value
+static bool natural_less(const string &a, const string &b)
+{
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (isdigit(a[i]) && isdigit(b[j]))
+        {
+            size_t i_end = i, j_end = j;
+            while (i_end < a.size() && isdigit(a[i_end])) i_end++;
+            while (j_end < b.size() && isdigit(b[j_end])) j_end++;
+            long a_number = atol(a.substr(i, i_end - i).c_str());
+            long b_number = atol(b.substr(j, j_end - j).c_str());
+            if (a_number != b_number) return a_number < b_number;
+            i = i_end;
+            j = j_end;
+        }
+        else
+        {
+            if (a[i] != b[j]) return a[i] < b[j];
+            i++;
+            j++;
+        }
+    }
+    return a.size() - i < b.size() - j;
+}
+
+//segment input: one file, a comma-separated list of files, or a directory (all its files, natural order).
+//Files of a list need not exist yet if must_exist is false (streaming). Returns false, with the reason in error_message, if there are none or, with must_exist, one is missing.
+static bool resolve_segment_input_paths(const string &input_path, bool must_exist, vector<string> &path_vec,
+                                        string &error_message)
+{
+    struct stat path_stat;
+    if (stat(input_path.c_str(), &path_stat) == 0 && S_ISDIR(path_stat.st_mode))
+    {
+        DIR *dir = opendir(input_path.c_str());
+        if (dir == NULL)
+        {
+            error_message = fmt::format("could not open segment directory {}.", input_path);
+            return false;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            string file_path = input_path + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && stat(file_path.c_str(), &path_stat) == 0 && S_ISREG(path_stat.st_mode))
+                path_vec.push_back(file_path);
+        }
+        closedir(dir);
+        std::sort(path_vec.begin(), path_vec.end(), natural_less);
+    }
+    else
+    {
+        for (const string &file_path : string_split(input_path, ","))
+            if (!file_path.empty()) path_vec.push_back(file_path);
+    }
+    if (path_vec.empty())
+    {
+        error_message = fmt::format("no segment files in {}.", input_path);
+        return false;
+    }
+    for (const string &file_path : path_vec)
+    {
+        if (must_exist && !isfile(file_path))
+        {
+            error_message = fmt::format("{} does not exist.", file_path);
+            return false;
+        }
+    }
+    return true;
+}
+
+//opens a gzipped or plain file (told apart by the gzip magic bytes) into input_filter_stream_buffer
+static bool open_maybe_gzipped(const string &input_file_path, ifstream &input_file,
+                               boost::iostreams::filtering_streambuf<boost::iostreams::input> &input_filter_stream_buffer)
+{
     input_file.open(input_file_path.c_str(), std::ios::in | std::ios::binary);
-    boost::iostreams::filtering_streambuf<boost::iostreams::input> input_filter_stream_buffer;
-    input_filter_stream_buffer.push(boost::iostreams::gzip_decompressor());
+    if (!input_file) return false;
+    bool is_gzipped = (input_file.get() == 0x1f && input_file.get() == 0x8b);
+    input_file.clear();
+    input_file.seekg(0);
+    if (is_gzipped) input_filter_stream_buffer.push(boost::iostreams::gzip_decompressor());
     input_filter_stream_buffer.push(input_file);
+    return true;
+}
+
+//ratio tracks (GADA input, the normalization output) end in .csv or .csv.gz, everything else is a segment file
+static bool is_ratio_track(const string &input_file_path)
+{
+    size_t csv_pos = input_file_path.rfind(".csv");
+    return csv_pos != string::npos &&
+           (csv_pos + 4 == input_file_path.size() || input_file_path.compare(csv_pos, string::npos, ".csv.gz") == 0);
+}
+
+//parses one segment file, gzipped or plain, into records. Comment lines are skipped. Returns false on a read
+// error or a malformed line, with the reason in error_msg.
+static bool read_segment_records(const string &input_file_path, vector<SegmentRecord> &record_vec,
+                                 string &error_msg)
+{
+    ifstream input_file;
+    boost::iostreams::filtering_streambuf<boost::iostreams::input> input_filter_stream_buffer;
+    if (!open_maybe_gzipped(input_file_path, input_file, input_filter_stream_buffer)) return false;
     std::istream input_stream(&input_filter_stream_buffer);
 
     string line;
-    int start, end, no_of_valid_windows;
-    float read_count_ratio;
-    double ratio_stddev;
-    string chr_string;
-    _total_no_of_segments = 0;
-    _total_no_of_segments_used = 0;
+    int line_no = 0;
+    std::getline(input_stream, line);
+    while (!line.empty())
+    {
+        line_no++;
+        std::vector<std::string> element_vec = string_split(line, "\t");
+        std::getline(input_stream, line);
+        //a line of only tabs splits into nothing
+        if (!element_vec.empty() && element_vec[0][0] == '#')
+        {
+            //ignore comments
+            continue;
+        }
+        SegmentRecord record;
+        if (element_vec.size() < 6 || !parse_int(element_vec[1], record.start) ||
+            !parse_int(element_vec[2], record.end) || !parse_float(element_vec[3], record.read_count_ratio) ||
+            !parse_float(element_vec[4], record.ratio_stddev) || !parse_int(element_vec[5], record.no_of_valid_windows))
+        {
+            error_msg = fmt::format("{} line {}: expected chromosome, start, end, ratio, stddev and no. of windows.",
+                                    input_file_path, line_no);
+            return false;
+        }
+        record.chr_string = element_vec[0];
+        record_vec.push_back(record);
+    }
+    //istream turns a decompression error into badbit
+    if (input_stream.bad())
+    {
+        error_msg = fmt::format("{} is corrupt after line {}.", input_file_path, line_no);
+        return false;
+    }
+    input_file.close();
+    return true;
+}
 
-    int **noOfWindowsByRatioAndChr;
-    noOfWindowsByRatioAndChr = new int *[MAX_RATIO_HIGH_RES + 1];
-    for (int i = 0; i <= MAX_RATIO_HIGH_RES; i++)
+//runs on reader threads, so messages go to status_msg for the caller to log
+bool Infer::readAndPrepareSegmentFile(const string &input_file_path, vector<SegmentRecord> &record_vec,
+                                      string &status_msg)
+{
+    if (is_ratio_track(input_file_path))
     {
-        noOfWindowsByRatioAndChr[i] = new int[NUM_AUTO_CHR];
-        for (int chr_index = 0; chr_index < NUM_AUTO_CHR; chr_index++)
-            noOfWindowsByRatioAndChr[i][chr_index] = 0;
+        if (!segmentRatioTrack(input_file_path, record_vec, status_msg))
+            return false;
+    }
+    else if (!read_segment_records(input_file_path, record_vec, status_msg))
+        return false;
+    if (_prepare_segments)
+        prepareSegmentRecords(record_vec);
+    return true;
+}
+
+//the reader threads call this: an exception escaping a thread would terminate the process
+bool Infer::readAndPrepareSegmentFileNoThrow(const string &input_file_path, vector<SegmentRecord> &record_vec,
+                                             string &status_msg)
+{
+    try
+    {
+        return readAndPrepareSegmentFile(input_file_path, record_vec, status_msg);
     }
-    int noOfLines = 0;
+    catch (const std::exception &e)
+    {
+        status_msg = e.what();
+        return false;
+    }
+}
+
+//2026.10.18 segments one ratio track in-process, as GADA -M _segment_min_len -T _segment_t_score --engine would,
+// and turns the segments into records with GADA's robust mean and stddev. Nothing goes through a file unless
+// _debug>0, which also writes the segments in GADA's format to _output_dir.
+bool Infer::segmentRatioTrack(const string &input_file_path, vector<SegmentRecord> &record_vec, string &status_msg)
+{
+    ifstream input_file;
+    boost::iostreams::filtering_streambuf<boost::iostreams::input> input_filter_stream_buffer;
+    if (!open_maybe_gzipped(input_file_path, input_file, input_filter_stream_buffer)) return false;
+    std::istream input_stream(&input_filter_stream_buffer);
+
+    //chromosome from the "#chr: chr1" line, otherwise the file name up to the first dot
+    string chr_string = input_file_path.substr(input_file_path.find_last_of('/') + 1);
+    chr_string = chr_string.substr(0, chr_string.find('.'));
+    vector<int> start_pos_vec;
+    vector<double> ratio_vec;
+    string line;
     std::getline(input_stream, line);
     while (!line.empty())
     {
-        noOfLines++;
-        std::vector<std::string> element_vec = string_split(line, "\t");
-
-        chr_string = element_vec[0];
+        if (line.compare(0, 5, "#chr:") == 0)
+        {
+            std::vector<std::string> element_vec = string_split(line.substr(5), " \t");
+            if (!element_vec.empty()) chr_string = element_vec[0];
+        }
+        else if (line[0] != '#' && line.compare(0, 5, "start") != 0)
+        {
+            std::vector<std::string> element_vec = string_split(line, ",");
+            if (element_vec.size() >= 2)
+            {
+                start_pos_vec.push_back(atol(element_vec[0].c_str()));
+                ratio_vec.push_back(atof(element_vec[1].c_str()));
+            }
+        }
         std::getline(input_stream, line);
+    }
+    input_file.close();
+    if (ratio_vec.empty())
+        return true;
+
+    GADAOptions gada_options;
+    gada_options.MinSegLen = _segment_min_len;
+    gada_options.T = _segment_t_score;
+    gada_options.segmentationEngine = _segmentation_engine;
+    GADAWorkspace gada_workspace;
+    GADAResult gada_result;
+    {
+        RunProfile::ScopedPhase phase(_profile, "ratio_track_segmentation");  // summed over reader threads
+        segmentGADA(ratio_vec.data(), (long) ratio_vec.size(), gada_options, gada_workspace, gada_result);
+    }
+    _profile.addCount("ratio_track_windows", ratio_vec.size());
+    _profile.addCount("ratio_track_em_iterations", gada_result.numEMsteps);
+    _profile.addCount("ratio_track_be_removals", gada_result.noOfBreakpointsAfterSBL - gada_result.K);
 
-        if (chr_string[0]=='#') {
-            //ignore comments
+    for (long i = 0; i < gada_result.K + 1; i++)
+    {
+        SegmentRecord record;
+        record.chr_string = chr_string;
+        record.start = start_pos_vec[gada_result.Iext[i]];
+        record.end = start_pos_vec[gada_result.Iext[i + 1] - 1];
+        calculate_robust_mean_stddev(ratio_vec.data(), gada_result.Iext[i], gada_result.Iext[i + 1], 40,
+                                     record.read_count_ratio, record.ratio_stddev);
+        record.no_of_valid_windows = gada_result.SegLen[i];
+        record_vec.push_back(record);
+    }
+    status_msg = fmt::format("{}: {} data points segmented into {} segments.\n", chr_string, ratio_vec.size(),
+                             gada_result.K + 1);
+    if (_debug > 0)
+    {
+        RowWriter segment_writer;
+        segment_writer.open(_output_dir + "/" + chr_string + ".segments.fused.tsv");
+        for (const SegmentRecord &record : record_vec)
+            segment_writer.write("{}\t{}\t{}\t{:g}\t{:g}\t{}\n", record.chr_string, record.start, record.end,
+                                 record.read_count_ratio, record.ratio_stddev, record.no_of_valid_windows);
+    }
+    return true;
+}
+
+//SNP statistics of the segments foldSegmentRecords() may use. Only reads _SNPs, so files can be prepared
+// concurrently. Which of them are used depends on _segment_stddev_divider, which is left to foldSegmentRecords()
+// so that prepared records hold for any divider.
+void Infer::prepareSegmentRecords(vector<SegmentRecord> &record_vec)
+{
+    for (SegmentRecord &record : record_vec)
+    {
+        record.no_of_snps_used = 0;
+        double ratio_stddev = record.ratio_stddev/_segment_stddev_divider;
+        if (record.read_count_ratio > MAX_RATIO || record.ratio_stddev <= 0)
             continue;
-        }
+        int chr_index = chrStr_to_index(record.chr_string);
+        if (chr_index == -1)
+            continue;
+        OneSegment oneSegment = OneSegment(chr_index, record.start, record.end, record.read_count_ratio,
+                                           ratio_stddev, record.no_of_valid_windows);
+        record.no_of_snps_used = findSNPsWithinSegment(oneSegment);
+        record.segment_snps = oneSegment.oneSegmentSNPs;
+    }
+}
+
+//adds the segments of one file to the ratio histograms and _rc_ratio_segments
+void Infer::foldSegmentRecords(const vector<SegmentRecord> &record_vec, int **noOfWindowsByRatioAndChr, bool smooth)
+{
+    int start, end, no_of_valid_windows;
+    float read_count_ratio;
+    double ratio_stddev;
+    string chr_string;
+    for (const SegmentRecord &record : record_vec)
+    {
+        chr_string = record.chr_string;
         _total_no_of_segments++;
-        start = stoi(element_vec[1]);
-        end = stoi(element_vec[2]);
-        read_count_ratio = stof(element_vec[3]);
+        start = record.start;
+        end = record.end;
+        read_count_ratio = record.read_count_ratio;
         //decrease coverage ratio stddev to enhance signal/noise ratio
-        ratio_stddev = stof(element_vec[4])/_segment_stddev_divider;
-        no_of_valid_windows = stoi(element_vec[5]);
+        ratio_stddev = record.ratio_stddev/_segment_stddev_divider;
+        no_of_valid_windows = record.no_of_valid_windows;
 
-        if (_total_no_of_segments % 10000 == 0) cerr << _total_no_of_segments << "\n";
+        if (_total_no_of_segments % 10000 == 0) _log << _total_no_of_segments << "\n";
         if (read_count_ratio > 0.1 && ratio_stddev > read_count_ratio)
         {
             //TODO why?
-            cerr << "Warning: Too much variation at " << chr_string << start << end
+            _log << "Warning: Too much variation at " << chr_string << start << end
                  << ". Skip! " << read_count_ratio << " " << ratio_stddev << " "
                  << no_of_valid_windows << endl;
             continue;
@@ -1690,196 +2539,725 @@ int Infer::getSegmentDataFromFile(string input_file_path)
             {
                 noOfWindowsByRatioAndChr[ratio_high_res][chr_index] +=
                         no_of_valid_windows;
-                findSNPsWithinSegment(oneSegment);
-                kernel_smoothing(read_count_ratio * RESOLUTION, ratio_stddev*RESOLUTION, no_of_valid_windows,
+                oneSegment.oneSegmentSNPs = record.segment_snps;
+                _total_no_of_snps_used += record.no_of_snps_used;
+                if (smooth)
+                    kernel_smoothing(read_count_ratio * RESOLUTION, ratio_stddev*RESOLUTION, no_of_valid_windows,
                                  _ratio_int_pdf_vec);
             }
             _rc_ratio_segments[ratio_high_res].push_back(oneSegment);
             _total_no_of_segments_used ++;
         }
     }
-    input_file.close();
+}
+
+//2026.10.18 waits for the segment files while segmentation is still running. A file is taken once
+// "<file>.done" exists, or, if input_path is a FIFO, once its path is written there as a line ("END" ends
+// the stream). Files are queued as they land and read, with their SNP statistics, by at most
+// _no_of_reader_threads threads (0: one per core), started as the first files land.
+// Returns false on a timeout or an unreadable file.
+bool Infer::streamSegmentFiles(string input_path, vector<string> &path_vec,
+                               vector<vector<SegmentRecord> > &record_vec_by_file)
+{
+    struct stat path_stat;
+    bool is_fifo = (stat(input_path.c_str(), &path_stat) == 0 && S_ISFIFO(path_stat.st_mode));
+    std::chrono::steady_clock::time_point last_arrival = std::chrono::steady_clock::now();
+    //deques: element addresses stay valid for the reader threads while more files arrive
+    std::deque<vector<SegmentRecord> > record_vec_deque;
+    std::deque<char> read_ok_deque;
+    std::deque<string> status_msg_deque;
+    vector<size_t> fold_rank_vec;  //position in the input list, FIFO: set after the stream ends
+    //files taken but not yet read, as the file path and where its outcome goes
+    struct PendingFile
+    {
+        string file_path;
+        vector<SegmentRecord> *record_vec;
+        char *read_ok;
+        string *status_msg;
+    };
+    std::deque<PendingFile> pending_file_deque;
+    std::mutex pending_mutex;
+    std::condition_variable pending_condition;
+    bool stream_ended = false;
+    size_t max_no_of_threads = _no_of_reader_threads > 0 ? _no_of_reader_threads :
+                               std::max(1u, std::thread::hardware_concurrency());
+    vector<std::thread> thread_vec;
+    auto read_files = [&]() {
+        std::unique_lock<std::mutex> pending_lock(pending_mutex);
+        while (true)
+        {
+            pending_condition.wait(pending_lock, [&]() { return stream_ended || !pending_file_deque.empty(); });
+            if (pending_file_deque.empty())
+                return;
+            PendingFile pending_file = pending_file_deque.front();
+            pending_file_deque.pop_front();
+            pending_lock.unlock();
+            *pending_file.read_ok = readAndPrepareSegmentFileNoThrow(pending_file.file_path, *pending_file.record_vec,
+                                                                     *pending_file.status_msg);
+            pending_lock.lock();
+        }
+    };
+    auto take_file = [&](const string &file_path, size_t fold_rank) {
+        _log << fmt::format("Segment file {} is complete.\n", file_path);
+        path_vec.push_back(file_path);
+        fold_rank_vec.push_back(fold_rank);
+        {
+            std::lock_guard<std::mutex> pending_lock(pending_mutex);
+            record_vec_deque.push_back(vector<SegmentRecord>());
+            read_ok_deque.push_back(0);
+            status_msg_deque.push_back(string());
+            pending_file_deque.push_back(
+                    {file_path, &record_vec_deque.back(), &read_ok_deque.back(), &status_msg_deque.back()});
+        }
+        pending_condition.notify_one();
+        if (thread_vec.size() < max_no_of_threads)
+            thread_vec.push_back(std::thread(read_files));
+        last_arrival = std::chrono::steady_clock::now();
+    };
+    bool timed_out = false;
+    auto check_timeout = [&]() {
+        timed_out = (std::chrono::steady_clock::now() - last_arrival > std::chrono::seconds(_segment_stream_timeout));
+        return timed_out;
+    };
+
+    if (is_fifo)
+    {
+        //O_RDWR keeps the FIFO open between writers, so one GADA job closing it is not end of stream
+        int fifo_fd = open(input_path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fifo_fd < 0)
+        {
+            setError(fmt::format("could not open segment FIFO {}.", input_path));
+            return false;
+        }
+        string pending;
+        bool end_of_stream = false;
+        while (!end_of_stream)
+        {
+            struct pollfd fifo_poll = {fifo_fd, POLLIN, 0};
+            if (poll(&fifo_poll, 1, 1000) <= 0)
+            {
+                if (check_timeout())
+                    break;
+                continue;
+            }
+            char buffer[4096];
+            ssize_t no_of_bytes = read(fifo_fd, buffer, sizeof(buffer));
+            if (no_of_bytes <= 0)
+                continue;
+            pending.append(buffer, no_of_bytes);
+            size_t newline_pos;
+            while (!end_of_stream && (newline_pos = pending.find('\n')) != string::npos)
+            {
+                string file_path = pending.substr(0, newline_pos);
+                pending.erase(0, newline_pos + 1);
+                if (file_path == "END")
+                    end_of_stream = true;
+                else if (!file_path.empty() && file_path[0] != '#')
+                    take_file(file_path, 0);
+            }
+        }
+        close(fifo_fd);
+    }
+    else
+    {
+        vector<string> expected_path_vec;
+        string error_message;
+        if (!resolve_segment_input_paths(input_path, false, expected_path_vec, error_message))
+        {
+            setError(error_message);
+            return false;
+        }
+        vector<char> taken_vec(expected_path_vec.size(), 0);
+        size_t no_of_taken = 0;
+        while (no_of_taken < expected_path_vec.size() && !timed_out)
+        {
+            for (size_t i = 0; i < expected_path_vec.size(); i++)
+            {
+                if (!taken_vec[i] && isfile(expected_path_vec[i] + ".done"))
+                {
+                    taken_vec[i] = 1;
+                    no_of_taken++;
+                    take_file(expected_path_vec[i], i);
+                }
+            }
+            if (no_of_taken < expected_path_vec.size() && !check_timeout())
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> pending_lock(pending_mutex);
+        stream_ended = true;
+    }
+    pending_condition.notify_all();
+    for (std::thread &reader_thread : thread_vec)
+        reader_thread.join();
+    if (thread_vec.size() > 1)
+        _log << path_vec.size() << " segment files read with " << thread_vec.size() << " threads.\n";
+    if (timed_out)
+    {
+        setError(fmt::format("no segment file completed within {} seconds ({} received).",
+                             _segment_stream_timeout, path_vec.size()));
+        return false;
+    }
+    for (size_t file_index = 0; file_index < path_vec.size(); file_index++)
+    {
+        if (!read_ok_deque[file_index])
+        {
+            setError(fmt::format("could not read segment file {}. {}", path_vec[file_index],
+                                 status_msg_deque[file_index]));
+            return false;
+        }
+    }
+    //fold in list order (FIFO: natural order of the names), not arrival order, so the result matches a
+    // non-streaming run
+    vector<size_t> order_vec(path_vec.size());
+    for (size_t i = 0; i < order_vec.size(); i++)
+        order_vec[i] = i;
+    if (is_fifo)
+        std::sort(order_vec.begin(), order_vec.end(),
+                  [&](size_t i, size_t j) { return natural_less(path_vec[i], path_vec[j]); });
+    else
+        std::sort(order_vec.begin(), order_vec.end(),
+                  [&](size_t i, size_t j) { return fold_rank_vec[i] < fold_rank_vec[j]; });
+    vector<string> ordered_path_vec;
+    for (size_t file_index : order_vec)
+    {
+        _log << status_msg_deque[file_index];
+        ordered_path_vec.push_back(path_vec[file_index]);
+        record_vec_by_file.push_back(vector<SegmentRecord>());
+        record_vec_by_file.back().swap(record_vec_deque[file_index]);
+    }
+    path_vec.swap(ordered_path_vec);
+    return true;
+}
+
+// read in the results from BIC-seq for the read count data
+int Infer::getSegmentDataFromFile(string input_path)
+{
+    /*** read in segmentation data from input_path and store data in 3-d
+     * array
+     * _SNPs _rc_ratio_segments ***/
+    /*** 2026.10.18 input_path may list several files (e.g. one per chromosome from GADA) or be a directory.
+     * The files are parsed (and inflated, if gzipped) and their SNP statistics computed by concurrent
+     * threads; segments then enter the shared structures on this thread in list order, so results do not
+     * depend on the thread count or, with _segment_stream_timeout>0, on the order the files complete. ***/
+    vector<vector<SegmentRecord> > record_vec_by_file;
+    int returnCode = readSegmentFiles(input_path, record_vec_by_file);
+    if (returnCode != 0)
+        return returnCode;
+    foldSegmentFiles(record_vec_by_file);
+    return 0;
+}
+
+//reads and prepares the segment files of input_path, in list order
+int Infer::readSegmentFiles(string input_path, vector<vector<SegmentRecord> > &record_vec_by_file)
+{
+    _log << "Reading in segments from " << input_path << " ...\n";
+    vector<string> path_vec;
+    size_t no_of_threads = 0;
+    if (_segment_stream_timeout > 0)
+    {
+        if (!streamSegmentFiles(input_path, path_vec, record_vec_by_file))
+            return 3;
+    }
+    else
+    {
+        string error_message;
+        if (!resolve_segment_input_paths(input_path, true, path_vec, error_message))
+            return setError(error_message);
+        record_vec_by_file.resize(path_vec.size());
+        vector<char> read_ok_vec(path_vec.size(), 0);
+        vector<string> status_msg_vec(path_vec.size());
+        std::atomic<size_t> next_file_index(0);
+        auto read_files = [&]() {
+            for (size_t file_index = next_file_index++; file_index < path_vec.size(); file_index = next_file_index++)
+                read_ok_vec[file_index] = readAndPrepareSegmentFileNoThrow(
+                        path_vec[file_index], record_vec_by_file[file_index], status_msg_vec[file_index]);
+        };
+        no_of_threads = _no_of_reader_threads > 0 ? _no_of_reader_threads :
+                        std::max(1u, std::thread::hardware_concurrency());
+        no_of_threads = std::min<size_t>(path_vec.size(), no_of_threads);
+        vector<std::thread> thread_vec;
+        for (size_t thread_index = 1; thread_index < no_of_threads; thread_index++)
+            thread_vec.push_back(std::thread(read_files));
+        read_files();
+        for (std::thread &reader_thread : thread_vec)
+            reader_thread.join();
+        for (size_t file_index = 0; file_index < path_vec.size(); file_index++)
+        {
+            if (!read_ok_vec[file_index])
+                return setError(fmt::format("could not read segment file {}. {}", path_vec[file_index],
+                                            status_msg_vec[file_index]));
+            _log << status_msg_vec[file_index];
+        }
+    }
+    if (no_of_threads > 1)
+        _log << path_vec.size() << " segment files read with " << no_of_threads << " threads.\n";
+    _profile.setCount("segment_files", path_vec.size());
+    return 0;
+}
+
+//2026.10.18 segments handed over in memory, as one file's worth of records
+int Infer::getSegmentDataFromRecords(const SegmentRecord *segments, size_t no_of_segments, bool segments_prepared)
+{
+    _log << "Taking " << no_of_segments << " segments from memory ...\n";
+    vector<vector<SegmentRecord> > record_vec_by_file(1, vector<SegmentRecord>(segments, segments + no_of_segments));
+    if (!segments_prepared)
+        prepareSegmentRecords(record_vec_by_file[0]);
+    foldSegmentFiles(record_vec_by_file);
+    return 0;
+}
+
+//2026.10.18 derived structure cache. Files in _cache_dir are named by a 64-bit key: <key>.segments.bin holds
+// the prepared segments of one input (key: content of the SNP and segment files and the in-process segmentation
+// parameters), <key>.histogram.bin the ratio histogram and autocorrelation of those segments folded with one
+// _segment_stddev_divider. Both are native-endian, start with a magic string and their key, and are written
+// to a temporary file and renamed, so concurrent runs never see half a file.
+const uint32_t kDerivedCacheVersion = 1;
+const char kSegmentCacheMagic[8] = {'A', 'C', 'C', 'S', 'E', 'G', '\0', '\0'};
+const char kHistogramCacheMagic[8] = {'A', 'C', 'C', 'H', 'I', 'S', 'T', '\0'};
+
+static inline uint64_t mix_hash(uint64_t hash, uint64_t value)
+{
+    hash = (hash ^ value) * 0x100000001b3ULL;
+    return hash ^ (hash >> 29);
+}
+
+//hashes the bytes of a file (gzipped ones as they are) 8 at a time
+static bool hash_file_content(const string &file_path, uint64_t &hash)
+{
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    vector<char> buffer(1 << 20);
+    uint64_t no_of_bytes = 0;
+    ssize_t no_of_bytes_read;
+    while ((no_of_bytes_read = read(fd, buffer.data(), buffer.size())) > 0)
+    {
+        size_t i = 0;
+        for (; i + 8 <= (size_t) no_of_bytes_read; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, buffer.data() + i, 8);
+            hash = mix_hash(hash, word);
+        }
+        for (; i < (size_t) no_of_bytes_read; i++)
+            hash = mix_hash(hash, (unsigned char) buffer[i]);
+        no_of_bytes += no_of_bytes_read;
+    }
+    close(fd);
+    hash = mix_hash(hash, no_of_bytes);
+    return no_of_bytes_read == 0;
+}
+
+template <typename T>
+static void write_binary(ostream &out, const T &value)
+{
+    out.write((const char *) &value, sizeof(T));
+}
+
+template <typename T>
+static bool read_binary(istream &in, T &value)
+{
+    return (bool) in.read((char *) &value, sizeof(T));
+}
+
+//writes to a temporary file, renamed to file_path once complete
+static void write_cache_file(const string &file_path, const std::function<void(ostream &)> &write_content)
+{
+    string tmp_file_path = fmt::format("{}.{}.tmp", file_path, getpid());
+    {
+        ofstream out(tmp_file_path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        write_content(out);
+        if (!out)
+        {
+            out.close();
+            unlink(tmp_file_path.c_str());
+            return;
+        }
+    }
+    rename(tmp_file_path.c_str(), file_path.c_str());
+}
+
+string inferInputStamp(const InferInput &input)
+{
+    vector<string> path_vec;
+    string error_message;
+    if (!input.snp_data_input_path.empty())
+        path_vec.push_back(input.snp_data_input_path);
+    if (!input.segment_data_input_path.empty())
+        resolve_segment_input_paths(input.segment_data_input_path, false, path_vec, error_message);
+    fmt::MemoryWriter stamp;
+    for (const string &file_path : path_vec)
+    {
+        struct stat file_stat;
+        if (stat(file_path.c_str(), &file_stat) == 0)
+            stamp << file_path << ' ' << file_stat.st_size << ' ' << file_stat.st_mtim.tv_sec << '.'
+                  << file_stat.st_mtim.tv_nsec << '\n';
+        else
+            stamp << file_path << " missing\n";
+    }
+    return stamp.str();
+}
+
+void addInferOptions(po::options_description &option_description, InferOptions &options, string &engine_name,
+                     bool with_scoring_options)
+{
+    option_description.add_options()
+            ("config", po::value<string>(&options.config_file_path)->default_value(""), "configure file");
+    if (with_scoring_options)
+        option_description.add_options()
+                ("segment_stddev_divider", po::value<float>(&options.segment_stddev_divider)->default_value(20))
+                ("snp_coverage_min", po::value<int>(&options.snp_coverage_min)->default_value(2))
+                ("snp_coverage_var_vs_mean_ratio",
+                 po::value<float>(&options.snp_coverage_var_vs_mean_ratio)->default_value(10))
+                ("max_no_of_peaks_for_logL", po::value<int>(&options.no_of_peaks_for_logL)->default_value(3));
+    option_description.add_options()
+            ("auto", po::value<int>(&options.auto_)->default_value(1))
+            ("segmentation_engine", po::value<string>(&engine_name)->default_value("SBL"))
+            ("min_segment_len", po::value<long>(&options.segment_min_len)->default_value(50))
+            ("t_score_threshold", po::value<double>(&options.segment_t_score)->default_value(20));
+}
+
+bool finishInferOptions(const string &engine_name, InferOptions &options, string &error_message)
+{
+    options.segmentation_engine = segmentationEngineFromName(engine_name);
+    if (options.segmentation_engine < 0)
+    {
+        error_message = fmt::format("unknown segmentation engine {}. Choose SBL or PELT.", engine_name);
+        return false;
+    }
+    Config config;
+    if (!options.config_file_path.empty() && !read_para(options.config_file_path, config, error_message))
+        return false;
+    return true;
+}
+
+int setInferOption(InferOptions &options, const string &name, const string &value, string &error_message)
+{
+    bool valid = true;
+    int int_value;
+    if (name == "segment_stddev_divider")
+        valid = parse_float(value, options.segment_stddev_divider);
+    else if (name == "snp_coverage_min")
+        valid = parse_int(value, options.snp_coverage_min);
+    else if (name == "snp_coverage_var_vs_mean_ratio")
+        valid = parse_float(value, options.snp_coverage_var_vs_mean_ratio);
+    else if (name == "max_no_of_peaks_for_logL")
+        valid = parse_int(value, options.no_of_peaks_for_logL);
+    else if (name == "auto")
+        valid = parse_int(value, options.auto_);
+    else if (name == "segmentation_engine")
+    {
+        options.segmentation_engine = segmentationEngineFromName(value);
+        valid = options.segmentation_engine >= 0;
+    }
+    else if (name == "min_segment_len")
+    {
+        valid = parse_int(value, int_value);
+        if (valid)
+            options.segment_min_len = int_value;
+    }
+    else if (name == "t_score_threshold")
+        valid = parse_double(value, options.segment_t_score);
+    else
+        return 1;
+    if (!valid)
+    {
+        error_message = fmt::format("invalid {} {}.", name, value);
+        return 2;
+    }
+    return 0;
+}
+
+//false if a file cannot be read, the run then reads the files as without a cache and reports the error
+bool Infer::segmentCacheKey(const InferInput &input, uint64_t &key)
+{
+    vector<string> path_vec;
+    string error_message;
+    if (!resolve_segment_input_paths(input.segment_data_input_path, true, path_vec, error_message))
+        return false;
+    key = mix_hash(0xcbf29ce484222325ULL, kDerivedCacheVersion);
+    if (!hash_file_content(input.snp_data_input_path, key))
+        return false;
+    key = mix_hash(key, path_vec.size());
+    for (const string &file_path : path_vec)
+        if (!hash_file_content(file_path, key))
+            return false;
+    key = mix_hash(key, _segmentation_engine);
+    key = mix_hash(key, _segment_min_len);
+    uint64_t t_score_bits;
+    memcpy(&t_score_bits, &_segment_t_score, sizeof(t_score_bits));
+    key = mix_hash(key, t_score_bits);
+    return true;
+}
+
+uint64_t Infer::histogramCacheKey(uint64_t segment_cache_key)
+{
+    uint32_t divider_bits;
+    memcpy(&divider_bits, &_segment_stddev_divider, sizeof(divider_bits));
+    return mix_hash(mix_hash(segment_cache_key, divider_bits), RESOLUTION);
+}
+
+bool Infer::readSegmentCache(uint64_t key, vector<SegmentRecord> &segment_vec)
+{
+    ifstream in(fmt::format("{}/{:016x}.segments.bin", _cache_dir, key).c_str(), std::ios::binary);
+    char magic[8];
+    uint64_t file_key, no_of_snps, no_of_segments;
+    if (!in || !in.read(magic, sizeof(magic)) || memcmp(magic, kSegmentCacheMagic, sizeof(magic)) != 0 ||
+        !read_binary(in, file_key) || file_key != key || !read_binary(in, no_of_snps) ||
+        !read_binary(in, no_of_segments))
+        return false;
+    segment_vec.resize(no_of_segments);
+    for (SegmentRecord &record : segment_vec)
+    {
+        uint16_t chr_string_len;
+        if (!read_binary(in, chr_string_len))
+            return false;
+        record.chr_string.resize(chr_string_len);
+        OneSegmentSNPs &segment_snps = record.segment_snps;
+        if (!in.read(&record.chr_string[0], chr_string_len) || !read_binary(in, record.start) ||
+            !read_binary(in, record.end) || !read_binary(in, record.read_count_ratio) ||
+            !read_binary(in, record.ratio_stddev) || !read_binary(in, record.no_of_valid_windows) ||
+            !read_binary(in, record.no_of_snps_used) || !read_binary(in, segment_snps.maf_mean) ||
+            !read_binary(in, segment_snps.maf_stddev) || !read_binary(in, segment_snps.no_of_snps) ||
+            !read_binary(in, segment_snps.coverage_mean) || !read_binary(in, segment_snps.coverage_var) ||
+            !read_binary(in, segment_snps.coverage_squared_sum))
+            return false;
+    }
+    _total_no_of_snps = no_of_snps;
+    _log << fmt::format("{} prepared segments ({} SNPs) taken from the cache {}.\n", no_of_segments, no_of_snps,
+                        _cache_dir);
+    return true;
+}
+
+void Infer::writeSegmentCache(uint64_t key, const vector<vector<SegmentRecord> > &record_vec_by_file)
+{
+    uint64_t no_of_segments = 0;
+    for (const vector<SegmentRecord> &record_vec : record_vec_by_file)
+        no_of_segments += record_vec.size();
+    write_cache_file(fmt::format("{}/{:016x}.segments.bin", _cache_dir, key), [&](ostream &out) {
+        out.write(kSegmentCacheMagic, sizeof(kSegmentCacheMagic));
+        write_binary(out, key);
+        write_binary(out, (uint64_t) _total_no_of_snps);
+        write_binary(out, no_of_segments);
+        for (const vector<SegmentRecord> &record_vec : record_vec_by_file)
+            for (const SegmentRecord &record : record_vec)
+            {
+                const OneSegmentSNPs &segment_snps = record.segment_snps;
+                write_binary(out, (uint16_t) record.chr_string.size());
+                out.write(record.chr_string.data(), record.chr_string.size());
+                write_binary(out, record.start);
+                write_binary(out, record.end);
+                write_binary(out, record.read_count_ratio);
+                write_binary(out, record.ratio_stddev);
+                write_binary(out, record.no_of_valid_windows);
+                write_binary(out, record.no_of_snps_used);
+                write_binary(out, segment_snps.maf_mean);
+                write_binary(out, segment_snps.maf_stddev);
+                write_binary(out, segment_snps.no_of_snps);
+                write_binary(out, segment_snps.coverage_mean);
+                write_binary(out, segment_snps.coverage_var);
+                write_binary(out, segment_snps.coverage_squared_sum);
+            }
+    });
+}
+
+bool Infer::readHistogramCache(uint64_t key)
+{
+    ifstream in(fmt::format("{}/{:016x}.histogram.bin", _cache_dir, key).c_str(), std::ios::binary);
+    char magic[8];
+    uint64_t file_key, pdf_size, cor_size;
+    if (!in || !in.read(magic, sizeof(magic)) || memcmp(magic, kHistogramCacheMagic, sizeof(magic)) != 0 ||
+        !read_binary(in, file_key) || file_key != key || !read_binary(in, pdf_size) ||
+        pdf_size != _ratio_int_pdf_vec.size())
+        return false;
+    vector<double> pdf_vec(pdf_size);
+    double cor_array[kPeriodMax + 1];
+    if (!in.read((char *) pdf_vec.data(), pdf_size * sizeof(double)) || !read_binary(in, cor_size) ||
+        cor_size != kPeriodMax + 1 || !in.read((char *) cor_array, sizeof(cor_array)))
+        return false;
+    _ratio_int_pdf_vec.swap(pdf_vec);
+    std::copy(cor_array, cor_array + kPeriodMax + 1, _cor_array);
+    _log << "Ratio histogram and autocorrelation taken from the cache.\n";
+    return true;
+}
+
+void Infer::writeHistogramCache(uint64_t key)
+{
+    write_cache_file(fmt::format("{}/{:016x}.histogram.bin", _cache_dir, key), [&](ostream &out) {
+        out.write(kHistogramCacheMagic, sizeof(kHistogramCacheMagic));
+        write_binary(out, key);
+        write_binary(out, (uint64_t) _ratio_int_pdf_vec.size());
+        out.write((const char *) _ratio_int_pdf_vec.data(), _ratio_int_pdf_vec.size() * sizeof(double));
+        write_binary(out, (uint64_t) (kPeriodMax + 1));
+        out.write((const char *) _cor_array, (kPeriodMax + 1) * sizeof(double));
+    });
+}
+
+//folds the records of all files, in order, into the ratio histograms and _rc_ratio_segments. Without smooth,
+// _ratio_int_pdf_vec is left as it is (taken from the cache).
+void Infer::foldSegmentFiles(const vector<vector<SegmentRecord> > &record_vec_by_file, bool smooth)
+{
+    _total_no_of_segments = 0;
+    _total_no_of_segments_used = 0;
+
+    int **noOfWindowsByRatioAndChr;
+    noOfWindowsByRatioAndChr = new int *[MAX_RATIO_HIGH_RES + 1];
+    for (int i = 0; i <= MAX_RATIO_HIGH_RES; i++)
+    {
+        noOfWindowsByRatioAndChr[i] = new int[NUM_AUTO_CHR];
+        for (int chr_index = 0; chr_index < NUM_AUTO_CHR; chr_index++)
+            noOfWindowsByRatioAndChr[i][chr_index] = 0;
+    }
+    for (const vector<SegmentRecord> &record_vec : record_vec_by_file)
+        foldSegmentRecords(record_vec, noOfWindowsByRatioAndChr, smooth);
     if (_debug > 0)
     {
         output_segment_ratio(noOfWindowsByRatioAndChr);
     }
+    //the records of all files and the window count table only exist until here
+    RunProfile::StructureBytes transient_vec;
+    size_t segment_record_bytes = vector_bytes(record_vec_by_file);
+    for (const vector<SegmentRecord> &record_vec : record_vec_by_file)
+        segment_record_bytes += vector_bytes(record_vec);
+    transient_vec.push_back(make_pair(string("segment_records"), segment_record_bytes));
+    transient_vec.push_back(make_pair(string("window_count_table"),
+                                      (MAX_RATIO_HIGH_RES + 1) * (sizeof(int *) + NUM_AUTO_CHR * sizeof(int))));
+    recordMemory("segment_fold", transient_vec);
     for (int i = 0; i <= MAX_RATIO_HIGH_RES; i++)
     {
         delete[] noOfWindowsByRatioAndChr[i];
     }
     delete[] noOfWindowsByRatioAndChr;
-    cerr << _total_no_of_segments << " segments. " << _total_no_of_segments_used << " segments used. " << _total_no_of_snps_used << " SNPs used." << endl;
-    return 0;
+    _log << _total_no_of_segments << " segments. " << _total_no_of_segments_used << " segments used. " << _total_no_of_snps_used << " SNPs used." << endl;
 }
 
 int Infer::output_segment_ratio(int **noOfWindowsByRatioAndChr)
 {
     string file_name1 = _output_dir + "/rc_ratio_window_count_smoothed.tsv";
-    cerr << "Outputting segment ratio data to " << file_name1 << "...";
-    ofstream tmp(file_name1.c_str());
-    tmp << "read_count_ratio"
-        << "\t"
-        << "window_count_smoothed" << endl;
+    _log << "Outputting segment ratio data to " << file_name1 << "...";
+    RowWriter window_count_writer;
+    window_count_writer.open(file_name1);
+    window_count_writer.write("read_count_ratio\twindow_count_smoothed\n");
     for (int rc_ratio_int = 0; rc_ratio_int < _ratio_int_pdf_vec.size();
          rc_ratio_int++)
-        tmp << rc_ratio_int * 1.0 / RESOLUTION << "\t"
-            << _ratio_int_pdf_vec[rc_ratio_int] << endl;
-    tmp.close();
-    cerr << "Done.\n";
+        window_count_writer.write("{:g}\t{:g}\n", rc_ratio_int * 1.0 / RESOLUTION, _ratio_int_pdf_vec[rc_ratio_int]);
+    window_count_writer.close();
+    _log << "Done.\n";
 
     string file_name2 = _output_dir + "/rc_ratio_no_of_windows_by_chr.tsv";
-    cerr << "Outputting segment ratio data to " << file_name2 << "...";
-    //IMPORTANT rc_ratio_by_chr_out_stream_buffer & rc_ratio_by_chr_out_file can't be declared here.
-    // otherwise, the program will hung forever by function end.
-    // #### gzip output does not work. It simply hung or output an empty gzip file.
-    // boost::iostreams::filtering_streambuf<boost::iostreams::output> rc_ratio_by_chr_out_stream_buffer;
-    //rc_ratio_by_chr_out_stream_buffer.push(boost::iostreams::gzip_compressor());
-    rc_ratio_by_chr_out_file.open(file_name2.c_str(), std::ios::out | std::ios::binary);
-    //rc_ratio_by_chr_out_stream_buffer.push(rc_ratio_by_chr_out_file);
-    //std::ostream rc_ratio_by_chr_out_stream(&rc_ratio_by_chr_out_stream_buffer);
-
-    rc_ratio_by_chr_out_file << "readCountRatioX1000";
+    _log << "Outputting segment ratio data to " << file_name2 << "...";
+    RowWriter window_count_by_chr_writer;
+    window_count_by_chr_writer.open(file_name2);
+    window_count_by_chr_writer.write("readCountRatioX1000");
     for (int chr_index = 0; chr_index < NUM_AUTO_CHR; chr_index++)
-        rc_ratio_by_chr_out_file << "\t" << setw(8) << "chr" << chr_index << "_noOfWindows";
-    rc_ratio_by_chr_out_file << "\n";
+        window_count_by_chr_writer.write("\t{:>8}{}_noOfWindows", "chr", chr_index);
+    window_count_by_chr_writer.write("\n");
 
     for (int i = 0; i <= MAX_RATIO_HIGH_RES; i++)
     {
-        rc_ratio_by_chr_out_file << setw(8) << i;
+        window_count_by_chr_writer.write("{:>8}", i);
         for (int chr_index = 0; chr_index < NUM_AUTO_CHR; chr_index++)
-            rc_ratio_by_chr_out_file << "\t" << setw(8)
-                                     << noOfWindowsByRatioAndChr[i][chr_index];
-        rc_ratio_by_chr_out_file << "\n";
+            window_count_by_chr_writer.write("\t{:>8}", noOfWindowsByRatioAndChr[i][chr_index]);
+        window_count_by_chr_writer.write("\n");
     }
-    //rc_ratio_by_chr_out_stream.flush();
-    //rc_ratio_by_chr_out_file.flush();
-    cerr << "Done." << endl;
+    window_count_by_chr_writer.close();
+    _log << "Done." << endl;
     return 0;
 }
 
 int Infer::output_snp_maf_by_segment()
 {
     string tmp_file_path = _output_dir + "/snp_maf_by_segment.tsv";
-    cerr << fmt::format("Outputting SNP MAFs by segments to {} ... ", tmp_file_path);
-    ofstream snp_maf_by_segment_outf;
-    snp_maf_by_segment_outf.open(tmp_file_path.c_str());
-
-
-    snp_maf_by_segment_outf << "rc_ratio_int" << "\t"
-                            << "segment.index" << "\t"
-                            << "maf_mean" << "\t"
-                            << "maf_stddev" << "\t"
-                            << "coverage_mean" << "\t"
-                            << "coverage_var" << "\t"
-                            << "coverage_squared_sum" << "\t"
-                            << "no_of_snps" << endl;
+    _log << fmt::format("Outputting SNP MAFs by segments to {} ... ", tmp_file_path);
+    RowWriter snp_maf_by_segment_writer;
+    snp_maf_by_segment_writer.open(tmp_file_path);
+    snp_maf_by_segment_writer.write("rc_ratio_int\tsegment.index\tmaf_mean\tmaf_stddev\tcoverage_mean\tcoverage_var\t"
+                                    "coverage_squared_sum\tno_of_snps\n");
     int counter = 0;
     for (int it = 0; it < MAX_RATIO_HIGH_RES + 1; it++) {
         for (uint seg = 0; seg < _rc_ratio_segments[it].size(); seg++) {
             counter ++;
-            OneSegmentSNPs oneSegmentSNPs =
-                    _rc_ratio_segments[it][seg].oneSegmentSNPs;
-            snp_maf_by_segment_outf << it << "\t"
-                                    << seg << "\t"
-                                    << pow(10, oneSegmentSNPs.maf_mean) << "\t"
-                                    << oneSegmentSNPs.maf_stddev << "\t"
-                                    << oneSegmentSNPs.coverage_mean << "\t"
-                                    << oneSegmentSNPs.coverage_var << "\t"
-                                    << oneSegmentSNPs.coverage_squared_sum << "\t"
-                                    << oneSegmentSNPs.no_of_snps << endl;
-        }
-    }
-    snp_maf_by_segment_outf.close();
-    cerr << fmt::format("{} segments.\n", counter);
+            const OneSegmentSNPs &oneSegmentSNPs = _rc_ratio_segments[it][seg].oneSegmentSNPs;
+            snp_maf_by_segment_writer.write("{}\t{}\t{:g}\t{:g}\t{:g}\t{:g}\t{:g}\t{}\n", it, seg,
+                                            pow(10, oneSegmentSNPs.maf_mean), oneSegmentSNPs.maf_stddev,
+                                            oneSegmentSNPs.coverage_mean, oneSegmentSNPs.coverage_var,
+                                            oneSegmentSNPs.coverage_squared_sum, oneSegmentSNPs.no_of_snps);
+        }
+    }
+    snp_maf_by_segment_writer.close();
+    _log << fmt::format("{} segments.\n", counter);
     return 0;
 }
 
 int Infer::output_snp_maf_by_peak(vector<OnePeak> &peak_obj_vector)
 {
     string tmp_file_path=fmt::format("{}/snp_maf_by_peak.tsv", _output_dir);
-    cerr << fmt::format("Outputting SNP MAFs by peaks to {} ... ", tmp_file_path);
-    ofstream snp_maf_by_peak_outf;
-    snp_maf_by_peak_outf.open(tmp_file_path.c_str());
-    snp_maf_by_peak_outf << "peak.index" << "\t"
-                         << "peak_center_int" << "\t"
-                         << "no_of_snps" << "\t"
-                         << "no_of_maf_peaks" << "\t"
-                         << "segment.index" << "\t"
-                         << "rc_ratio_int" << "\t"
-                         << "maf_mean" << "\t"
-                         << "maf_stddev" << "\t"
-                         << "no_of_snps" << "\t"
-                         << "coverage_mean" << "\t"
-                         << "coverage_var" << "\t"
-                         << "coverage_squared_sum" << endl;
+    _log << fmt::format("Outputting SNP MAFs by peaks to {} ... ", tmp_file_path);
+    RowWriter snp_maf_by_peak_writer;
+    snp_maf_by_peak_writer.open(tmp_file_path);
+    snp_maf_by_peak_writer.write("peak.index\tpeak_center_int\tno_of_snps\tno_of_maf_peaks\tsegment.index\t"
+                                 "rc_ratio_int\tmaf_mean\tmaf_stddev\tno_of_snps\tcoverage_mean\tcoverage_var\t"
+                                 "coverage_squared_sum\n");
     for (uint i = 0; i < peak_obj_vector.size(); i++) {
         OnePeak& peak_obj = peak_obj_vector[i];
         for (uint seg_index = 0; seg_index < peak_obj.segment_obj_vector.size(); seg_index++) {
-            OneSegment oneSegment = peak_obj.segment_obj_vector[seg_index];
-            OneSegmentSNPs oneSegmentSNPs = oneSegment.oneSegmentSNPs;
-            snp_maf_by_peak_outf << i << "\t"
-                                 << peak_obj.peak_center_int << "\t"
-                                 << peak_obj.no_of_snps << "\t"
-                                 << peak_obj.no_of_maf_peaks << "\t"
-                                 << seg_index << "\t"
-                                 << oneSegment.get_rc_ratio_high_res() << "\t"
-                                 << pow(10, oneSegmentSNPs.maf_mean) << "\t"
-                                 << oneSegmentSNPs.maf_stddev << "\t"
-                                 << oneSegmentSNPs.no_of_snps << "\t"
-                                 << oneSegmentSNPs.coverage_mean << "\t"
-                                 << oneSegmentSNPs.coverage_var << "\t"
-                                 << oneSegmentSNPs.coverage_squared_sum
-                                 << endl;
-        }
-    }
-    snp_maf_by_peak_outf.close();
+            OneSegment &oneSegment = peak_obj.segment_obj_vector[seg_index];
+            const OneSegmentSNPs &oneSegmentSNPs = oneSegment.oneSegmentSNPs;
+            snp_maf_by_peak_writer.write("{}\t{}\t{}\t{}\t{}\t{}\t{:g}\t{:g}\t{}\t{:g}\t{:g}\t{:g}\n", i,
+                                         peak_obj.peak_center_int, peak_obj.no_of_snps, peak_obj.no_of_maf_peaks,
+                                         seg_index, oneSegment.get_rc_ratio_high_res(),
+                                         pow(10, oneSegmentSNPs.maf_mean), oneSegmentSNPs.maf_stddev,
+                                         oneSegmentSNPs.no_of_snps, oneSegmentSNPs.coverage_mean,
+                                         oneSegmentSNPs.coverage_var, oneSegmentSNPs.coverage_squared_sum);
+        }
+    }
+    snp_maf_by_peak_writer.close();
 
     int counter = 0;
     for (uint i = 0; i < peak_obj_vector.size(); i++) {
         OnePeak& peak_obj = peak_obj_vector[i];
         if (peak_obj.no_of_snps>0){
             counter ++;
-            ofstream outf;
-            outf.open(fmt::format("{0}/snp_maf_pdf_of_peak_{1}.tsv", _output_dir, i).c_str());
-            outf << "#peak.index=" << i << endl;
-            outf << "#peak_center_int=" << peak_obj.peak_center_int << endl;
-            outf << "#no_of_maf_peaks=" << peak_obj.no_of_maf_peaks << endl;
-            outf << "maf\tcount\n";
+            RowWriter maf_pdf_writer;
+            maf_pdf_writer.open(fmt::format("{0}/snp_maf_pdf_of_peak_{1}.tsv", _output_dir, i));
+            maf_pdf_writer.write("#peak.index={}\n#peak_center_int={}\n#no_of_maf_peaks={}\nmaf\tcount\n", i,
+                                 peak_obj.peak_center_int, peak_obj.no_of_maf_peaks);
             for (uint x_i = 0; x_i < peak_obj.maf_int_pdf_vec.size(); x_i++) {
-                outf << fmt::format("{}\t{}\n", pow(10, -float(x_i)/1000.0), peak_obj.maf_int_pdf_vec[x_i]);
+                maf_pdf_writer.write("{}\t{}\n", pow(10, -float(x_i)/1000.0), peak_obj.maf_int_pdf_vec[x_i]);
             }
-            outf.close();
+            maf_pdf_writer.close();
         }
     }
-    cerr << fmt::format("{} peaks with valid data.\n", counter);
+    _log << fmt::format("{} peaks with valid data.\n", counter);
     return 0;
 }
 
 int Infer::output_rc_ratio_of_peaks(vector<OnePeak> &peak_obj_vector)
 {
     string tmp_file_path = _output_dir + "/rc_ratios_of_peaks_of_best_period.tsv";
-    cerr << fmt::format("Outputting RC ratio of peaks to {} ... ", tmp_file_path);
-    ofstream rc_ratios_of_peaks_outf;
-    rc_ratios_of_peaks_outf.open(tmp_file_path.c_str(), ios::trunc);
-    rc_ratios_of_peaks_outf << "period_int" << "\t" << "peak_index" << "\t" <<
-                            "peak_center_int" << "\t" << "ratio_int" << endl;
+    _log << fmt::format("Outputting RC ratio of peaks to {} ... ", tmp_file_path);
+    RowWriter rc_ratios_of_peaks_writer;
+    rc_ratios_of_peaks_writer.open(tmp_file_path);
+    rc_ratios_of_peaks_writer.write("period_int\tpeak_index\tpeak_center_int\tratio_int\n");
     int counter = 0;
     for (uint i = 0; i < peak_obj_vector.size(); i++) {
-        for (uint j = 0; j < peak_obj_vector[i].segment_rc_ratio_vector.size();
-             j++) {
-            OnePeak &peak_obj = peak_obj_vector[i];
+        OnePeak &peak_obj = peak_obj_vector[i];
+        for (uint j = 0; j < peak_obj.segment_rc_ratio_vector.size(); j++) {
             counter++;
-            rc_ratios_of_peaks_outf
-                    << _period_obj_from_logL.period_int << "\t" << i << "\t" <<
-                    peak_obj.peak_center_int << "\t" <<
-                    peak_obj.segment_rc_ratio_vector[j] << endl;
+            rc_ratios_of_peaks_writer.write("{}\t{}\t{}\t{}\n", _period_obj_from_logL.period_int, i,
+                                            peak_obj.peak_center_int, peak_obj.segment_rc_ratio_vector[j]);
         }
     }
-    cerr << fmt::format(" {} segments.\n", counter);
-    rc_ratios_of_peaks_outf.close();
+    _log << fmt::format(" {} segments.\n", counter);
+    rc_ratios_of_peaks_writer.close();
     return 0;
 }
 
+//returns the number of SNPs used. Only reads _SNPs (2026.10.18, segment files are prepared on several threads).
 int Infer::findSNPsWithinSegment(OneSegment &oneSegment)
 {
     if (oneSegment.end_pos <= oneSegment.start_pos) {
@@ -1887,30 +3265,15 @@ int Infer::findSNPsWithinSegment(OneSegment &oneSegment)
         oneSegment.oneSegmentSNPs = OneSegmentSNPs();
         return 0;
     }
-    double maf_sum = 0, maf_ssum = 0, weight, sum_weight = 0, sum_cov = 0, ssum_cov = 0;
-    int total_no_of_snps = 0;
-    vector<OneSNP>::iterator oneSNPIt = _SNPs[oneSegment.chr_index].begin();
+    //2026.10.18 the SNPs of the segment are one run of the position-sorted store
+    const ChrSNPStore &chr_snp_store = _SNPs[oneSegment.chr_index];
+    pair<size_t, size_t> snp_range = chr_snp_store.range(oneSegment.start_pos, oneSegment.end_pos);
+    int total_no_of_snps = snp_range.second - snp_range.first;
     vector<float> maf_vector;
     vector<float> coverage_float_vector;
-
-    for (; oneSNPIt < _SNPs[oneSegment.chr_index].end(); oneSNPIt++) {
-        if (oneSNPIt->position >= oneSegment.start_pos &&
-            oneSNPIt->position <= oneSegment.end_pos) {
-            total_no_of_snps++;
-            maf_vector.push_back(oneSNPIt->maf);
-            coverage_float_vector.push_back(oneSNPIt->coverage*1.0);
-            // use robust mean/maf_stddev, stop weight by coverage
-            /*
-            weight = sqrt(oneSNPIt->coverage);
-            maf_sum += oneSNPIt->maf * weight;
-            maf_ssum += oneSNPIt->maf * oneSNPIt->maf * weight;
-            sum_weight += weight;
-            sum_cov += oneSNPIt->coverage;
-            ssum_cov += oneSNPIt->coverage * oneSNPIt->coverage;
-            // cerr<<_SNPs[chr_index][1][i]<<"\t"<<_SNPs[chr_index][2][i]<<"\n";
-             */
-        }
-    }
+    // use robust mean/maf_stddev, stop weight by coverage
+    chr_snp_store.appendLogMafs(snp_range.first, snp_range.second, maf_vector);
+    chr_snp_store.appendCoverages(snp_range.first, snp_range.second, coverage_float_vector);
     if (total_no_of_snps <= 10) {
         //not enough SNPs to do robust mean/maf_stddev
         // placeholder to match _rc_ratio_segments, but all values =-1
@@ -1936,7 +3299,7 @@ int Infer::findSNPsWithinSegment(OneSegment &oneSegment)
         oneSegment.oneSegmentSNPs =
                 OneSegmentSNPs(maf_mean, maf_stddev/_snp_maf_stddev_divider, no_of_snps_to_use,
                                coverage_mean, coverage_stddev*coverage_stddev, coverage_squared_sum);
-        _total_no_of_snps_used += no_of_snps_to_use;
+        return no_of_snps_to_use;
     }
     return 0;
 }
@@ -1997,7 +3360,7 @@ int Infer::refine_peak_center(OnePeak &peak_obj, vector<int> segment_rc_ratio_ve
 
 vector<double> Infer::call_subclone_peaks(double *a, int size)
 {
-    cerr << "Calling subclone peaks ...";
+    _log << "Calling subclone peaks ...";
     vector<double> peaks;
     // int should_size = 3;
     int clip_size = 5;
@@ -2032,7 +3395,7 @@ vector<double> Infer::call_subclone_peaks(double *a, int size)
             peaks.push_back((a[i] - mean1) / std1);
         }
     }
-    cerr << "Done.\n";
+    _log << "Done.\n";
     return peaks;
 }
 
@@ -2044,7 +3407,8 @@ double Infer::output_copy_number_segments(OnePeriod &best_period_obj,
     //cnv.interval.tsv is only for sub-clonal peaks. In addition to copy number, it contains copy interval info.
     string output_cp_interval = _output_dir + "/cnv.interval.tsv";
 
-    cerr << "Outputting copy number to  " << output_file_path << endl;
+    if (_write_artifacts)
+        _log << "Outputting copy number to  " << output_file_path << endl;
 
     _genome_len_cnv_all = 0;
     _genome_len_clonal = 0;
@@ -2060,34 +3424,20 @@ double Infer::output_copy_number_segments(OnePeriod &best_period_obj,
     }
     // string
     // CASE=_segment_data_input_path.substr(0,_segment_data_input_path.find('/'));
-    ofstream outf(output_file_path.c_str());
-    outf << "chr" << "\t"
-         << "cumu_start" << "\t"
-         << "cumu_end" << "\t"
-         << "cp" << "\t"
-         << "major_allele_cp" << "\t"
-         << "copy_no_float" << "\t"
-         << "oneSegment.stddev" << "\t"
-         << "maf_mean" << "\t"
-         << "maf_stddev" << "\t"
-         << "maf_expected" << "\t"
-         << "start" << "\t"
-         << "end"
-         << endl;
-    ofstream out_interval(output_cp_interval.c_str());
+    //writers that are not open drop the rows below without _write_artifacts
+    RowWriter outf;
+    RowWriter out_interval;
+    if (_write_artifacts)
+    {
+        outf.open(output_file_path);
+        out_interval.open(output_cp_interval);
+    }
+    outf.write("chr\tcumu_start\tcumu_end\tcp\tmajor_allele_cp\tcopy_no_float\toneSegment.stddev\tmaf_mean\t"
+               "maf_stddev\tmaf_expected\tstart\tend\n");
     if (_debug > 0)
     {
-        out_interval << "chr\t"
-                     << "start\t"
-                     << "end\t"
-                     << "cp\t"
-                     << "copy_no_float\t"
-                     << "cp_stddev\t"
-                     << "interval_left\t"
-                     << "interval_right\t"
-                     << "seg_stddev\t"
-                     << "seg_num_of_window"
-                     << endl;
+        out_interval.write("chr\tstart\tend\tcp\tcopy_no_float\tcp_stddev\tinterval_left\tinterval_right\t"
+                           "seg_stddev\tseg_num_of_window\n");
     }
 
     int best_period_int = best_period_obj.period_int;
@@ -2112,7 +3462,7 @@ double Infer::output_copy_number_segments(OnePeriod &best_period_obj,
     {
         OnePeak &peak_obj = peak_obj_vector[peak_index];
         int cp = no_of_copy_nos_bf_1st_peak + peak_index;
-        if (_debug > 0) cerr << "\tcopy number: " << cp << endl;
+        if (_debug > 0) _log << "\tcopy number: " << cp << endl;
         vector<int>::iterator it;
         for (it = peak_obj.segment_rc_ratio_vector.begin();
              it < peak_obj.segment_rc_ratio_vector.end(); it++)
@@ -2176,19 +3526,16 @@ double Infer::output_copy_number_segments(OnePeriod &best_period_obj,
                              no_of_copy_nos_bf_1st_peak;
             int major_allele_cp = best_maf_peak_index + (1 + cp) / 2;
 
-            outf << chr_integer << "\t"
-                 << (long)(start + CHR_ACU[chr_integer - 1]) << "\t"
-                 << (long)(end + CHR_ACU[chr_integer - 1]) << "\t"
-                 << cp << "\t"
-                 << major_allele_cp << "\t"
-                 << cp_float << "\t"
-                 << oneSegment.stddev << "\t"
-                 << pow(10, oneSegmentSNPs.maf_mean) << "\t"
-                 << oneSegmentSNPs.maf_stddev << "\t"
-                 << pow(10, maf_expected_vector[best_maf_peak_index]) << "\t"
-                 << start << "\t"
-                 << end
-                 << endl;
+            outf.write("{}\t{}\t{}\t{}\t{}\t{:g}\t{:g}\t{:g}\t{:g}\t{:g}\t{}\t{}\n", chr_integer,
+                       (long)(start + CHR_ACU[chr_integer - 1]), (long)(end + CHR_ACU[chr_integer - 1]), cp,
+                       major_allele_cp, cp_float, oneSegment.stddev, pow(10, oneSegmentSNPs.maf_mean),
+                       oneSegmentSNPs.maf_stddev, pow(10, maf_expected_vector[best_maf_peak_index]), start, end);
+            InferCNSegment cn_segment = {chr_integer, start, end, (long)(start + CHR_ACU[chr_integer - 1]),
+                                         (long)(end + CHR_ACU[chr_integer - 1]), (double) cp, major_allele_cp,
+                                         cp_float, oneSegment.stddev, pow(10, oneSegmentSNPs.maf_mean),
+                                         oneSegmentSNPs.maf_stddev,
+                                         pow(10, maf_expected_vector[best_maf_peak_index])};
+            _result->cn_segments.push_back(cn_segment);
         }  // each segment
     }      // each rc peak
     // subclonal regions. float copy number
@@ -2223,79 +3570,46 @@ double Infer::output_copy_number_segments(OnePeriod &best_period_obj,
             int interval_right_int = (int)interval_right;
             if (interval_right_int - interval_left_int != 1)  // covers no integer or more than one integer
             {
-                outf << chr_integer << "\t"
-                     << (long)(start + CHR_ACU[chr_integer - 1]) << "\t"
-                     << (long)(end + CHR_ACU[chr_integer - 1]) << "\t"
-                     << cp_float << "\t"
-                     << "NA" << "\t"
-                     << "NA" << "\t"
-                     << oneSegment.stddev * _segment_stddev_divider << "\t"
-                     << "NA" << "\t"
-                     << "NA" << "\t"
-                     << "NA" << "\t" << start << "\t" << end NewLineMACRO;
+                outf.write("{}\t{}\t{}\t{:g}\tNA\tNA\t{:g}\tNA\tNA\tNA\t{}\t{}\n", chr_integer,
+                           (long)(start + CHR_ACU[chr_integer - 1]), (long)(end + CHR_ACU[chr_integer - 1]),
+                           cp_float, oneSegment.stddev * _segment_stddev_divider, start, end);
+                InferCNSegment cn_segment = {chr_integer, start, end, (long)(start + CHR_ACU[chr_integer - 1]),
+                                             (long)(end + CHR_ACU[chr_integer - 1]), cp_float, -1, cp_float,
+                                             oneSegment.stddev * _segment_stddev_divider, NAN, NAN, NAN};
+                _result->cn_segments.push_back(cn_segment);
                 if (_debug > 0)
                 {
-                    out_interval << chr_integer << "\t"
-                                 << start << "\t"
-                                 << end << "\t"
-                                 << cp_float << "\t"
-                                 << cp_float << "\t"
-                                 << cp_stddev << "\t"
-                                 << interval_left << "\t"
-                                 << interval_right << "\t"
-                                 << oneSegment.stddev * _segment_stddev_divider << "\t"
-                                 << oneSegment.no_of_windows NewLineMACRO;
+                    out_interval.write("{}\t{}\t{}\t{:g}\t{:g}\t{:g}\t{:g}\t{:g}\t{:g}\t{}\n", chr_integer, start,
+                                       end, cp_float, cp_float, cp_stddev, interval_left, interval_right,
+                                       oneSegment.stddev * _segment_stddev_divider, oneSegment.no_of_windows);
                 }
             }
             else  // covers one integer
             {
                 int cp =
                         int(cp_float) + (cp_float - int(cp_float) > 0.5 ? 1 : 0);
-                outf << chr_integer << "\t"
-                     << (long)(start + CHR_ACU[chr_integer - 1]) << "\t"
-                     << (long)(end + CHR_ACU[chr_integer - 1]) << "\t"
-                     << cp << "\t"
-                     << "NA" << "\t"
-                     << cp_float << "\t"
-                     << oneSegment.stddev * _segment_stddev_divider << "\t"
-                     << "NA" << "\t"
-                     << "NA" << "\t"
-                     << "NA" << "\t" << start << "\t" << end NewLineMACRO;
+                outf.write("{}\t{}\t{}\t{}\tNA\t{:g}\t{:g}\tNA\tNA\tNA\t{}\t{}\n", chr_integer,
+                           (long)(start + CHR_ACU[chr_integer - 1]), (long)(end + CHR_ACU[chr_integer - 1]), cp,
+                           cp_float, oneSegment.stddev * _segment_stddev_divider, start, end);
+                InferCNSegment cn_segment = {chr_integer, start, end, (long)(start + CHR_ACU[chr_integer - 1]),
+                                             (long)(end + CHR_ACU[chr_integer - 1]), (double) cp, -1, cp_float,
+                                             oneSegment.stddev * _segment_stddev_divider, NAN, NAN, NAN};
+                _result->cn_segments.push_back(cn_segment);
                 if (_debug > 0)
                 {
-                    out_interval << chr_integer << "\t"
-                                 << start << "\t"
-                                 << end << "\t"
-                                 << cp << "\t"
-                                 << cp_float << "\t"
-                                 << cp_stddev << "\t"
-                                 << interval_left << "\t"
-                                 << interval_right << "\t"
-                                 << oneSegment.stddev*_segment_stddev_divider<< "\t"
-                                 << oneSegment.no_of_windows NewLineMACRO;
+                    out_interval.write("{}\t{}\t{}\t{}\t{:g}\t{:g}\t{:g}\t{:g}\t{:g}\t{}\n", chr_integer, start, end,
+                                       cp, cp_float, cp_stddev, interval_left, interval_right,
+                                       oneSegment.stddev * _segment_stddev_divider, oneSegment.no_of_windows);
                 }
             }
         }
     }
     _ploidy_cnv_all = cp_number_multi_len/_genome_len_cnv_all;
     _ploidy_clonal = cp_number_multi_len_clonal/_genome_len_clonal;
-    outf << "#genome_len_cnv_all=" << _genome_len_cnv_all << endl;
-    outf << "#genome_len_clonal=" << _genome_len_clonal << endl;
-    outf << "#ploidy_cnv_all=" << _ploidy_cnv_all << endl;
-    outf << "#ploidy_clonal=" << _ploidy_clonal << endl;
+    outf.write("#genome_len_cnv_all={}\n#genome_len_clonal={}\n#ploidy_cnv_all={:g}\n#ploidy_clonal={:g}\n",
+               _genome_len_cnv_all, _genome_len_clonal, _ploidy_cnv_all, _ploidy_clonal);
     outf.close();
     out_interval.close();
-    cerr << "CNV output done. ploidy_cnv_all=" << _ploidy_cnv_all << " ploidy_clonal=" << _ploidy_clonal << "\n";
+    _log << "CNV output done. ploidy_cnv_all=" << _ploidy_cnv_all << " ploidy_clonal=" << _ploidy_clonal << "\n";
     return _ploidy_clonal;
 }
-
-int main(int argc, char **argv)
-{
-    Infer infInstance(argv[1], argv[2], argv[3], argv[4],
-                      atof(argv[5]),
-                      atoi(argv[6]), atof(argv[7]),
-                      atoi(argv[8]),
-                      atoi(argv[9]), atoi(argv[10]));
-    int returnCode = infInstance.run();
-    exit(returnCode);
-}
@@ -2,12 +2,28 @@
 #ifndef __INFER_H
 #define __INFER_H
 
+#include <cerrno>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <deque>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 #include <gsl/gsl_cdf.h>
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/iostreams/copy.hpp>
@@ -15,11 +31,15 @@
 #include <boost/iostreams/device/file_descriptor.hpp>
 
 #include "BaseGADA.h"
+#include "GADASegmentation.h"
 #include "read_para.h"
+#include "trace.h"
 #include "prob.h"
 
 using namespace std;
 
+namespace boost { namespace program_options { class options_description; } }
+
 inline bool larger(double a, double b) {
     return a > b;
 }
@@ -197,20 +217,330 @@ class OnePeriod {
 
 
 
+//2026.10.18 one data line of a GADA segment file, plus its SNP statistics once prepared
+struct SegmentRecord
+{
+    string chr_string;
+    int start;
+    int end;
+    float read_count_ratio;
+    float ratio_stddev;
+    int no_of_valid_windows;
+    OneSegmentSNPs segment_snps;  // set by Infer::prepareSegmentRecords()
+    int no_of_snps_used;
+};
+
+//2026.10.18 one data line of a heterozygous SNP file
+struct SNPRecord
+{
+    string chr_string;
+    int pos;
+    float maf;
+    int coverage;
+};
+
+//2026.10.18 inputs of inferPurityPloidy(). A non-empty span is used instead of the file path next to it.
+// Segment spans need the first six fields of each SegmentRecord, the rest is filled in by Infer.
+struct InferInput
+{
+    string segment_data_input_path;  // as argv[2] of infer: a file, a comma-separated list or a directory
+    string snp_data_input_path;
+    const SegmentRecord *segments = NULL;
+    size_t no_of_segments = 0;
+    const SNPRecord *snps = NULL;
+    size_t no_of_snps = 0;
+    bool segments_prepared = false;  // segments carry their SNP statistics, as from loadInferInput()
+};
+
+//2026.10.18 memo of Infer::adjust_maf_expect(), which dominates the SNP likelihoods. Runs sharing one, e.g. the
+// same sample with other parameters, reuse each other's values. Thread-safe.
+class AdjustedMafCache
+{
+   public:
+    typedef std::tuple<double, double, double, int> Key;  // maf_expected, coverage mean, coverage var, coverage min
+    AdjustedMafCache() : no_of_hits(0), no_of_misses(0) {}
+    bool find(const Key &key, double &maf_adjusted) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<Key, double>::const_iterator it = _map.find(key);
+        if (it == _map.end()) {
+            no_of_misses++;
+            return false;
+        }
+        no_of_hits++;
+        maf_adjusted = it->second;
+        return true;
+    }
+    void insert(const Key &key, double maf_adjusted) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _map[key] = maf_adjusted;
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _map.size();
+    }
+    size_t bytes() {
+        return size() * (sizeof(Key) + sizeof(double) + 4 * sizeof(void *));  // map nodes
+    }
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _map.clear();
+    }
+    std::atomic<long> no_of_hits;
+    std::atomic<long> no_of_misses;
+
+   private:
+    std::mutex _mutex;
+    std::map<Key, double> _map;
+};
+
+struct InferOptions
+{
+    string config_file_path;  // optional, not read if empty
+    string output_dir;  // where artifacts go if write_artifacts
+    bool write_artifacts = false;  // infer.out.tsv, cnv.output.tsv and, with debug>0, the diagnostic files
+    ostream *log = NULL;  // progress messages, NULL for none
+    float segment_stddev_divider = 20;
+    int snp_coverage_min = 2;
+    float snp_coverage_var_vs_mean_ratio = 10;
+    int no_of_peaks_for_logL = 3;
+    int debug = 0;
+    int auto_ = 1;
+    int segmentation_engine = kEngineSBL;
+    int segment_stream_timeout = 0;
+    long segment_min_len = 50;
+    double segment_t_score = 20;
+    int no_of_reader_threads = 0;  // threads reading segment files, 0 for one per core
+    AdjustedMafCache *maf_cache = NULL;  // optional, shared by runs
+    string cache_dir;  // optional, derived structures of earlier runs on the same files, see Infer::readSegmentCache()
+};
+
+//outcome of a run, InferResult::status
+enum InferStatus {
+    kInferSolved = 0,
+    kInferTooNoisy = 1,  // CNV profile too noisy (auto_=0)
+    kInferNotEnoughCNV = 2,  // not enough copy number variation (auto_=0)
+    kInferNoCandidatePeriod = 3,
+    kInferNoSolution = 4,  // no period with logL>0 and purity>0, or its purity/ploidy out of range
+    kInferError = 5  // bad options or unreadable input, see InferResult::message
+};
+inline const char *inferStatusName(int status){
+    switch (status) {
+        case kInferSolved: return "solved";
+        case kInferTooNoisy: return "too_noisy";
+        case kInferNotEnoughCNV: return "not_enough_cnv";
+        case kInferNoCandidatePeriod: return "no_candidate_period";
+        case kInferNoSolution: return "no_solution";
+        default: return "error";
+    }
+}
+
+//one row of the logL table, a candidate period
+struct InferLogLRow
+{
+    int period_int;
+    double logL;
+    double logL_rc;
+    double logL_rc_penalty;
+    double best_logL_snp;
+    double best_lod_snp;
+    double best_logL_snp_penalty;
+    double best_logL_snp_no_of_parameters;
+    int best_no_of_copy_nos_bf_1st_peak;
+    int first_peak_int;
+    double best_purity;
+    double best_ploidy;
+};
+
+//one line of cnv.output.tsv. Sub-clonal segments have major_allele_cp -1 and NaN MAF columns, where the file has NA.
+struct InferCNSegment
+{
+    int chr;
+    int start;
+    int end;
+    long cumu_start;
+    long cumu_end;
+    double cp;  // integer unless the segment is sub-clonal and its interval covers no or several integers
+    int major_allele_cp;
+    double copy_no_float;
+    double stddev;
+    double maf_mean;
+    double maf_stddev;
+    double maf_expected;
+};
+
+struct InferResult
+{
+    int status = kInferError;
+    string message;
+    double purity = -1;
+    double ploidy = -1;
+    double purity_naive = -1;
+    double ploidy_naive = -1;
+    double rc_ratio_of_cp_2 = -1;
+    double Q = -1;  // rc_ratio_of_cp_2_corrected, read count ratio (X1000) of copy number 2
+    double logL = 0;
+    int period_int = -1;
+    int best_no_of_copy_nos_bf_1st_peak = -1;
+    int first_peak_int = -1;
+    double ploidy_cnv_all = -1;
+    double ploidy_clonal = -1;
+    int no_of_segments = 0;
+    int no_of_segments_used = 0;
+    int no_of_snps = 0;
+    int no_of_snps_used = 0;
+    vector<InferLogLRow> logL_table;
+    vector<InferCNSegment> cn_segments;
+};
+
+//2026.10.18 runs inference on one sample. Nothing is written unless options.write_artifacts, no state is
+// shared with other calls, so samples may run concurrently in one process. Returns 0 if the run completed
+// (result.status tells whether purity and ploidy were found), 3 on an error (result.message).
+int inferPurityPloidy(const InferInput &input, const InferOptions &options, InferResult &result);
+//2026.10.18 reads the files of input (the parts a run would read) into SNP and prepared segment records, which
+// can be handed to any number of runs as spans with segments_prepared set. Same return values as above.
+int loadInferInput(const InferInput &input, const InferOptions &options, vector<SNPRecord> &snp_vec,
+                   vector<SegmentRecord> &segment_vec, InferResult &result);
+//2026.10.18 path, size and modification time of each input file of input (the SNP file, then the resolved
+// segment files), one per line. Differs once any of them is rewritten, so it can key parsed inputs in memory.
+string inferInputStamp(const InferInput &input);
+//2026.10.18 the infer parameters of the command line drivers (infer_batch, infer_server, ...), named as the
+// options of main.py. --config goes to options.config_file_path, --segmentation_engine to engine_name until
+// finishInferOptions(). with_scoring_options false leaves out segment_stddev_divider, snp_coverage_min,
+// snp_coverage_var_vs_mean_ratio and max_no_of_peaks_for_logL, for drivers that take lists of them.
+void addInferOptions(boost::program_options::options_description &option_description, InferOptions &options,
+                     string &engine_name, bool with_scoring_options = true);
+//sets options.segmentation_engine from engine_name and checks the configure file. Returns false, with the reason
+// in error_message, if either is invalid.
+bool finishInferOptions(const string &engine_name, InferOptions &options, string &error_message);
+//sets one of the parameters above from a name=value pair of a manifest line or a request. Returns 1 if name is
+// not one of them, 2 (with the reason in error_message) if value is not valid for it, 0 once set.
+int setInferOption(InferOptions &options, const string &name, const string &value, string &error_message);
+
+//2026.10.18 bootstrap of one sample: runs on the segments resampled with replacement (with their SNP statistics)
+struct BootstrapOptions
+{
+    int no_of_replicates = 200;
+    int no_of_threads = 0;  // replicates run at the same time, 0 for one per core
+    unsigned int seed = 1;  // replicate i draws from seed+i, so the intervals do not depend on the threads
+    double confidence = 0.95;  // of the percentile intervals
+};
+struct BootstrapReplicate
+{
+    int status;
+    double purity;
+    double ploidy;
+    double Q;
+};
+//percentile interval over the solved replicates, -1 if there are none
+struct BootstrapInterval
+{
+    double lower = -1;
+    double upper = -1;
+};
+struct BootstrapResult
+{
+    InferResult point;  // the run on all segments, as inferPurityPloidy()
+    vector<BootstrapReplicate> replicate_vec;
+    int no_of_replicates_solved = 0;
+    BootstrapInterval purity;
+    BootstrapInterval ploidy;
+    BootstrapInterval Q;
+};
+//Reads input once (unless its segments are prepared), runs the point estimate with options, then the replicates
+// in parallel without artifacts, logs or SNPs (prepared segments carry their SNP statistics), so each replicate
+// only rebuilds the histograms and likelihoods. Same return values as inferPurityPloidy(), for the point estimate.
+int bootstrapPurityPloidy(const InferInput &input, const InferOptions &options,
+                          const BootstrapOptions &bootstrap_options, BootstrapResult &result);
+
+//2026.10.18 parameter sweep of one sample. An empty axis keeps the value of the options.
+struct SweepGrid
+{
+    vector<float> segment_stddev_divider_vec;
+    vector<int> snp_coverage_min_vec;
+    vector<float> snp_coverage_var_vs_mean_ratio_vec;
+    vector<int> no_of_peaks_for_logL_vec;
+    int no_of_threads = 0;  // 0 for one per core
+};
+struct SweepPoint
+{
+    float segment_stddev_divider;
+    int snp_coverage_min;
+    float snp_coverage_var_vs_mean_ratio;
+    int no_of_peaks_for_logL;
+    InferResult result;
+};
+//Runs every combination of the grid (point_vec, in the order of the axes above) on one load of input, in
+// parallel without artifacts or logs. The segments are folded into the ratio histogram and the periods detected
+// once per segment_stddev_divider, the other parameters only redo the likelihoods and copy numbers. Returns 0 if
+// all points ran (each result.status tells the outcome), 3 if input could not be read or a point failed.
+int sweepPurityPloidy(const InferInput &input, const InferOptions &options, const SweepGrid &grid,
+                      vector<SweepPoint> &point_vec);
+
+//2026.10.18 preview of one sample from two disjoint stratified subsamples
+struct PreviewOptions
+{
+    double snp_fraction = 0.1;  // SNPs of each chromosome in each subsample, evenly spaced in file order
+    size_t min_no_of_snps = 20000;  // per subsample, a larger fraction is taken from smaller samples
+    double segment_fraction = 0.5;  // segments in each subsample, evenly spaced in the order of window counts
+    double purity_tolerance = 0.05;  // the subsamples agree if their purities differ by at most this
+    double ploidy_tolerance = 0.2;  // and their ploidies by at most this
+};
+struct PreviewResult
+{
+    InferResult subsample_result_array[2];
+    size_t no_of_snps_per_subsample = 0;
+    size_t no_of_segments_per_subsample = 0;
+    double purity = -1;  // mean of the subsamples, -1 unless both are solved
+    double ploidy = -1;
+    double purity_difference = -1;
+    double ploidy_difference = -1;
+    bool stable = false;  // both solved and within the tolerances
+};
+//Reads input without the SNP statistics of the segments, draws two disjoint subsamples (SNPs stratified by
+// chromosome, segments by window count) and runs each through inferPurityPloidy(), the two in parallel, without
+// artifacts or logs. Same return values as inferPurityPloidy(), 3 if input could not be read.
+int previewPurityPloidy(const InferInput &input, const InferOptions &options, const PreviewOptions &preview_options,
+                        PreviewResult &result);
+
 class Infer {
    public:
-    Infer(string configFilepath, string segment_data_input_path,
-          string snp_data_input_path, string output_dir,
-          float segment_stddev_divider,
-          int snp_coverage_min, float snp_coverage_var_vs_mean_ratio,
-          int no_of_peaks_for_logL,
-          int debug, int auto_);
+    Infer(const InferOptions &options);
     ~Infer();
-    int run();
+    int run(const InferInput &input, InferResult &result);
+    int load(const InferInput &input, vector<SNPRecord> &snp_vec, vector<SegmentRecord> &segment_vec,
+             InferResult &result, bool prepare_segments = true);
+    int sweep(const InferInput &input, SweepPoint *points, size_t no_of_points);
 
    private:
-    int getSNPDataFromFile(string inputFname);
-    int getSegmentDataFromFile(string inputFname);
+    int runPhases(const InferInput &input);
+    int checkParameters();
+    int detectCandidatePeriods(const InferInput &input, vector<OnePeriod> &candidate_period_vec);
+    int selectPeriodByLogL(vector<OnePeriod> &candidate_period_vec);
+    void recordMemory(const string &checkpoint_name,
+                      const RunProfile::StructureBytes &transient_vec = RunProfile::StructureBytes());
+    int setError(const string &message);
+    int getSNPDataFromFile(string inputFname, vector<SNPRecord> *snp_record_vec = NULL);
+    int getSNPDataFromRecords(const SNPRecord *snps, size_t no_of_snps);
+    void addSNP(string chr_string, int pos, float maf, int coverage);
+    int getSegmentDataFromFile(string input_path);
+    int readSegmentFiles(string input_path, vector<vector<SegmentRecord> > &record_vec_by_file);
+    int getSegmentDataFromRecords(const SegmentRecord *segments, size_t no_of_segments, bool segments_prepared);
+    void foldSegmentFiles(const vector<vector<SegmentRecord> > &record_vec_by_file, bool smooth = true);
+    bool segmentCacheKey(const InferInput &input, uint64_t &key);
+    bool readSegmentCache(uint64_t key, vector<SegmentRecord> &segment_vec);
+    void writeSegmentCache(uint64_t key, const vector<vector<SegmentRecord> > &record_vec_by_file);
+    uint64_t histogramCacheKey(uint64_t segment_cache_key);
+    bool readHistogramCache(uint64_t key);
+    void writeHistogramCache(uint64_t key);
+    bool streamSegmentFiles(string input_path, vector<string> &path_vec,
+                            vector<vector<SegmentRecord> > &record_vec_by_file);
+    bool readAndPrepareSegmentFile(const string &input_file_path, vector<SegmentRecord> &record_vec,
+                                   string &status_msg);
+    bool readAndPrepareSegmentFileNoThrow(const string &input_file_path, vector<SegmentRecord> &record_vec,
+                                          string &status_msg);
+    bool segmentRatioTrack(const string &input_file_path, vector<SegmentRecord> &record_vec, string &status_msg);
+    void prepareSegmentRecords(vector<SegmentRecord> &record_vec);
+    void foldSegmentRecords(const vector<SegmentRecord> &record_vec, int **noOfWindowsByRatioAndChr, bool smooth);
     int output_segment_ratio(int **noOfWindowsByRatioAndChr);
     int output_snp_maf_by_segment();
     int output_snp_maf_by_peak(vector<OnePeak> &peak_obj_vector);
@@ -258,9 +588,10 @@ class Infer {
                                     vector<OnePeak> &peak_obj_vector);
     void recalibrate_Q_and_purity_based_on_cnv_ploidy(OnePeriod &best_period_obj);
     string _configFilepath;
-    string _segment_data_input_path;
-    string _snp_data_input_path;
     string _output_dir;
+    bool _write_artifacts;
+    ostream _log;  // InferOptions::log's buffer, or none: writes are dropped
+    InferResult *_result;  // of the current run()
     float _segment_stddev_divider;
     int _no_of_peaks_for_logL;
     float _snp_maf_stddev_divider;
@@ -269,12 +600,21 @@ class Infer {
     float _snp_coverage_var_vs_mean_ratio;
     int _debug;
     int _auto;
+    int _segmentation_engine;  // kEngineSBL or kEnginePELT for infer_candidate_period_by_GADA()
+    int _segment_stream_timeout;  // >0: take segment files as they are completed, fail after this many idle seconds
+    long _segment_min_len;  // GADA -M for ratio tracks segmented in-process
+    double _segment_t_score;  // GADA -T for ratio tracks segmented in-process
+    int _no_of_reader_threads;
+    AdjustedMafCache *_maf_cache;
+    string _cache_dir;
+    bool _prepare_segments;  // false: load() leaves the SNP statistics of the segments to the runs
+    RunProfile _profile;  // written to infer.profile.json
     int _returnCode;
 
     Config _config;
 
     Prob _probInstance;
-    vector<vector<OneSNP> > _SNPs;                   // indexed by chromosomes
+    vector<ChrSNPStore> _SNPs;                   // indexed by chromosomes
     vector<vector<OneSegment> > _rc_ratio_segments;  // vector of segments at
                                                      // each
     // rc_ratio (high-resolution)
@@ -305,13 +645,7 @@ class Infer {
     ofstream _infer_outf;
     ofstream _infer_details_outf;
 
-    ofstream _rc_logL_outf;
-    ofstream _snp_maf_exp_vs_adj_outf;
-    ofstream _snp_logL_outf;
-    ofstream _sub_outf;
-    ofstream _sub_peak_outf;
-
-    std::ofstream rc_ratio_by_chr_out_file;
+    Tracer _tracer;  // rc_logLikelihood.log.tsv, snp_maf_exp_vs_adj.tsv and snp_logL.log.tsv
 
     double _pool_hist[MAX_RATIO_HIGH_RES + 1];
     int _half_period_int;
@@ -0,0 +1,219 @@
+/*
+ * 2026.10.18 infer_batch: runs infer on a cohort in one process. Samples are listed in a manifest and
+ * processed by a fixed pool of worker threads, one sample per worker at a time, so memory is bounded by
+ * the pool size. Each sample writes the usual infer outputs (plus infer.log) to its own output folder, and
+ * one summary line per sample goes to the cohort summary table, in manifest order.
+ */
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sys/stat.h>
+#include <boost/program_options.hpp>
+#include "infer.h"
+using namespace std;
+namespace po = boost::program_options;
+
+//one manifest line
+struct CohortSample
+{
+    string sample_id;
+    InferInput input;
+    InferOptions options;
+};
+
+//reads the manifest: tab-separated, '#' starts a comment line, the first other line is the header.
+// Columns sample_id, segments, snps and output_dir are required. Optional parameter columns (same names
+// as the options of main.py, see setInferOption()) override default_options for that sample; empty or NA cells
+// keep the default, other columns are ignored.
+static bool read_manifest(const string &manifest_path, const InferOptions &default_options,
+                          vector<CohortSample> &sample_vec, string &error_message)
+{
+    ifstream manifest_file(manifest_path.c_str());
+    if (!manifest_file)
+    {
+        error_message = fmt::format("could not open manifest {}.", manifest_path);
+        return false;
+    }
+    vector<string> column_vec;
+    string line;
+    int line_no = 0;
+    while (std::getline(manifest_file, line))
+    {
+        line_no++;
+        if (line.empty() || line[0] == '#')
+            continue;
+        vector<string> element_vec;
+        boost::split(element_vec, line, boost::is_any_of("\t"));
+        if (column_vec.empty())
+        {
+            column_vec = element_vec;
+            for (const char *required_column : {"sample_id", "segments", "snps", "output_dir"})
+            {
+                if (std::find(column_vec.begin(), column_vec.end(), required_column) == column_vec.end())
+                {
+                    error_message = fmt::format("manifest {} has no {} column.", manifest_path, required_column);
+                    return false;
+                }
+            }
+            continue;
+        }
+        if (element_vec.size() != column_vec.size())
+        {
+            error_message = fmt::format("line {} of manifest {} has {} columns, the header {}.", line_no,
+                                        manifest_path, element_vec.size(), column_vec.size());
+            return false;
+        }
+        CohortSample sample;
+        sample.options = default_options;
+        for (size_t i = 0; i < column_vec.size(); i++)
+        {
+            const string &column = column_vec[i];
+            const string &value = element_vec[i];
+            if (value.empty() || value == "NA")
+                continue;
+            if (column == "sample_id")
+                sample.sample_id = value;
+            else if (column == "segments")
+                sample.input.segment_data_input_path = value;
+            else if (column == "snps")
+                sample.input.snp_data_input_path = value;
+            else if (column == "output_dir")
+                sample.options.output_dir = value;
+            else if (setInferOption(sample.options, column, value, error_message) == 2)
+            {
+                error_message = fmt::format("line {} of manifest {}: {}", line_no, manifest_path, error_message);
+                return false;
+            }
+        }
+        if (sample.sample_id.empty() || sample.input.segment_data_input_path.empty() ||
+            sample.input.snp_data_input_path.empty() || sample.options.output_dir.empty())
+        {
+            error_message = fmt::format("line {} of manifest {} misses a required value.", line_no, manifest_path);
+            return false;
+        }
+        sample_vec.push_back(sample);
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    string manifest_path, summary_file_path;
+    int no_of_threads, debug;
+    InferOptions default_options;
+    string engine_name;
+    po::options_description option_description("infer_batch options");
+    option_description.add_options()("help,h", "produce help message")
+            ("manifest,i", po::value<string>(&manifest_path),
+             "tab-separated sample list with a header. Required columns: sample_id, segments (as argv[2] of "
+                     "infer), snps (het SNP file), output_dir. Optional columns override the defaults below "
+                     "per sample: segment_stddev_divider, snp_coverage_min, snp_coverage_var_vs_mean_ratio, "
+                     "max_no_of_peaks_for_logL, auto, segmentation_engine, min_segment_len, t_score_threshold.")
+            ("summary,o", po::value<string>(&summary_file_path), "cohort summary table, one line per sample")
+            ("threads,t", po::value<int>(&no_of_threads)->default_value(0),
+             "samples processed at the same time, 0 for one per core. Each one holds its segments and "
+                     "SNPs in memory.")
+            ("cache_dir", po::value<string>(&default_options.cache_dir)->default_value(""),
+             "folder caching the prepared segments and ratio histograms of earlier runs on the same files")
+            ("debug", po::value<int>(&debug)->default_value(0), "as argv[9] of infer");
+    addInferOptions(option_description, default_options, engine_name);
+    po::variables_map option_variable_map;
+    po::store(po::parse_command_line(argc, argv, option_description), option_variable_map);
+    po::notify(option_variable_map);
+    if (option_variable_map.count("help") || manifest_path.empty() || summary_file_path.empty())
+    {
+        cout << "Usage:" << endl << argv[0] << " -i MANIFEST -o SUMMARY [OPTIONS]" << endl << endl;
+        cout << option_description << endl;
+        exit(1);
+    }
+    string error_message;
+    if (!finishInferOptions(engine_name, default_options, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+    default_options.write_artifacts = true;
+    default_options.debug = debug;
+    //the pool already keeps every core busy
+    default_options.no_of_reader_threads = 1;
+
+    vector<CohortSample> sample_vec;
+    if (!read_manifest(manifest_path, default_options, sample_vec, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+    ofstream summary_file(summary_file_path.c_str());
+    if (!summary_file)
+    {
+        cerr << fmt::format("ERROR: could not write {}.\n", summary_file_path);
+        exit(3);
+    }
+    if (no_of_threads <= 0)
+        no_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    no_of_threads = std::min<int>(no_of_threads, sample_vec.size());
+    cerr << fmt::format("{} samples, {} worker threads.\n", sample_vec.size(), no_of_threads);
+
+    vector<InferResult> result_vec(sample_vec.size());
+    vector<int> return_code_vec(sample_vec.size(), 0);
+    vector<double> seconds_vec(sample_vec.size(), 0);
+    std::atomic<size_t> next_sample_index(0);
+    std::atomic<size_t> no_of_samples_done(0);
+    std::mutex progress_mutex;
+    auto run_samples = [&]() {
+        for (size_t sample_index = next_sample_index++; sample_index < sample_vec.size();
+             sample_index = next_sample_index++)
+        {
+            CohortSample &sample = sample_vec[sample_index];
+            std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+            mkdir(sample.options.output_dir.c_str(), 0755);
+            ofstream log_file(fmt::format("{}/infer.log", sample.options.output_dir).c_str());
+            sample.options.log = &log_file;
+            return_code_vec[sample_index] = inferPurityPloidy(sample.input, sample.options, result_vec[sample_index]);
+            seconds_vec[sample_index] = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start_time).count();
+            const InferResult &result = result_vec[sample_index];
+            std::lock_guard<std::mutex> progress_lock(progress_mutex);
+            cerr << fmt::format("[{}/{}] {}: {} purity={} ploidy={} ({:.1f}s){}\n", ++no_of_samples_done,
+                                sample_vec.size(), sample.sample_id, inferStatusName(result.status),
+                                result.purity, result.ploidy, seconds_vec[sample_index],
+                                result.message.empty() ? string() : " " + result.message);
+        }
+    };
+    vector<std::thread> thread_vec;
+    for (int thread_index = 1; thread_index < no_of_threads; thread_index++)
+        thread_vec.push_back(std::thread(run_samples));
+    run_samples();
+    for (std::thread &worker_thread : thread_vec)
+        worker_thread.join();
+
+    summary_file << "sample_id\tstatus\tpurity\tploidy\tpurity_naive\tploidy_naive\tQ\tlogL\tperiod\t"
+                 << "ploidy_cnv_all\tploidy_clonal\tno_of_segments\tno_of_segments_used\tno_of_snps\t"
+                 << "no_of_snps_used\tseconds\tmessage" << endl;
+    int return_code = 0;
+    for (size_t sample_index = 0; sample_index < sample_vec.size(); sample_index++)
+    {
+        const InferResult &result = result_vec[sample_index];
+        summary_file << setprecision(5) << sample_vec[sample_index].sample_id << "\t"
+                     << inferStatusName(result.status) << "\t"
+                     << result.purity << "\t"
+                     << result.ploidy << "\t"
+                     << result.purity_naive << "\t"
+                     << result.ploidy_naive << "\t"
+                     << result.Q << "\t"
+                     << result.logL << "\t"
+                     << result.period_int << "\t"
+                     << result.ploidy_cnv_all << "\t"
+                     << result.ploidy_clonal << "\t"
+                     << result.no_of_segments << "\t"
+                     << result.no_of_segments_used << "\t"
+                     << result.no_of_snps << "\t"
+                     << result.no_of_snps_used << "\t"
+                     << seconds_vec[sample_index] << "\t"
+                     << result.message << endl;
+        if (return_code_vec[sample_index] != 0)
+            return_code = return_code_vec[sample_index];
+    }
+    summary_file.close();
+    exit(return_code);
+}
@@ -0,0 +1,99 @@
+/*
+ * 2026.10.18 infer_bootstrap: confidence intervals of purity and ploidy for one sample. The segments (and
+ * their SNPs) are read once, then infer is re-run on replicates that resample the segments with replacement,
+ * in parallel. Writes bootstrap.tsv (one line per replicate) and bootstrap.ci.tsv (estimates and percentile
+ * intervals) to the output folder. Replicates are seeded by their index, so the output does not depend on
+ * the number of threads.
+ */
+#include <chrono>
+#include <sys/stat.h>
+#include <boost/program_options.hpp>
+#include "infer.h"
+using namespace std;
+namespace po = boost::program_options;
+
+int main(int argc, char **argv)
+{
+    string output_dir, engine_name;
+    InferInput input;
+    InferOptions options;
+    BootstrapOptions bootstrap_options;
+    po::options_description option_description("infer_bootstrap options");
+    option_description.add_options()("help,h", "produce help message")
+            ("segments,i", po::value<string>(&input.segment_data_input_path), "as argv[2] of infer")
+            ("snps", po::value<string>(&input.snp_data_input_path), "het SNP file")
+            ("output_dir,o", po::value<string>(&output_dir), "output folder")
+            ("replicates,B", po::value<int>(&bootstrap_options.no_of_replicates)->default_value(200),
+             "number of bootstrap replicates")
+            ("threads,t", po::value<int>(&bootstrap_options.no_of_threads)->default_value(0),
+             "replicates run at the same time, 0 for one per core")
+            ("seed", po::value<unsigned int>(&bootstrap_options.seed)->default_value(1))
+            ("confidence", po::value<double>(&bootstrap_options.confidence)->default_value(0.95),
+             "coverage of the percentile intervals");
+    addInferOptions(option_description, options, engine_name);
+    po::variables_map option_variable_map;
+    po::store(po::parse_command_line(argc, argv, option_description), option_variable_map);
+    po::notify(option_variable_map);
+    if (option_variable_map.count("help") || input.segment_data_input_path.empty() ||
+        input.snp_data_input_path.empty() || output_dir.empty())
+    {
+        cout << "Usage:" << endl << argv[0] << " -i SEGMENTS --snps SNPS -o OUTPUT_DIR [OPTIONS]" << endl << endl;
+        cout << option_description << endl;
+        exit(1);
+    }
+    if (bootstrap_options.confidence <= 0 || bootstrap_options.confidence >= 1)
+    {
+        cerr << fmt::format("ERROR: confidence {} is not between 0 and 1.\n", bootstrap_options.confidence);
+        exit(3);
+    }
+    string error_message;
+    if (!finishInferOptions(engine_name, options, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+    mkdir(output_dir.c_str(), 0755);
+    //the point estimate writes no artifacts, infer itself does that
+    options.output_dir = output_dir;
+    options.write_artifacts = false;
+    options.log = &cerr;
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    BootstrapResult result;
+    int return_code = bootstrapPurityPloidy(input, options, bootstrap_options, result);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    if (return_code != 0)
+    {
+        cerr << fmt::format("ERROR: {} {}\n", inferStatusName(result.point.status), result.point.message);
+        exit(return_code);
+    }
+    cerr << fmt::format("{} of {} replicates solved in {:.1f}s.\n", result.no_of_replicates_solved,
+                        result.replicate_vec.size(), seconds);
+
+    RowWriter replicate_writer;
+    replicate_writer.open(fmt::format("{}/bootstrap.tsv", output_dir));
+    replicate_writer.write("replicate\tstatus\tpurity\tploidy\tQ\n");
+    for (size_t replicate_index = 0; replicate_index < result.replicate_vec.size(); replicate_index++)
+    {
+        const BootstrapReplicate &replicate = result.replicate_vec[replicate_index];
+        replicate_writer.write("{}\t{}\t{:.5g}\t{:.5g}\t{:.5g}\n", replicate_index, inferStatusName(replicate.status),
+                               replicate.purity, replicate.ploidy, replicate.Q);
+    }
+    RowWriter interval_writer;
+    interval_writer.open(fmt::format("{}/bootstrap.ci.tsv", output_dir));
+    interval_writer.write("parameter\testimate\tlower\tupper\tconfidence\tno_of_replicates_solved\n");
+    const std::tuple<const char *, double, BootstrapInterval> parameter_array[] = {
+            std::make_tuple("purity", result.point.purity, result.purity),
+            std::make_tuple("ploidy", result.point.ploidy, result.ploidy),
+            std::make_tuple("Q", result.point.Q, result.Q)};
+    for (const auto &parameter : parameter_array)
+        interval_writer.write("{}\t{:.5g}\t{:.5g}\t{:.5g}\t{}\t{}\n", std::get<0>(parameter), std::get<1>(parameter),
+                              std::get<2>(parameter).lower, std::get<2>(parameter).upper,
+                              bootstrap_options.confidence, result.no_of_replicates_solved);
+    if (!replicate_writer.close() || !interval_writer.close())
+    {
+        cerr << fmt::format("ERROR: could not write the bootstrap tables to {}.\n", output_dir);
+        exit(3);
+    }
+    exit(0);
+}
@@ -0,0 +1,49 @@
+#include "infer.h"
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    //argv[2], the segment input: a GADA output file (gzipped or plain), a comma-separated list of them, or a directory.
+    // Ratio tracks (*.csv, *.csv.gz, GADA's input) in it are segmented in-process instead.
+    // When streaming (argv[12]), a list whose files are taken once "<file>.done" exists, or a FIFO of file paths.
+    InferInput input;
+    input.segment_data_input_path = argv[2];
+    input.snp_data_input_path = argv[3];
+
+    InferOptions options;
+    options.config_file_path = argv[1];
+    options.output_dir = argv[4];
+    options.write_artifacts = true;
+    options.log = &cerr;
+    options.segment_stddev_divider = atof(argv[5]);
+    options.snp_coverage_min = atoi(argv[6]);
+    options.snp_coverage_var_vs_mean_ratio = atof(argv[7]);
+    options.no_of_peaks_for_logL = atoi(argv[8]);
+    options.debug = atoi(argv[9]);
+    options.auto_ = atoi(argv[10]);
+    //optional 11th argument: segmentation engine (SBL or PELT) of the GADA period detection
+    if (argc > 11) {
+        options.segmentation_engine = segmentationEngineFromName(argv[11]);
+        if (options.segmentation_engine < 0) {
+            cerr << fmt::format("ERROR: unknown segmentation engine {}. Choose SBL or PELT.\n", argv[11]);
+            exit(3);
+        }
+    }
+    //optional 12th argument: >0 streams the segment input, waiting at most this many seconds for the next file
+    if (argc > 12) {
+        options.segment_stream_timeout = atoi(argv[12]);
+    }
+    //optional 13th and 14th arguments: GADA -M and -T for ratio tracks (*.csv, *.csv.gz) segmented in-process
+    if (argc > 14) {
+        options.segment_min_len = atol(argv[13]);
+        options.segment_t_score = atof(argv[14]);
+    }
+    //optional 15th argument: a folder caching the prepared segments and ratio histograms of earlier runs on the same
+    // files, "" for none
+    if (argc > 15) {
+        options.cache_dir = argv[15];
+    }
+    InferResult result;
+    int returnCode = inferPurityPloidy(input, options, result);
+    exit(returnCode);
+}
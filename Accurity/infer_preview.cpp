@@ -0,0 +1,91 @@
+/*
+ * 2026.10.18 infer_preview: a quick purity/ploidy estimate for intake QC. Two disjoint subsamples of the
+ * sample (a fraction of the SNPs of each chromosome, a fraction of the segments stratified by window count) go
+ * through the usual infer pipeline in parallel. Writes preview.tsv to the output folder: the mean estimate,
+ * how far the two subsamples are apart and whether they agree, then the estimate of each subsample.
+ */
+#include <chrono>
+#include <sys/stat.h>
+#include <boost/program_options.hpp>
+#include "infer.h"
+using namespace std;
+namespace po = boost::program_options;
+
+int main(int argc, char **argv)
+{
+    string output_dir, engine_name;
+    InferInput input;
+    InferOptions options;
+    PreviewOptions preview_options;
+    po::options_description option_description("infer_preview options");
+    option_description.add_options()("help,h", "produce help message")
+            ("segments,i", po::value<string>(&input.segment_data_input_path), "as argv[2] of infer")
+            ("snps", po::value<string>(&input.snp_data_input_path), "het SNP file")
+            ("output_dir,o", po::value<string>(&output_dir), "output folder")
+            ("snp_fraction", po::value<double>(&preview_options.snp_fraction)->default_value(0.1),
+             "fraction of the SNPs of each chromosome in each subsample")
+            ("min_no_of_snps", po::value<size_t>(&preview_options.min_no_of_snps)->default_value(20000),
+             "SNPs per subsample at least, if the sample has enough, regardless of the fraction")
+            ("segment_fraction", po::value<double>(&preview_options.segment_fraction)->default_value(0.5),
+             "fraction of the segments in each subsample, at most 0.5")
+            ("purity_tolerance", po::value<double>(&preview_options.purity_tolerance)->default_value(0.05),
+             "largest purity difference of subsamples that agree")
+            ("ploidy_tolerance", po::value<double>(&preview_options.ploidy_tolerance)->default_value(0.2),
+             "largest ploidy difference of subsamples that agree");
+    addInferOptions(option_description, options, engine_name);
+    po::variables_map option_variable_map;
+    po::store(po::parse_command_line(argc, argv, option_description), option_variable_map);
+    po::notify(option_variable_map);
+    if (option_variable_map.count("help") || input.segment_data_input_path.empty() ||
+        input.snp_data_input_path.empty() || output_dir.empty())
+    {
+        cout << "Usage:" << endl << argv[0] << " -i SEGMENTS --snps SNPS -o OUTPUT_DIR [OPTIONS]" << endl << endl;
+        cout << option_description << endl;
+        exit(1);
+    }
+    if (preview_options.snp_fraction <= 0 || preview_options.snp_fraction > 0.5 ||
+        preview_options.segment_fraction <= 0 || preview_options.segment_fraction > 0.5)
+    {
+        cerr << "ERROR: the SNP and segment fractions must be in (0, 0.5], so that the subsamples are disjoint.\n";
+        exit(3);
+    }
+    string error_message;
+    if (!finishInferOptions(engine_name, options, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+    mkdir(output_dir.c_str(), 0755);
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    PreviewResult result;
+    int return_code = previewPurityPloidy(input, options, preview_options, result);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    if (return_code != 0)
+    {
+        cerr << fmt::format("ERROR: {}\n", result.subsample_result_array[0].message);
+        exit(return_code);
+    }
+    cerr << fmt::format("preview purity={:.5g} ploidy={:.5g} ({}, subsamples of {} SNPs and {} segments, {:.1f}s)\n",
+                        result.purity, result.ploidy, result.stable ? "stable" : "unstable",
+                        result.no_of_snps_per_subsample, result.no_of_segments_per_subsample, seconds);
+
+    RowWriter preview_writer;
+    preview_writer.open(fmt::format("{}/preview.tsv", output_dir));
+    preview_writer.write("purity\tploidy\tpurity_difference\tploidy_difference\tstable\t"
+                         "status_1\tpurity_1\tploidy_1\tQ_1\tstatus_2\tpurity_2\tploidy_2\tQ_2\t"
+                         "no_of_snps_per_subsample\tno_of_segments_per_subsample\tseconds\n");
+    preview_writer.write("{:.5g}\t{:.5g}\t{:.5g}\t{:.5g}\t{}", result.purity, result.ploidy, result.purity_difference,
+                         result.ploidy_difference, result.stable ? 1 : 0);
+    for (const InferResult &subsample_result : result.subsample_result_array)
+        preview_writer.write("\t{}\t{:.5g}\t{:.5g}\t{:.5g}", inferStatusName(subsample_result.status),
+                             subsample_result.purity, subsample_result.ploidy, subsample_result.Q);
+    preview_writer.write("\t{}\t{}\t{:.3g}\n", result.no_of_snps_per_subsample, result.no_of_segments_per_subsample,
+                         seconds);
+    if (!preview_writer.close())
+    {
+        cerr << fmt::format("ERROR: could not write {}/preview.tsv.\n", output_dir);
+        exit(3);
+    }
+    exit(0);
+}
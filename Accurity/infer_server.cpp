@@ -0,0 +1,457 @@
+/*
+ * 2026.10.18 infer_server: keeps infer resident behind a Unix domain socket for interactive review.
+ * Parsed samples (SNP and prepared segment records) stay in an LRU cache under --memory_budget, and one
+ * AdjustedMafCache is shared by all requests, so rerunning a sample with other parameters skips process
+ * start, parsing and most of the SNP likelihood work.
+ *
+ * A client sends one request per line and gets one JSON object per line back:
+ *  infer segments=PATH snps=PATH [parameter=value ...]
+ *      parameters as the optional manifest columns of infer_batch (segment_stddev_divider, snp_coverage_min,
+ *      snp_coverage_var_vs_mean_ratio, max_no_of_peaks_for_logL, auto, segmentation_engine, min_segment_len,
+ *      t_score_threshold), plus output_dir=PATH to also write the usual infer outputs there and
+ *      cn_segments=0 to leave the copy number segments out of the reply.
+ *  stats       cache contents and hit counts
+ *  clear       empty both caches
+ *  shutdown    stop the server
+ * e.g. echo "infer segments=/data/s1/segments snps=/data/s1/het_snp.tsv.gz" | nc -U /tmp/infer.sock
+ * Each connection holds one of the --threads serving threads, until it closes or sends nothing for --idle_timeout
+ * seconds.
+ */
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <boost/program_options.hpp>
+#include "infer.h"
+using namespace std;
+namespace po = boost::program_options;
+
+//the parsed input of one sample
+struct CachedSample
+{
+    vector<SNPRecord> snp_vec;
+    vector<SegmentRecord> segment_vec;
+    size_t bytes;
+    string input_stamp;  // inferInputStamp() when the files were read
+};
+
+//samples by input paths (and the in-process segmentation parameters, which change the records of ratio tracks),
+// least recently used first out once the budget is exceeded. A sample whose files were rewritten since they were
+// read (another input_stamp) is dropped on lookup, so rerunning GADA or normalize into the same folder is seen.
+class SampleCache
+{
+   public:
+    SampleCache(size_t memory_budget)
+        : no_of_hits(0), no_of_misses(0), no_of_stale(0), _memory_budget(memory_budget), _bytes(0) {}
+
+    shared_ptr<const CachedSample> find(const string &key, const string &input_stamp) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        map<string, list<Entry>::iterator>::iterator it = _index.find(key);
+        if (it != _index.end() && it->second->sample->input_stamp != input_stamp) {
+            no_of_stale++;
+            _bytes -= it->second->sample->bytes;
+            _lru_list.erase(it->second);
+            _index.erase(it);
+            it = _index.end();
+        }
+        if (it == _index.end()) {
+            no_of_misses++;
+            return shared_ptr<const CachedSample>();
+        }
+        no_of_hits++;
+        _lru_list.splice(_lru_list.end(), _lru_list, it->second);
+        return it->second->sample;
+    }
+    //other_bytes: memory held elsewhere under the same budget (the AdjustedMafCache)
+    void insert(const string &key, shared_ptr<const CachedSample> sample, size_t other_bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_index.count(key))
+            return;
+        _lru_list.push_back(Entry());
+        _lru_list.back().key = key;
+        _lru_list.back().sample = sample;
+        _index[key] = --_lru_list.end();
+        _bytes += sample->bytes;
+        //the newest sample always stays, samples in use by a request stay alive through their shared_ptr
+        while (_bytes + other_bytes > _memory_budget && _lru_list.size() > 1) {
+            _bytes -= _lru_list.front().sample->bytes;
+            _index.erase(_lru_list.front().key);
+            _lru_list.pop_front();
+        }
+    }
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lru_list.clear();
+        _index.clear();
+        _bytes = 0;
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lru_list.size();
+    }
+    size_t bytes() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+    std::atomic<long> no_of_hits;
+    std::atomic<long> no_of_misses;
+    std::atomic<long> no_of_stale;  // misses because the files changed
+
+   private:
+    struct Entry
+    {
+        string key;
+        shared_ptr<const CachedSample> sample;
+    };
+    size_t _memory_budget;
+    size_t _bytes;
+    std::mutex _mutex;
+    list<Entry> _lru_list;
+    map<string, list<Entry>::iterator> _index;
+};
+
+struct ServerState
+{
+    ServerState(size_t memory_budget) : sample_cache(memory_budget), memory_budget(memory_budget),
+                                        idle_timeout(60), shutting_down(false) {}
+    SampleCache sample_cache;
+    AdjustedMafCache maf_cache;
+    size_t memory_budget;
+    int idle_timeout;  // seconds a connection may wait for its next request
+    InferOptions default_options;
+    std::atomic<bool> shutting_down;
+    std::mutex log_mutex;
+};
+
+static size_t sample_bytes(const CachedSample &sample)
+{
+    size_t bytes = sizeof(CachedSample) + sample.snp_vec.capacity() * sizeof(SNPRecord) +
+                   sample.segment_vec.capacity() * sizeof(SegmentRecord);
+    for (const SNPRecord &snp : sample.snp_vec)
+        if (snp.chr_string.capacity() > 15)  // beyond the short string buffer
+            bytes += snp.chr_string.capacity() + 1;
+    return bytes;
+}
+
+static string result_to_json(const InferResult &result, bool with_cn_segments)
+{
+    fmt::MemoryWriter json;
+    json << "{\"status\":" << json_string(inferStatusName(result.status))
+         << ",\"message\":" << json_string(result.message)
+         << ",\"purity\":" << json_number(result.purity)
+         << ",\"ploidy\":" << json_number(result.ploidy)
+         << ",\"purity_naive\":" << json_number(result.purity_naive)
+         << ",\"ploidy_naive\":" << json_number(result.ploidy_naive)
+         << ",\"rc_ratio_of_cp_2\":" << json_number(result.rc_ratio_of_cp_2)
+         << ",\"Q\":" << json_number(result.Q)
+         << ",\"logL\":" << json_number(result.logL)
+         << ",\"period\":" << result.period_int
+         << ",\"best_no_of_copy_nos_bf_1st_peak\":" << result.best_no_of_copy_nos_bf_1st_peak
+         << ",\"first_peak_int\":" << result.first_peak_int
+         << ",\"ploidy_cnv_all\":" << json_number(result.ploidy_cnv_all)
+         << ",\"ploidy_clonal\":" << json_number(result.ploidy_clonal)
+         << ",\"no_of_segments\":" << result.no_of_segments
+         << ",\"no_of_segments_used\":" << result.no_of_segments_used
+         << ",\"no_of_snps\":" << result.no_of_snps
+         << ",\"no_of_snps_used\":" << result.no_of_snps_used
+         << ",\"logL_table\":[";
+    for (size_t i = 0; i < result.logL_table.size(); i++)
+    {
+        const InferLogLRow &row = result.logL_table[i];
+        json << (i ? "," : "") << "{\"period\":" << row.period_int
+             << ",\"logL\":" << json_number(row.logL)
+             << ",\"logL_rc\":" << json_number(row.logL_rc)
+             << ",\"logL_rc_penalty\":" << json_number(row.logL_rc_penalty)
+             << ",\"best_logL_snp\":" << json_number(row.best_logL_snp)
+             << ",\"best_lod_snp\":" << json_number(row.best_lod_snp)
+             << ",\"best_logL_snp_penalty\":" << json_number(row.best_logL_snp_penalty)
+             << ",\"best_logL_snp_no_of_parameters\":" << json_number(row.best_logL_snp_no_of_parameters)
+             << ",\"best_no_of_copy_nos_bf_1st_peak\":" << row.best_no_of_copy_nos_bf_1st_peak
+             << ",\"first_peak_int\":" << row.first_peak_int
+             << ",\"best_purity\":" << json_number(row.best_purity)
+             << ",\"best_ploidy\":" << json_number(row.best_ploidy) << "}";
+    }
+    json << "]";
+    if (with_cn_segments)
+    {
+        json << ",\"cn_segments\":[";
+        for (size_t i = 0; i < result.cn_segments.size(); i++)
+        {
+            const InferCNSegment &cn_segment = result.cn_segments[i];
+            json << (i ? "," : "") << "{\"chr\":" << cn_segment.chr
+                 << ",\"start\":" << cn_segment.start
+                 << ",\"end\":" << cn_segment.end
+                 << ",\"cp\":" << json_number(cn_segment.cp)
+                 << ",\"major_allele_cp\":" << cn_segment.major_allele_cp
+                 << ",\"copy_no_float\":" << json_number(cn_segment.copy_no_float)
+                 << ",\"stddev\":" << json_number(cn_segment.stddev)
+                 << ",\"maf_mean\":" << json_number(cn_segment.maf_mean)
+                 << ",\"maf_stddev\":" << json_number(cn_segment.maf_stddev)
+                 << ",\"maf_expected\":" << json_number(cn_segment.maf_expected) << "}";
+        }
+        json << "]";
+    }
+    json << "}";
+    return json.str();
+}
+
+static string error_json(const string &message)
+{
+    return fmt::format("{{\"status\":\"error\",\"message\":{}}}", json_string(message));
+}
+
+//answers one "infer ..." request
+static string handle_infer(ServerState &state, const vector<string> &element_vec)
+{
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    InferInput input;
+    InferOptions options = state.default_options;
+    bool with_cn_segments = true;
+    for (size_t i = 1; i < element_vec.size(); i++)
+    {
+        size_t equal_pos = element_vec[i].find('=');
+        if (equal_pos == string::npos)
+            return error_json(fmt::format("{} is not parameter=value.", element_vec[i]));
+        string name = element_vec[i].substr(0, equal_pos);
+        string value = element_vec[i].substr(equal_pos + 1);
+        if (name == "segments")
+            input.segment_data_input_path = value;
+        else if (name == "snps")
+            input.snp_data_input_path = value;
+        else if (name == "output_dir")
+            options.output_dir = value;
+        else if (name == "cn_segments")
+            with_cn_segments = atoi(value.c_str()) != 0;
+        else
+        {
+            string error_message;
+            int return_code = setInferOption(options, name, value, error_message);
+            if (return_code == 1)
+                return error_json(fmt::format("unknown parameter {}.", name));
+            if (return_code == 2)
+                return error_json(error_message);
+        }
+    }
+    if (input.segment_data_input_path.empty() || input.snp_data_input_path.empty())
+        return error_json("segments and snps are required.");
+    options.write_artifacts = !options.output_dir.empty();
+    if (options.write_artifacts)
+        mkdir(options.output_dir.c_str(), 0755);
+
+    string cache_key = fmt::format("{}\t{}\t{}\t{}\t{}", input.segment_data_input_path, input.snp_data_input_path,
+                                   options.segment_min_len, options.segment_t_score, options.segmentation_engine);
+    string input_stamp = inferInputStamp(input);
+    shared_ptr<const CachedSample> sample = state.sample_cache.find(cache_key, input_stamp);
+    bool cache_hit = (bool) sample;
+    InferResult result;
+    if (!sample)
+    {
+        shared_ptr<CachedSample> loaded_sample = make_shared<CachedSample>();
+        if (loadInferInput(input, options, loaded_sample->snp_vec, loaded_sample->segment_vec, result) != 0)
+            return error_json(result.message);
+        loaded_sample->bytes = sample_bytes(*loaded_sample);
+        loaded_sample->input_stamp = input_stamp;
+        state.sample_cache.insert(cache_key, loaded_sample, state.maf_cache.bytes());
+        sample = loaded_sample;
+    }
+    if (state.maf_cache.bytes() > state.memory_budget / 4)
+        state.maf_cache.clear();
+    input.snps = sample->snp_vec.data();
+    input.no_of_snps = sample->snp_vec.size();
+    input.segments = sample->segment_vec.data();
+    input.no_of_segments = sample->segment_vec.size();
+    input.segments_prepared = true;
+    int returnCode = inferPurityPloidy(input, options, result);
+    double milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time).count();
+    string json = result_to_json(result, with_cn_segments);
+    json.insert(json.size() - 1, fmt::format(",\"return_code\":{},\"sample_cache_hit\":{},\"milliseconds\":{}",
+                                             returnCode, cache_hit ? "true" : "false", json_number(milliseconds)));
+    std::lock_guard<std::mutex> log_lock(state.log_mutex);
+    cerr << fmt::format("{} {}: {} purity={} ploidy={} ({:.1f}ms, sample cache {})\n",
+                        input.segment_data_input_path, input.snp_data_input_path, inferStatusName(result.status),
+                        result.purity, result.ploidy, milliseconds, cache_hit ? "hit" : "miss");
+    return json;
+}
+
+static string handle_request(ServerState &state, const string &line)
+{
+    vector<string> element_vec = string_split(line, " \t\r");
+    if (element_vec.empty())
+        return error_json("empty request.");
+    if (element_vec[0] == "infer")
+        return handle_infer(state, element_vec);
+    if (element_vec[0] == "stats")
+        return fmt::format("{{\"status\":\"ok\",\"no_of_samples\":{},\"sample_bytes\":{},\"sample_cache_hits\":{},"
+                                   "\"sample_cache_misses\":{},\"sample_cache_stale\":{},\"maf_cache_entries\":{},\"maf_cache_hits\":{},"
+                                   "\"maf_cache_misses\":{},\"memory_budget\":{}}}",
+                           state.sample_cache.size(), state.sample_cache.bytes(),
+                           (long) state.sample_cache.no_of_hits, (long) state.sample_cache.no_of_misses,
+                           (long) state.sample_cache.no_of_stale,
+                           state.maf_cache.size(), (long) state.maf_cache.no_of_hits,
+                           (long) state.maf_cache.no_of_misses, state.memory_budget);
+    if (element_vec[0] == "clear")
+    {
+        state.sample_cache.clear();
+        state.maf_cache.clear();
+        return "{\"status\":\"ok\"}";
+    }
+    if (element_vec[0] == "shutdown")
+    {
+        state.shutting_down = true;
+        return "{\"status\":\"ok\"}";
+    }
+    return error_json(fmt::format("unknown request {}.", element_vec[0]));
+}
+
+static bool send_all(int fd, const string &data)
+{
+    size_t no_of_bytes_sent = 0;
+    while (no_of_bytes_sent < data.size())
+    {
+        ssize_t no_of_bytes = send(fd, data.data() + no_of_bytes_sent, data.size() - no_of_bytes_sent, MSG_NOSIGNAL);
+        if (no_of_bytes <= 0)
+            return false;
+        no_of_bytes_sent += no_of_bytes;
+    }
+    return true;
+}
+
+//answers the requests of one connection until the client closes it, stays idle for state.idle_timeout seconds
+// or the server shuts down. Waits in poll() rather than recv(), so an idle client neither keeps a shutdown from
+// completing nor holds a serving thread for long.
+static void serve_connection(ServerState &state, int connection_fd)
+{
+    string pending;
+    char buffer[4096];
+    std::chrono::steady_clock::time_point last_request = std::chrono::steady_clock::now();
+    while (!state.shutting_down)
+    {
+        struct pollfd connection_poll = {connection_fd, POLLIN, 0};
+        int no_of_ready = poll(&connection_poll, 1, 500);
+        if (no_of_ready == 0 || (no_of_ready < 0 && errno == EINTR))
+        {
+            if (std::chrono::steady_clock::now() - last_request > std::chrono::seconds(state.idle_timeout))
+                break;
+            continue;
+        }
+        if (no_of_ready < 0)
+            break;
+        ssize_t no_of_bytes = recv(connection_fd, buffer, sizeof(buffer), 0);
+        if (no_of_bytes <= 0)
+            break;
+        pending.append(buffer, no_of_bytes);
+        size_t newline_pos;
+        while ((newline_pos = pending.find('\n')) != string::npos)
+        {
+            string line = pending.substr(0, newline_pos);
+            pending.erase(0, newline_pos + 1);
+            string reply;
+            try
+            {
+                reply = handle_request(state, line);
+            }
+            catch (std::exception &e)
+            {
+                //e.g. std::bad_alloc, input errors come back as error replies
+                reply = error_json(e.what());
+            }
+            if (!send_all(connection_fd, reply + "\n"))
+                break;
+            last_request = std::chrono::steady_clock::now();
+        }
+    }
+    close(connection_fd);
+}
+
+int main(int argc, char **argv)
+{
+    string socket_path, engine_name;
+    int no_of_threads, idle_timeout, debug;
+    double memory_budget_mb;
+    InferOptions default_options;
+    po::options_description option_description("infer_server options");
+    option_description.add_options()("help,h", "produce help message")
+            ("socket,s", po::value<string>(&socket_path), "Unix domain socket to listen on")
+            ("memory_budget", po::value<double>(&memory_budget_mb)->default_value(2048),
+             "MB of parsed samples and cached likelihood terms to keep, least recently used samples go first")
+            ("threads,t", po::value<int>(&no_of_threads)->default_value(0),
+             "connections served at the same time, 0 for one per core")
+            ("idle_timeout", po::value<int>(&idle_timeout)->default_value(60),
+             "seconds after which a connection without requests is closed, freeing its thread")
+            ("debug", po::value<int>(&debug)->default_value(0), "as argv[9] of infer, for requests with output_dir");
+    addInferOptions(option_description, default_options, engine_name);
+    po::variables_map option_variable_map;
+    po::store(po::parse_command_line(argc, argv, option_description), option_variable_map);
+    po::notify(option_variable_map);
+    if (option_variable_map.count("help") || socket_path.empty())
+    {
+        cout << "Usage:" << endl << argv[0] << " -s SOCKET [OPTIONS]" << endl << endl;
+        cout << option_description << endl;
+        exit(1);
+    }
+    string error_message;
+    if (!finishInferOptions(engine_name, default_options, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+    if (no_of_threads <= 0)
+        no_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    ServerState state((size_t) (memory_budget_mb * 1024 * 1024));
+    state.idle_timeout = std::max(1, idle_timeout);
+    default_options.debug = debug;
+    default_options.maf_cache = &state.maf_cache;
+    state.default_options = default_options;
+
+    struct sockaddr_un socket_address;
+    if (socket_path.size() >= sizeof(socket_address.sun_path))
+    {
+        cerr << fmt::format("ERROR: socket path {} is too long.\n", socket_path);
+        exit(3);
+    }
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&socket_address, 0, sizeof(socket_address));
+    socket_address.sun_family = AF_UNIX;
+    strcpy(socket_address.sun_path, socket_path.c_str());
+    struct stat path_stat;
+    if (stat(socket_path.c_str(), &path_stat) == 0 && S_ISSOCK(path_stat.st_mode))
+        unlink(socket_path.c_str());  // left over by an earlier server
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *) &socket_address, sizeof(socket_address)) != 0 ||
+        listen(listen_fd, 64) != 0)
+    {
+        cerr << fmt::format("ERROR: could not listen on {}: {}.\n", socket_path, strerror(errno));
+        exit(3);
+    }
+    //all threads poll the socket and all wake for one connection: the losers must get EAGAIN, not block in accept()
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+    cerr << fmt::format("Listening on {} with {} threads, memory budget {} MB.\n", socket_path, no_of_threads,
+                        memory_budget_mb);
+
+    auto accept_connections = [&]() {
+        while (!state.shutting_down)
+        {
+            struct pollfd listen_poll = {listen_fd, POLLIN, 0};
+            if (poll(&listen_poll, 1, 500) <= 0)
+                continue;
+            int connection_fd = accept(listen_fd, NULL, NULL);
+            if (connection_fd >= 0)
+                serve_connection(state, connection_fd);  // accepted sockets do not inherit O_NONBLOCK
+            //EAGAIN/EWOULDBLOCK: another thread took the connection
+        }
+    };
+    vector<std::thread> thread_vec;
+    for (int thread_index = 1; thread_index < no_of_threads; thread_index++)
+        thread_vec.push_back(std::thread(accept_connections));
+    accept_connections();
+    for (std::thread &server_thread : thread_vec)
+        server_thread.join();
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    cerr << "Server stopped.\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * 2026.10.18 infer_sweep: runs infer on a grid of parameters for one sample. The segments and SNPs are read
+ * once, each segment_stddev_divider folds them into the ratio histogram and detects the periods once, and the
+ * other parameters only redo the likelihoods. Grid points run in parallel. One line per grid point goes to the
+ * results table, in grid order (segment_stddev_divider slowest, max_no_of_peaks_for_logL fastest).
+ */
+#include <chrono>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+#include "infer.h"
+using namespace std;
+namespace po = boost::program_options;
+
+//a comma-separated list of numbers, as "10,20,30"
+template <typename T>
+static bool parse_axis(const string &option_name, const string &value_list, vector<T> &value_vec)
+{
+    vector<string> element_vec;
+    boost::split(element_vec, value_list, boost::is_any_of(","));
+    for (const string &element : element_vec)
+    {
+        try
+        {
+            value_vec.push_back(boost::lexical_cast<T>(boost::trim_copy(element)));
+        }
+        catch (const boost::bad_lexical_cast &)
+        {
+            cerr << fmt::format("ERROR: {} of --{} is not a number.\n", element, option_name);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    string output_file_path, engine_name;
+    string divider_list, coverage_min_list, var_vs_mean_ratio_list, no_of_peaks_list;
+    InferInput input;
+    InferOptions options;
+    SweepGrid grid;
+    po::options_description option_description("infer_sweep options");
+    option_description.add_options()("help,h", "produce help message")
+            ("segments,i", po::value<string>(&input.segment_data_input_path), "as argv[2] of infer")
+            ("snps", po::value<string>(&input.snp_data_input_path), "het SNP file")
+            ("output,o", po::value<string>(&output_file_path), "results table, one line per grid point")
+            ("threads,t", po::value<int>(&grid.no_of_threads)->default_value(0),
+             "grid points run at the same time, 0 for one per core")
+            ("segment_stddev_divider", po::value<string>(&divider_list)->default_value("20"),
+             "comma-separated values of each grid axis")
+            ("snp_coverage_min", po::value<string>(&coverage_min_list)->default_value("2"))
+            ("snp_coverage_var_vs_mean_ratio", po::value<string>(&var_vs_mean_ratio_list)->default_value("10"))
+            ("max_no_of_peaks_for_logL", po::value<string>(&no_of_peaks_list)->default_value("3"));
+    addInferOptions(option_description, options, engine_name, false);
+    po::variables_map option_variable_map;
+    po::store(po::parse_command_line(argc, argv, option_description), option_variable_map);
+    po::notify(option_variable_map);
+    if (option_variable_map.count("help") || input.segment_data_input_path.empty() ||
+        input.snp_data_input_path.empty() || output_file_path.empty())
+    {
+        cout << "Usage:" << endl << argv[0] << " -i SEGMENTS --snps SNPS -o RESULTS [OPTIONS]" << endl << endl;
+        cout << option_description << endl;
+        exit(1);
+    }
+    if (!parse_axis("segment_stddev_divider", divider_list, grid.segment_stddev_divider_vec) ||
+        !parse_axis("snp_coverage_min", coverage_min_list, grid.snp_coverage_min_vec) ||
+        !parse_axis("snp_coverage_var_vs_mean_ratio", var_vs_mean_ratio_list,
+                    grid.snp_coverage_var_vs_mean_ratio_vec) ||
+        !parse_axis("max_no_of_peaks_for_logL", no_of_peaks_list, grid.no_of_peaks_for_logL_vec))
+        exit(3);
+    string error_message;
+    if (!finishInferOptions(engine_name, options, error_message))
+    {
+        cerr << "ERROR: " << error_message << endl;
+        exit(3);
+    }
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    vector<SweepPoint> point_vec;
+    int return_code = sweepPurityPloidy(input, options, grid, point_vec);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    cerr << fmt::format("{} grid points in {:.1f}s.\n", point_vec.size(), seconds);
+
+    RowWriter output_writer;
+    if (!output_writer.open(output_file_path))
+    {
+        cerr << fmt::format("ERROR: could not write {}.\n", output_file_path);
+        exit(3);
+    }
+    output_writer.write("segment_stddev_divider\tsnp_coverage_min\tsnp_coverage_var_vs_mean_ratio\t"
+                        "max_no_of_peaks_for_logL\tstatus\tpurity\tploidy\tQ\tlogL\tperiod\tmessage\n");
+    for (const SweepPoint &point : point_vec)
+    {
+        const InferResult &result = point.result;
+        output_writer.write("{:g}\t{}\t{:g}\t{}\t{}\t{:.5g}\t{:.5g}\t{:.5g}\t{:.5g}\t{}\t{}\n",
+                            point.segment_stddev_divider, point.snp_coverage_min,
+                            point.snp_coverage_var_vs_mean_ratio, point.no_of_peaks_for_logL,
+                            inferStatusName(result.status), result.purity, result.ploidy, result.Q, result.logL,
+                            result.period_int, result.message);
+    }
+    if (!output_writer.close())
+    {
+        cerr << fmt::format("ERROR: could not write {}.\n", output_file_path);
+        exit(3);
+    }
+    exit(return_code);
+}
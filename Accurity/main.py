@@ -14,7 +14,8 @@ class AccurityFlow(WorkflowRunner):
 				 snp_output_dir=None,
 				 segment_stddev_divider=20, snp_coverage_min=2,
 	             snp_coverage_var_vs_mean_ratio=10.0, clean=0, step=0, debug=0, auto=1,
-				 max_no_of_peaks_for_logL=3):
+				 max_no_of_peaks_for_logL=3, segmentation_engine="SBL", stream_segments=0, fused=0,
+				 bootstrap_replicates=0, cache_dir="", nCores=2):
 		self.configure_filepath = configure_filepath
 		self.tumor_bam = tumor_bam
 		self.normal_bam = normal_bam
@@ -28,6 +29,19 @@ class AccurityFlow(WorkflowRunner):
 		self.debug = debug
 		self.auto = auto
 		self.max_no_of_peaks_for_logL = max_no_of_peaks_for_logL
+		self.segmentation_engine = segmentation_engine
+		#seconds infer waits for the next chromosome's segments when streaming, 0: infer waits for all segment jobs
+		#1: infer segments the normalized ratio tracks itself, no GADA jobs and no segment files
+		self.fused = fused
+		self.stream_segments = stream_segments if (step <= 4 and not fused) else 0
+		#>0: confidence intervals of purity and ploidy from this many bootstrap replicates, after infer
+		self.bootstrap_replicates = bootstrap_replicates
+		#folder where infer keeps the prepared segments and ratio histograms of its inputs, "" for none
+		self.cache_dir = cache_dir
+		if self.cache_dir and not os.path.isdir(self.cache_dir):
+			os.makedirs(self.cache_dir)
+		#normalize reads the tumor and normal bams with this many threads
+		self.nCores = nCores
 
 		if not os.path.isdir(self.output_dir):
 			os.mkdir(self.output_dir)
@@ -68,7 +82,11 @@ class AccurityFlow(WorkflowRunner):
 
 		self.het_snp_filepath = os.path.join(self.output_dir, "het_snp.tsv.gz")
 		self.het_snp_normal_filepath = os.path.join(self.output_dir, "het_snp.normal.tsv.gz")
-		self.segment_data_filepath = os.path.join(self.output_dir, "all_segments.tsv.gz")
+		#per-chromosome GADA outputs, infer reads them all (comma-separated list) without concatenation
+		self.segment_out_ls = [os.path.join(self.output_dir, "%s.segments.M%s.T%s.tsv" % \
+		                                    (chromosome, self.min_segment_len, self.t_score_threshold))
+		                       for chromosome in self.chromosomeNames[:self.NUM_AUTO_CHR]]
+		self.segment_data_filepath = ",".join(self.segment_out_ls)
 		self.infer_status_out_path = os.path.join(self.output_dir, "infer.status.txt")
 
 		if os.path.isdir(self.output_dir):
@@ -189,16 +207,16 @@ class AccurityFlow(WorkflowRunner):
 			#output (GC-normalize adj factors): tumor/tumor.cov.adj.factor.txt, tumor/normal.cov.adj.factor.txt
 			reg_input_base_filename = "reg.in.txt"
 			reg_output_base_filename = "reg.out.txt"
-			cmd = '%s normalize -t %s -n %s -w %s -l %s --smooth_window_half_size %s --max_coverage %s --debug %s -o %s 2>&1 | tee -a %s' \
+			cmd = '%s normalize -t %s -n %s -w %s -l %s --smooth_window_half_size %s --max_coverage %s --threads %s --debug %s -o %s 2>&1 | tee -a %s' \
 				  % (os.path.join(self.accurity_path, "accurity"),
 					 self.tumor_bam, self.normal_bam, self.window_size,
 					 self.read_len, self.smooth_window_half_size,
-				     self.max_coverage,
+				     self.max_coverage, self.nCores,
 					 self.debug,
 					 self.output_dir,
 				     self.infer_status_out_path
 					)
-			normalize_jobs.append(self.addTask("normalize", cmd,
+			normalize_jobs.append(self.addTask("normalize", cmd, nCores=self.nCores,
 								   dependencies=[indexTumorBamJob, indexNormalBamJob]))
 			#add a gzip job
 			#cmd = "gzip %s/tumor.%s %s/normal.%s"%(self.output_dir, reg_input_base_filename, self.output_dir, reg_input_base_filename)
@@ -258,33 +276,31 @@ class AccurityFlow(WorkflowRunner):
 		############################################################
 		# STEP 4: Segmentation										#
 		############################################################
-		if self.step <= 4:
+		if self.step <= 4 and not self.fused:
 			self.startTimeList.append(datetime.now())
 			status_string = "Last step time span: %s\n" % (self.startTimeList[-1] - self.startTimeList[-2])
 			status_string += "step 4: Segmentation \n\tstart time: %s\n" % self.startTimeList[-1]
 			sys.stderr.write(status_string)
 
 			segment_jobs = []
-			segment_out_ls = []
 			for chr_index in range(self.NUM_AUTO_CHR):
 				chromosome = self.chromosomeNames[chr_index]
-				segment_out_path = os.path.join(self.output_dir, "%s.segments.M%s.T%s.tsv"%(chromosome, self.min_segment_len, self.t_score_threshold))
-				segment_out_ls.append(segment_out_path)
-				cmd = '%s --chromosome_id %s -M %s -T %s -i %s -o %s 2>&1 | tee -a %s' % \
+				segment_out_path = self.segment_out_ls[chr_index]
+				#a streaming infer takes a segment file once its .done sentinel exists, remove stale ones first
+				if os.path.isfile(segment_out_path + ".done"):
+					os.remove(segment_out_path + ".done")
+				#GADA timing and counters go to <segment file>.profile.json, infer's to infer.profile.json
+				cmd = '(%s --chromosome_id %s --engine %s -M %s -T %s -i %s -o %s --profileFilePath %s.profile.json && ' \
+				      'touch %s.done) 2>&1 | tee -a %s' % \
 				      (os.path.join(self.accurity_path, "GADA"),
-				       chromosome, self.min_segment_len, self.t_score_threshold,
+				       chromosome, self.segmentation_engine, self.min_segment_len, self.t_score_threshold,
 				       normalize_output_file_ls[chr_index],
-				       segment_out_path,
+				       segment_out_path, segment_out_path, segment_out_path,
 				       self.infer_status_out_path)
 				segment_jobs.append(self.addTask("segment_%s"%chromosome, cmd, dependencies=normalize_jobs))
-
-
-			cmd = "cat %s | gzip > %s" % (" ".join(segment_out_ls), self.segment_data_filepath)
-			reduce_all_segments_job = self.addTask("reduce_all_segments", cmd, dependencies=segment_jobs)
-			#remove all individual segments files
-			self.addTask("rm_individual_seg_files", "rm %s" % " ".join(segment_out_ls), dependencies=reduce_all_segments_job)
+			segment_all_job = self.addTask("segment_all", dependencies=segment_jobs)
 		else:
-			reduce_all_segments_job = self.addTask("reduce_all_segments")
+			segment_all_job = self.addTask("segment_all")
 
 		############################################################
 		# STEP 5: Infer purity, ploidy, etc.
@@ -295,18 +311,39 @@ class AccurityFlow(WorkflowRunner):
 			status_string += "step 5: Infer tumor purity and ploidy.\n\tstart time: %s\n" % self.startTimeList[-1]
 			sys.stderr.write(status_string)
 
-			#input: self.segment_data_filepath (all_segments), self.het_snp_filepath (het_snp)
+			#input: self.segment_data_filepath (per-chromosome segments), self.het_snp_filepath (het_snp)
 			#input: reg_coeff (to get depth of the of tumor bam)
 			#output: infer.out.tsv, infer.out.details.tsv, rc_ratio_window_count_smoothed.tsv, peak_bounds.tsv
 			#output: auto.tsv, cnv.output.tsv
-			cmd = "%s %s %s %s %s %s %s %s %s %s %s 2>&1 | tee -a %s" % (
-				os.path.join(self.accurity_path, "infer"), self.configure_filepath, self.segment_data_filepath,
+			#fused: infer reads the ratio tracks and segments them in memory (GADA -M/-T passed along)
+			segment_input = ",".join(normalize_output_file_ls) if self.fused else self.segment_data_filepath
+			cmd = "%s %s %s %s %s %s %s %s %s %s %s %s %s %s %s '%s' 2>&1 | tee -a %s" % (
+				os.path.join(self.accurity_path, "infer"), self.configure_filepath, segment_input,
 				self.het_snp_filepath, self.output_dir,
 				self.segment_stddev_divider, self.snp_coverage_min, self.snp_coverage_var_vs_mean_ratio,
 				self.max_no_of_peaks_for_logL,
-				self.debug, self.auto,
+				self.debug, self.auto, self.segmentation_engine, self.stream_segments,
+				self.min_segment_len, self.t_score_threshold, self.cache_dir,
 				self.infer_status_out_path)
-			infer_job = self.addTask("infer", cmd, dependencies=[reduce_all_segments_job, call_het_snps_tumor_job])
+			if self.fused:
+				infer_job = self.addTask("infer", cmd, dependencies=normalize_jobs + [call_het_snps_tumor_job])
+			elif self.stream_segments > 0:
+				#infer folds in each chromosome as its GADA job finishes
+				infer_job = self.addTask("infer", cmd, dependencies=[call_het_snps_tumor_job])
+			else:
+				infer_job = self.addTask("infer", cmd, dependencies=[segment_all_job, call_het_snps_tumor_job])
+			if self.bootstrap_replicates > 0:
+				#output: bootstrap.tsv, bootstrap.ci.tsv
+				cmd = "%s --config %s -i %s --snps %s -o %s -B %s --segment_stddev_divider %s --snp_coverage_min %s " \
+				      "--snp_coverage_var_vs_mean_ratio %s --max_no_of_peaks_for_logL %s --auto %s " \
+				      "--segmentation_engine %s --min_segment_len %s --t_score_threshold %s 2>&1 | tee -a %s" % (
+					os.path.join(self.accurity_path, "infer_bootstrap"), self.configure_filepath, segment_input,
+					self.het_snp_filepath, self.output_dir, self.bootstrap_replicates,
+					self.segment_stddev_divider, self.snp_coverage_min, self.snp_coverage_var_vs_mean_ratio,
+					self.max_no_of_peaks_for_logL, self.auto, self.segmentation_engine,
+					self.min_segment_len, self.t_score_threshold,
+					self.infer_status_out_path)
+				self.addTask("bootstrap", cmd, dependencies=infer_job)
 			if self.debug:
 				self.addTask("gzip_rc_ratio_no_of_windows_by_chr", "gzip %s/rc_ratio_no_of_windows_by_chr.tsv" % self.output_dir,
 				             dependencies=infer_job)
@@ -356,9 +393,11 @@ class AccurityFlow(WorkflowRunner):
 										  os.path.join(self.output_dir, "plot.snp_maf_peak.png"))
 				plot_snp_maf_peak_job = self.addTask("plot_snp_maf_peak", cmd, dependencies=infer_job)
 
-				cmd = "%s -i %s -o %s" % (os.path.join(self.accurity_path, "plot_snp_maf_exp.py"),
-										  os.path.join(self.output_dir, "snp_maf_exp_vs_adj.tsv"),
-										  self.output_dir)
+				#snp_maf_exp_vs_adj.tsv is traced, only infer built with "make TRACE=1" (the debug tarball) writes it
+				snpMafExpPath = os.path.join(self.output_dir, "snp_maf_exp_vs_adj.tsv")
+				cmd = "if [ -e %s ]; then %s -i %s -o %s; else echo '%s is missing, infer was built without tracing.'; fi" \
+					  % (snpMafExpPath, os.path.join(self.accurity_path, "plot_snp_maf_exp.py"),
+						 snpMafExpPath, self.output_dir, snpMafExpPath)
 				plot_snp_maf_exp_job = self.addTask("plot_snp_maf_exp", cmd, dependencies=infer_job)
 
 				# input: $(output_dir)/infer.out.tsv, infer.out.details.tsv, auto.tsv
@@ -414,13 +453,35 @@ if __name__ == '__main__':
 					help="The integer-valued argument that decides which method to use "
 						 "to detect the period in the read-count ratio histogram. "
 						 "0: the simple auto-correlation method. 1: a GADA-based algorithm (recommended). Default is 1.")
+	ap.add_argument("--segmentation_engine", type=str, default="SBL", choices=["SBL", "PELT"],
+					help="the segmentation engine used by GADA and by the period detection in infer. "
+						 "SBL: sparse Bayesian learning. PELT: penalized exact change-point detection, "
+						 "near-linear and predictable running time. Default is SBL.")
+	ap.add_argument("--stream_segments", type=int, default=0,
+					help="start infer before segmentation is finished: it takes each chromosome's segments as soon "
+						 "as its GADA job completes and fails if none completes within this many seconds. "
+						 "0 (default) runs infer after all segmentation jobs.")
+	ap.add_argument("--fused", type=int, default=0,
+					help="1: infer segments the normalized read-count ratio of each chromosome in memory "
+						 "(same GADA settings), skipping the GADA jobs and the segment files. Default is 0.")
+	ap.add_argument("--bootstrap_replicates", type=int, default=0,
+					help="after infer, re-run it on this many bootstrap resamples of the segments and report "
+						 "95%% percentile intervals of purity, ploidy and Q in bootstrap.ci.tsv. "
+						 "200 is a good choice. 0 (default) skips the bootstrap.")
+	ap.add_argument("--cache_dir", type=str, default="",
+					help="folder where infer caches the prepared segments and ratio histograms of its input files, "
+						 "so reruns on the same files (e.g. with other likelihood parameters, --step 5) skip "
+						 "reading them. Can be shared by samples. Default is no cache.")
 	args = ap.parse_args()
 	wflow = AccurityFlow(args.configure_filepath, args.tumor_bam, args.normal_bam, output_dir=args.output_dir,
 						 snp_output_dir=args.snp_output_dir,
 	                     segment_stddev_divider=args.segment_stddev_divider, snp_coverage_min=args.snp_coverage_min,
 	                     snp_coverage_var_vs_mean_ratio=args.snp_coverage_var_vs_mean_ratio,
 						 clean=args.clean, step=args.step, debug=args.debug, auto=args.auto,
-	                     max_no_of_peaks_for_logL=args.max_no_of_peaks_for_logL)
+	                     max_no_of_peaks_for_logL=args.max_no_of_peaks_for_logL,
+	                     segmentation_engine=args.segmentation_engine, stream_segments=args.stream_segments,
+	                     fused=args.fused, bootstrap_replicates=args.bootstrap_replicates,
+	                     cache_dir=args.cache_dir, nCores=args.nCores)
 	wflow.readConfigureFile(args.configure_filepath)
 	retval = wflow.run(mode="local", nCores=args.nCores, dataDirRoot=args.output_dir, isContinue='Auto',
 	                   isForceContinue=True, retryMax=0)
@@ -1,4 +1,7 @@
 #include "read_para.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -28,11 +31,79 @@ int OneSegment::get_rc_ratio_high_res()
     return int(rc_ratio * RESOLUTION);
 }
 
-OneSNP::OneSNP(int chr_index, int position, float maf, int coverage)
-    : chr_index(chr_index), position(position), maf(maf), coverage(coverage)
+ChrSNPStore::ChrSNPStore() : _sorted(true)
 {
 }
 
+void ChrSNPStore::add(long position, float log_maf, int coverage)
+{
+    if (!_position_vec.empty() && position < (long) _position_vec.back())
+        _sorted = false;
+    _position_vec.push_back((uint32_t) max(0L, min(position, (long) UINT32_MAX)));
+    _log_maf_vec.push_back((uint16_t) max(0.0f, min(roundf(-log_maf * kSNPLogMafScale), (float) UINT16_MAX)));
+    _coverage_vec.push_back((uint16_t) max(0, min(coverage, (int) UINT16_MAX)));
+}
+
+void ChrSNPStore::finish()
+{
+    if (_sorted)
+        return;
+    vector<size_t> order_vec(_position_vec.size());
+    for (size_t i = 0; i < order_vec.size(); i++)
+        order_vec[i] = i;
+    std::stable_sort(order_vec.begin(), order_vec.end(),
+                     [this](size_t i, size_t j) { return _position_vec[i] < _position_vec[j]; });
+    vector<uint32_t> position_vec(order_vec.size());
+    vector<uint16_t> log_maf_vec(order_vec.size());
+    vector<uint16_t> coverage_vec(order_vec.size());
+    for (size_t i = 0; i < order_vec.size(); i++)
+    {
+        position_vec[i] = _position_vec[order_vec[i]];
+        log_maf_vec[i] = _log_maf_vec[order_vec[i]];
+        coverage_vec[i] = _coverage_vec[order_vec[i]];
+    }
+    _position_vec.swap(position_vec);
+    _log_maf_vec.swap(log_maf_vec);
+    _coverage_vec.swap(coverage_vec);
+    _sorted = true;
+}
+
+pair<size_t, size_t> ChrSNPStore::range(long start_pos, long end_pos) const
+{
+    if (end_pos < start_pos || end_pos < 0)
+        return make_pair(0, 0);
+    uint32_t start = (uint32_t) max(0L, min(start_pos, (long) UINT32_MAX));
+    uint32_t end = (uint32_t) min(end_pos, (long) UINT32_MAX);
+    size_t first = std::lower_bound(_position_vec.begin(), _position_vec.end(), start) - _position_vec.begin();
+    size_t last = std::upper_bound(_position_vec.begin() + first, _position_vec.end(), end) - _position_vec.begin();
+    return make_pair(first, last);
+}
+
+void ChrSNPStore::appendLogMafs(size_t first, size_t last, vector<float> &log_maf_vec) const
+{
+    size_t offset = log_maf_vec.size();
+    log_maf_vec.resize(offset + last - first);
+    const uint16_t *log_maf_array = _log_maf_vec.data() + first;
+    float *out_array = log_maf_vec.data() + offset;
+    for (size_t i = 0; i < last - first; i++)
+        out_array[i] = -log_maf_array[i] / kSNPLogMafScale;
+}
+
+void ChrSNPStore::appendCoverages(size_t first, size_t last, vector<float> &coverage_vec) const
+{
+    size_t offset = coverage_vec.size();
+    coverage_vec.resize(offset + last - first);
+    const uint16_t *coverage_array = _coverage_vec.data() + first;
+    float *out_array = coverage_vec.data() + offset;
+    for (size_t i = 0; i < last - first; i++)
+        out_array[i] = coverage_array[i];
+}
+
+size_t ChrSNPStore::bytes() const
+{
+    return vector_bytes(_position_vec) + vector_bytes(_log_maf_vec) + vector_bytes(_coverage_vec);
+}
+
 OneSegmentSNPs::OneSegmentSNPs()
     : maf_mean(-1),
       maf_stddev(-1),
@@ -52,46 +123,36 @@ OneSegmentSNPs::OneSegmentSNPs(float maf_mean, double maf_stddev, int no_of_snps
       coverage_squared_sum(coverage_squared_sum){
 }
 
-Config read_para(string file_conf)
+//2026.10.18 errors go back to the caller instead of cout and exit(1)
+bool read_para(const string &file_conf, Config &config, string &error_msg)
 {
-    Config config;
     config.has_valid_para = false;
-
-    string trash;
-    try
+    if (!isfile(file_conf))
     {
-        if (!isfile(file_conf))
-        {
-            cout << fmt::format("ERROR: configure file {} does not exist.\n", file_conf);
-            exit(1);
-        }
-        ifstream in(file_conf.c_str());
-        in >> trash >> config.ref;
-        in >> trash >> config.readlength;
-        in >> trash >> config.window;
-        in >> trash >> config.path_to_ref;
-        in >> trash >> trash;  // ref genome fasta file
-        in >> trash >> trash;  // samtools
-        in >> trash >> trash;  // freebayes
-        in >> trash >> config.path;
-        if (config.path_to_ref[config.path_to_ref.length() - 1] != '/')
-            config.path_to_ref = config.path_to_ref + "/";
-        if (config.path[config.path.length() - 1] != '/')
-            config.path = config.path + "/";
-        config.has_valid_para = true;
-    }
-    catch (...)
+        error_msg = fmt::format("configure file {} does not exist.", file_conf);
+        return false;
+    }
+    string trash;
+    ifstream in(file_conf.c_str());
+    in >> trash >> config.ref;
+    in >> trash >> config.readlength;
+    in >> trash >> config.window;
+    in >> trash >> config.path_to_ref;
+    in >> trash >> trash;  // ref genome fasta file
+    in >> trash >> trash;  // samtools
+    in >> trash >> trash;  // freebayes
+    in >> trash >> config.path;
+    if (!in || config.path_to_ref.empty() || config.path.empty())
     {
-        cout << fmt::format("ERROR: wrong format in configure file {}.\n", file_conf);
-        exit(1);
+        error_msg = fmt::format("wrong format in configure file {}.", file_conf);
+        return false;
     }
-    cout << "Data from configure file:\n" TabMACRO
-            "genome name " TabMACRO config.ref NewLineMACRO TabMACRO
-            "read length " TabMACRO config.readlength NewLineMACRO TabMACRO
-            "window size " TabMACRO config.window NewLineMACRO TabMACRO
-            "reference genome index folder " TabMACRO config.path_to_ref NewLineMACRO TabMACRO
-            "accurity path " TabMACRO config.path NewLineMACRO;
-    return config;
+    if (config.path_to_ref[config.path_to_ref.length() - 1] != '/')
+        config.path_to_ref = config.path_to_ref + "/";
+    if (config.path[config.path.length() - 1] != '/')
+        config.path = config.path + "/";
+    config.has_valid_para = true;
+    return true;
 }
 
 void calculate_median_mad(double *input_array, long start_index, long stop_index,
@@ -184,15 +245,256 @@ void calculate_robust_mean_stddev(vector<float> float_vector, int percent_to_exc
 std::vector<std::string> string_split(std::string str,std::string sep){
     char* cstr=const_cast<char*>(str.c_str());
     char* current;
+    char* saveptr;  //strtok_r: segment files are split on several threads
     std::vector<std::string> arr;
-    current=strtok(cstr,sep.c_str());
+    current=strtok_r(cstr,sep.c_str(),&saveptr);
     while(current!=NULL){
         arr.push_back(current);
-        current=strtok(NULL,sep.c_str());
+        current=strtok_r(NULL,sep.c_str(),&saveptr);
     }
     return arr;
 }
 
+string json_string(const string &value){
+    string json = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': json += "\\\""; break;
+            case '\\': json += "\\\\"; break;
+            case '\n': json += "\\n"; break;
+            case '\t': json += "\\t"; break;
+            case '\r': json += "\\r"; break;
+            default:
+                if ((unsigned char) c < 0x20)
+                    json += fmt::format("\\u{:04x}", (int) c);
+                else
+                    json += c;
+        }
+    }
+    return json + "\"";
+}
+
+string json_number(double value){
+    if (!std::isfinite(value))
+        return "null";
+    return fmt::format("{:.10g}", value);
+}
+
+void process_memory_bytes(size_t &rss_bytes, size_t &peak_rss_bytes){
+    rss_bytes = 0;
+    peak_rss_bytes = 0;
+    ifstream status_file("/proc/self/status");
+    string line;
+    while (std::getline(status_file, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            rss_bytes = atol(line.c_str() + 6) * 1024L;
+        else if (line.compare(0, 6, "VmHWM:") == 0)
+            peak_rss_bytes = atol(line.c_str() + 6) * 1024L;
+    }
+}
+
+RunProfile::RunProfile() : _start_time(std::chrono::steady_clock::now()) {
+}
+
+RunProfile::ScopedPhase::ScopedPhase(RunProfile &profile, const string &phase_name)
+        : _profile(profile), _phase_name(phase_name), _start_time(std::chrono::steady_clock::now()), _stopped(false) {
+}
+
+RunProfile::ScopedPhase::~ScopedPhase() {
+    stop();
+}
+
+void RunProfile::ScopedPhase::stop() {
+    if (_stopped)
+        return;
+    _stopped = true;
+    _profile.addPhaseSeconds(_phase_name,
+                             std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count());
+}
+
+void RunProfile::addPhaseSeconds(const string &phase_name, double seconds){
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (Phase &phase : _phase_vec) {
+        if (phase.name == phase_name) {
+            phase.seconds += seconds;
+            phase.no_of_calls++;
+            return;
+        }
+    }
+    Phase phase = {phase_name, seconds, 1};
+    _phase_vec.push_back(phase);
+}
+
+void RunProfile::addCount(const string &counter_name, long n){
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (pair<string, long> &counter : _counter_vec) {
+        if (counter.first == counter_name) {
+            counter.second += n;
+            return;
+        }
+    }
+    _counter_vec.push_back(make_pair(counter_name, n));
+}
+
+void RunProfile::setCount(const string &counter_name, long n){
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (pair<string, long> &counter : _counter_vec) {
+        if (counter.first == counter_name) {
+            counter.second = n;
+            return;
+        }
+    }
+    _counter_vec.push_back(make_pair(counter_name, n));
+}
+
+void RunProfile::addMemorySnapshot(const string &checkpoint_name, const StructureBytes &structure_bytes_vec){
+    MemorySnapshot snapshot;
+    snapshot.checkpoint_name = checkpoint_name;
+    snapshot.structure_bytes_vec = structure_bytes_vec;
+    process_memory_bytes(snapshot.rss_bytes, snapshot.peak_rss_bytes);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _memory_snapshot_vec.push_back(snapshot);
+}
+
+double RunProfile::totalSeconds() const{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count();
+}
+
+bool RunProfile::writeJSON(const string &file_path, const string &program_name) const{
+    std::lock_guard<std::mutex> lock(_mutex);
+    ofstream json_file(file_path.c_str());
+    json_file << "{\"program\": " << json_string(program_name)
+              << ",\n \"total_seconds\": " << json_number(totalSeconds())
+              << ",\n \"phases\": [";
+    for (size_t i = 0; i < _phase_vec.size(); i++) {
+        json_file << (i ? ",\n  " : "\n  ") << "{\"name\": " << json_string(_phase_vec[i].name)
+                  << ", \"seconds\": " << json_number(_phase_vec[i].seconds)
+                  << ", \"calls\": " << _phase_vec[i].no_of_calls << "}";
+    }
+    json_file << "],\n \"counters\": {";
+    for (size_t i = 0; i < _counter_vec.size(); i++) {
+        json_file << (i ? ",\n  " : "\n  ") << json_string(_counter_vec[i].first) << ": " << _counter_vec[i].second;
+    }
+    size_t rss_bytes, peak_rss_bytes;
+    process_memory_bytes(rss_bytes, peak_rss_bytes);
+    json_file << "},\n \"peak_rss_bytes\": " << peak_rss_bytes
+              << ",\n \"memory\": [";
+    for (size_t i = 0; i < _memory_snapshot_vec.size(); i++) {
+        const MemorySnapshot &snapshot = _memory_snapshot_vec[i];
+        size_t structure_bytes = 0;
+        for (const pair<string, size_t> &structure : snapshot.structure_bytes_vec)
+            structure_bytes += structure.second;
+        json_file << (i ? ",\n  " : "\n  ") << "{\"checkpoint\": " << json_string(snapshot.checkpoint_name)
+                  << ", \"rss_bytes\": " << snapshot.rss_bytes
+                  << ", \"peak_rss_bytes\": " << snapshot.peak_rss_bytes
+                  << ", \"structure_bytes\": " << structure_bytes << ", \"structures\": {";
+        for (size_t j = 0; j < snapshot.structure_bytes_vec.size(); j++)
+            json_file << (j ? ", " : "") << json_string(snapshot.structure_bytes_vec[j].first) << ": "
+                      << snapshot.structure_bytes_vec[j].second;
+        json_file << "}}";
+    }
+    json_file << "]}\n";
+    json_file.close();
+    return (bool) json_file;
+}
+
+
+const size_t RowWriter::kDefaultBufferSize;
+//at most this many full buffers wait for the writer thread, which bounds the memory of a slow disk
+static const size_t kMaxQueuedRowWriterChunks = 4;
+
+RowWriter::RowWriter() : _is_open(false), _buffer_size(kDefaultBufferSize), _fd(-1), _closing(false), _error(false) {
+}
+
+RowWriter::~RowWriter() {
+    close();
+}
+
+bool RowWriter::open(const string &file_path, size_t buffer_size) {
+    close();
+    _buffer_size = buffer_size;
+    _closing = false;
+    _error = false;
+    _fd = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0)
+        return false;
+    if (file_path.size() > 3 && file_path.substr(file_path.size() - 3) == ".gz") {
+        _gzip_stream.reset(new boost::iostreams::filtering_ostream());
+        _gzip_stream->push(boost::iostreams::gzip_compressor());
+        _gzip_stream->push(boost::iostreams::file_descriptor_sink(_fd, boost::iostreams::never_close_handle));
+    }
+    _is_open = true;
+    return true;
+}
+
+void RowWriter::handOff() {
+    string chunk(_buffer.data(), _buffer.size());
+    _buffer.clear();
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_writer_thread.joinable())
+        _writer_thread = std::thread(&RowWriter::writeLoop, this);
+    _condition.wait(lock, [this] { return _chunk_queue.size() < kMaxQueuedRowWriterChunks; });
+    _chunk_queue.push_back(std::move(chunk));
+    _condition.notify_all();
+}
+
+void RowWriter::writeLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _condition.wait(lock, [this] { return _closing || !_chunk_queue.empty(); });
+        if (_chunk_queue.empty())
+            return;
+        string chunk = std::move(_chunk_queue.front());
+        _chunk_queue.pop_front();
+        _condition.notify_all();
+        lock.unlock();
+        bool ok = writeChunk(chunk);
+        lock.lock();
+        _error = _error || !ok;
+    }
+}
+
+bool RowWriter::writeChunk(const string &chunk) {
+    if (_gzip_stream) {
+        _gzip_stream->write(chunk.data(), chunk.size());
+        return (bool) *_gzip_stream;
+    }
+    size_t no_of_bytes_written = 0;
+    while (no_of_bytes_written < chunk.size()) {
+        ssize_t n = ::write(_fd, chunk.data() + no_of_bytes_written, chunk.size() - no_of_bytes_written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        no_of_bytes_written += n;
+    }
+    return true;
+}
+
+bool RowWriter::close() {
+    if (!_is_open)
+        return !_error;
+    if (_writer_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closing = true;
+        }
+        _condition.notify_all();
+        _writer_thread.join();
+    }
+    bool ok = !_error && writeChunk(string(_buffer.data(), _buffer.size()));
+    _buffer.clear();
+    if (_gzip_stream) {
+        //pops the compressor, which writes the gzip trailer
+        _gzip_stream->reset();
+        _gzip_stream.reset();
+    }
+    ok = (::close(_fd) == 0) && ok;
+    _fd = -1;
+    _is_open = false;
+    _error = !ok;
+    return ok;
+}
 
 
 // int main(int argc, char** argv) {
@@ -3,14 +3,22 @@
 #define __READ_PARA_H
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/copy.hpp>
@@ -114,14 +122,29 @@ class OneSegment
     OneSegmentSNPs oneSegmentSNPs;
 };
 
-class OneSNP
+//2026.10.18 the heterozygous SNPs of one chromosome as parallel arrays, sorted by position (8 bytes a SNP).
+// The log10 of the major allele fraction, in [log10(0.5), 0], is kept in steps of 1/kSNPLogMafScale and the
+// coverage capped at 65535.
+const float kSNPLogMafScale = 200000;
+class ChrSNPStore
 {
    public:
-    OneSNP(int chr_index, int position, float maf, int coverage);
-    int chr_index;
-    int position;
-    float maf;
-    int coverage;
+    ChrSNPStore();
+    void add(long position, float log_maf, int coverage);
+    void finish();  // sorts by position (stable) if needed, after the last add() and before the queries
+    size_t size() const { return _position_vec.size(); }
+    //[first, last) of the SNPs with start_pos <= position <= end_pos
+    pair<size_t, size_t> range(long start_pos, long end_pos) const;
+    //appends log10 major allele fractions or coverages of the SNPs in [first, last)
+    void appendLogMafs(size_t first, size_t last, vector<float> &log_maf_vec) const;
+    void appendCoverages(size_t first, size_t last, vector<float> &coverage_vec) const;
+    size_t bytes() const;  // of the arrays
+
+   private:
+    vector<uint32_t> _position_vec;
+    vector<uint16_t> _log_maf_vec;  // -log10(major allele fraction) * kSNPLogMafScale
+    vector<uint16_t> _coverage_vec;
+    bool _sorted;
 };
 
 class Config
@@ -135,7 +158,8 @@ class Config
     string path;
 };
 
-Config read_para(string file_conf);
+//reads the configure file into config. Returns false, with the reason in error_msg, if it is missing or malformed.
+bool read_para(const string &file_conf, Config &config, string &error_msg);
 
 inline bool isfile (const std::string& name) {
     struct stat buffer;
@@ -149,4 +173,110 @@ void calculate_robust_mean_stddev(double *input_array, long start_index, long st
 void calculate_robust_mean_stddev(vector<float> float_vector, int percent_to_exclude,
                                   float &mean_ref, float &stddev_ref, double &squared_sum, int &sample_size);
 vector<std::string> string_split(std::string str,std::string sep);
+//2026.10.18 JSON values: a quoted, escaped string; a number, null if not finite
+string json_string(const string &value);
+string json_number(double value);
+//2026.10.18 bytes held by the buffer of a vector (not by what its elements point to)
+template <class ElementType>
+inline size_t vector_bytes(const vector<ElementType> &element_vec){
+    return element_vec.capacity() * sizeof(ElementType);
+}
+//current and peak resident memory of this process (VmRSS and VmHWM), 0 where unknown
+void process_memory_bytes(size_t &rss_bytes, size_t &peak_rss_bytes);
+
+//2026.10.18 wall-clock seconds per phase and named counters of one program run, written as a JSON report to
+// track regressions and find what to optimize. Phases and counters keep the order they first appear in; a phase
+// entered several times adds up its time and counts the calls. Memory snapshots record the bytes of the main
+// structures at phase boundaries, for sizing jobs from their input. Thread-safe.
+class RunProfile
+{
+   public:
+    RunProfile();
+    //adds the time between its construction and destruction to a phase
+    class ScopedPhase
+    {
+       public:
+        ScopedPhase(RunProfile &profile, const string &phase_name);
+        ~ScopedPhase();
+        void stop();  // ends the phase before the scope does
+
+       private:
+        RunProfile &_profile;
+        string _phase_name;
+        std::chrono::steady_clock::time_point _start_time;
+        bool _stopped;
+    };
+    void addPhaseSeconds(const string &phase_name, double seconds);
+    void addCount(const string &counter_name, long n = 1);
+    void setCount(const string &counter_name, long n);
+    typedef vector<pair<string, size_t> > StructureBytes;
+    //bytes held by named structures at a checkpoint, with the process' resident and peak memory at that time
+    void addMemorySnapshot(const string &checkpoint_name, const StructureBytes &structure_bytes_vec);
+    double totalSeconds() const;  // since construction
+    //{"program": ..., "total_seconds": ..., "phases": [{"name", "seconds", "calls"}, ...], "counters": {...},
+    // "peak_rss_bytes": ..., "memory": [{"checkpoint", "rss_bytes", "peak_rss_bytes", "structure_bytes",
+    // "structures": {...}}, ...]}
+    bool writeJSON(const string &file_path, const string &program_name) const;
+
+   private:
+    struct Phase
+    {
+        string name;
+        double seconds;
+        long no_of_calls;
+    };
+    struct MemorySnapshot
+    {
+        string checkpoint_name;
+        StructureBytes structure_bytes_vec;
+        size_t rss_bytes;
+        size_t peak_rss_bytes;
+    };
+    std::chrono::steady_clock::time_point _start_time;
+    mutable std::mutex _mutex;
+    vector<Phase> _phase_vec;
+    vector<pair<string, long> > _counter_vec;
+    vector<MemorySnapshot> _memory_snapshot_vec;
+};
+
+//2026.10.18 buffered output of TSV rows. Rows are formatted (fmt syntax) into a large fmt::MemoryWriter, and full
+// buffers are handed to a background thread that writes them, gzip-compressed if the path ends in ".gz". A file
+// smaller than one buffer is written by close() in one go. Like a closed ofstream, a RowWriter that is not open
+// drops what it is given. ostream's default format of floating-point numbers is "{:g}".
+class RowWriter
+{
+   public:
+    static const size_t kDefaultBufferSize = 1 << 20;
+    RowWriter();
+    ~RowWriter();  // close()
+    bool open(const string &file_path, size_t buffer_size = kDefaultBufferSize);
+    bool is_open() const { return _is_open; }
+    template <typename... Args>
+    void write(fmt::CStringRef format_str, const Args &... args)
+    {
+        if (!_is_open)
+            return;
+        _buffer.write(format_str, args...);
+        if (_buffer.size() >= _buffer_size)
+            handOff();
+    }
+    //writes what is left, waits for the background thread and closes the file. false on a write error.
+    bool close();
+
+   private:
+    void handOff();
+    void writeLoop();
+    bool writeChunk(const string &chunk);
+    bool _is_open;
+    size_t _buffer_size;
+    fmt::MemoryWriter _buffer;
+    int _fd;  // plain output
+    std::unique_ptr<boost::iostreams::filtering_ostream> _gzip_stream;  // gzip output
+    std::thread _writer_thread;  // started by the first full buffer
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<string> _chunk_queue;
+    bool _closing;
+    bool _error;
+};
 #endif
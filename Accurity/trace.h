@@ -0,0 +1,222 @@
+/*
+ * 2026.10.18 Structured tracing for the diagnostic logs of hot loops (snp_logL.log.tsv,
+ * rc_logLikelihood.log.tsv, ... and the backward elimination progress of GADA).
+ *
+ * A trace point records one binary event (an event type and up to kMaxTraceValues numbers) into a ring
+ * buffer of the recording thread. Events are only formatted when a ring is full and when finish() is
+ * called after the run, each event type by its decoder, into the sink (file or stream) it was added with.
+ *
+ * Tracing is compiled in with -DACCURITY_TRACE=1 ("make TRACE=1"). Otherwise Tracer is an empty class
+ * whose active() is a constant false, so trace points
+ *     if (tracer.active()) tracer.record(type, value1, value2, ...);
+ * and their arguments compile out completely.
+ */
+#ifndef _ACCURITY_TRACE_H_
+#define _ACCURITY_TRACE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef ACCURITY_TRACE
+#define ACCURITY_TRACE 0
+#endif
+
+const bool kTraceEnabled = ACCURITY_TRACE != 0;
+const int kMaxTraceValues = 17;
+const int kTraceRingCapacity = 4096;
+
+struct TraceEvent
+{
+    int type;
+    int no_of_values;
+    double values[kMaxTraceValues];  // integers are stored as doubles, decoders cast them back
+};
+
+//formats one event as text, usually one TSV row
+typedef void (*TraceDecoder)(std::ostream &out, const TraceEvent &event);
+
+template <bool enabled>
+class BasicTracer;
+
+template <>
+class BasicTracer<true>
+{
+public:
+    BasicTracer() : _serial(++serial_counter()), _active(false)
+    {
+    }
+    ~BasicTracer()
+    {
+        finish();
+    }
+    bool active() const
+    {
+        return _active;
+    }
+    //opens file_path, writes header (as is) into it and returns the sink id. An unopenable file is an
+    // empty sink, as ofstream of the old logs was.
+    int addSink(const std::string &file_path, const std::string &header)
+    {
+        std::unique_ptr<std::ofstream> file(new std::ofstream(file_path.c_str(), std::ios::trunc));
+        *file << header;
+        _sink_vec.push_back(file.get());
+        _owned_sink_vec.push_back(std::move(file));
+        _active = true;
+        return _sink_vec.size() - 1;
+    }
+    int addSink(std::ostream &out)
+    {
+        _sink_vec.push_back(&out);
+        _active = true;
+        return _sink_vec.size() - 1;
+    }
+    //events of type go to sink, formatted by decoder
+    void addEventType(int type, int sink, TraceDecoder decoder)
+    {
+        if (type >= (int)_event_type_vec.size())
+            _event_type_vec.resize(type + 1);
+        _event_type_vec[type].sink = sink;
+        _event_type_vec[type].decoder = decoder;
+    }
+    template <typename... Values>
+    void record(int type, Values... values)
+    {
+        static_assert(sizeof...(Values) <= kMaxTraceValues, "too many values for one TraceEvent");
+        TraceRing &ring = threadRing();
+        if (ring.no_of_events == kTraceRingCapacity)
+            drain(ring);
+        TraceEvent &event = ring.event_array[(ring.first + ring.no_of_events) % kTraceRingCapacity];
+        ring.no_of_events++;
+        event.type = type;
+        event.no_of_values = sizeof...(Values);
+        const double value_array[] = {0.0, double(values)...};
+        std::copy(value_array + 1, value_array + 1 + sizeof...(Values), event.values);
+    }
+    //decodes all events left, in the order threads started recording, and closes the sinks
+    void finish()
+    {
+        if (!_active)
+            return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const std::unique_ptr<TraceRing> &ring : _ring_vec)
+            decode(*ring);
+        for (std::ostream *sink : _sink_vec)
+            sink->flush();
+        _ring_vec.clear();
+        _sink_vec.clear();
+        _owned_sink_vec.clear();
+        _event_type_vec.clear();
+        _active = false;
+    }
+    //the rings and file buffers held
+    size_t bytes() const
+    {
+        return _ring_vec.size() * sizeof(TraceRing) + _owned_sink_vec.size() * BUFSIZ;
+    }
+
+private:
+    struct TraceRing
+    {
+        std::thread::id owner;
+        int first = 0;
+        int no_of_events = 0;
+        TraceEvent event_array[kTraceRingCapacity];
+    };
+    struct EventType
+    {
+        int sink = -1;
+        TraceDecoder decoder = NULL;
+    };
+    static std::atomic<unsigned long> &serial_counter()
+    {
+        static std::atomic<unsigned long> counter(0);
+        return counter;
+    }
+    //the ring of the calling thread, cached per thread for the latest tracer it recorded into. A thread
+    // coming back from another tracer gets a new ring, after its older ones are decoded to keep the order.
+    TraceRing &threadRing()
+    {
+        static thread_local unsigned long cached_serial = 0;
+        static thread_local TraceRing *cached_ring = NULL;
+        if (cached_serial != _serial)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const std::unique_ptr<TraceRing> &ring : _ring_vec)
+                if (ring->owner == std::this_thread::get_id())
+                    decode(*ring);
+            _ring_vec.push_back(std::unique_ptr<TraceRing>(new TraceRing()));
+            _ring_vec.back()->owner = std::this_thread::get_id();
+            cached_ring = _ring_vec.back().get();
+            cached_serial = _serial;
+        }
+        return *cached_ring;
+    }
+    void drain(TraceRing &ring)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        decode(ring);
+    }
+    //with _mutex held
+    void decode(TraceRing &ring)
+    {
+        for (int i = 0; i < ring.no_of_events; i++)
+        {
+            const TraceEvent &event = ring.event_array[(ring.first + i) % kTraceRingCapacity];
+            const EventType &event_type = _event_type_vec[event.type];
+            event_type.decoder(*_sink_vec[event_type.sink], event);
+        }
+        ring.first = (ring.first + ring.no_of_events) % kTraceRingCapacity;
+        ring.no_of_events = 0;
+    }
+
+    const unsigned long _serial;  // tells the thread caches of tracers apart, even at a reused address
+    bool _active;
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<TraceRing>> _ring_vec;
+    std::vector<std::ostream *> _sink_vec;
+    std::vector<std::unique_ptr<std::ofstream>> _owned_sink_vec;
+    std::vector<EventType> _event_type_vec;
+};
+
+template <>
+class BasicTracer<false>
+{
+public:
+    constexpr bool active() const
+    {
+        return false;
+    }
+    int addSink(const std::string &, const std::string &)
+    {
+        return -1;
+    }
+    int addSink(std::ostream &)
+    {
+        return -1;
+    }
+    void addEventType(int, int, TraceDecoder)
+    {
+    }
+    template <typename... Values>
+    void record(int, Values...)
+    {
+    }
+    void finish()
+    {
+    }
+    size_t bytes() const
+    {
+        return 0;
+    }
+};
+
+typedef BasicTracer<kTraceEnabled> Tracer;
+
+#endif  //_ACCURITY_TRACE_H_
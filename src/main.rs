@@ -107,6 +107,14 @@ fn main() {
                 .required(true)
                 .takes_value(true)
             )
+            .arg(Arg::with_name("threads")
+                .short("p")
+                .long("threads")
+                .value_name("THREADS")
+                .help("Number of threads that read the tumor and normal bam files, one chromosome at a time. Both bam files must be indexed.")
+                .default_value("4")
+                .takes_value(true)
+            )
             .arg(Arg::with_name("debug")
                 .short("d")
                 .long("debug")
@@ -261,15 +269,16 @@ fn main() {
         let smooth_window_half_size: usize = matches.value_of("smooth_window_half_size").unwrap().parse().unwrap();
         let window_size: usize = matches.value_of("window_size").unwrap().parse().unwrap();
         let read_len: usize = matches.value_of("read_len").unwrap().parse().unwrap();
+        let no_of_threads: usize = matches.value_of("threads").unwrap().parse().unwrap();
         let debug: i32 = matches.value_of("debug").unwrap().parse().unwrap();
 
-        let arguments = format!("-t {} -n {} -w {} -l {} --smooth_window_half_size {} --max_coverage {} -d {} -o {}",
+        let arguments = format!("-t {} -n {} -w {} -l {} --smooth_window_half_size {} --max_coverage {} -p {} -d {} -o {}",
                                 tumor_file_path, normal_file_path, window_size, read_len,
-                                smooth_window_half_size, max_coverage, debug, output_folder);
+                                smooth_window_half_size, max_coverage, no_of_threads, debug, output_folder);
         let ins = accurity::normalize::Normalize::new(tumor_file_path, normal_file_path, output_folder,
                                  window_size, read_len,
                                  max_coverage, smooth_window_half_size,
-                                 debug);
+                                 no_of_threads, debug);
         ins.run();
     } else if let Some(matches) = matches.subcommand_matches("select_het_snp") {
         let snp_file_path_tumor = matches.value_of("snp_file_path_tumor").unwrap();
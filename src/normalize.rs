@@ -7,7 +7,9 @@ use std::cmp;
 use std::collections::HashMap;
 use std::io::prelude::*;
 use std::fs::File;
-use std::path::{Path};
+use std::path::{Path, PathBuf};
+use std::sync::{mpsc, Arc, Mutex};
+use std::thread;
 
 
 //from lib.rs
@@ -47,6 +49,84 @@ impl<'a> OneChrData<'a>{
     }
 }
 
+//fragment counts of one chromosome in one bam, before smoothing. Computed by the worker threads.
+struct ChrCoverageCount {
+    chr_idx: usize,
+    chr_len: usize,
+    coverage_per_window: Vec<usize>,
+    no_of_reads: usize,
+    no_of_valid_fragments: usize,
+    total_insert_len: usize,
+}
+
+// Count the fragments of one chromosome, through the bam index.
+// Each fragment is counted once, by its first read in template, in windows it covers more than half of.
+fn count_coverage_of_one_chr(bam_reader: &mut bam::IndexedReader, chr_idx: usize, chr_len: usize,
+                             window_size: usize, max_fragment_len: usize) -> ChrCoverageCount {
+    let mut no_of_windows_in_this_chr = chr_len / window_size;
+    if chr_len % window_size != 0 {
+        no_of_windows_in_this_chr += 1;
+    }
+    let mut chr_coverage_count = ChrCoverageCount {
+        chr_idx,
+        chr_len,
+        coverage_per_window: vec![0usize; no_of_windows_in_this_chr],
+        no_of_reads: 0,
+        no_of_valid_fragments: 0,
+        total_insert_len: 0,
+    };
+    let target_len = match bam_reader.header().target_len(chr_idx as u32) {
+        Some(target_len) => target_len,
+        // the bam has fewer chromosomes
+        None => return chr_coverage_count,
+    };
+    bam_reader.fetch(chr_idx as u32, 0, target_len)
+        .expect(&format!("Error in fetching chromosome index {} from the bam.", chr_idx));
+
+    for r in bam_reader.records() {
+        let record = r.unwrap();
+        chr_coverage_count.no_of_reads += 1;
+        if record.mapq()<30 || record.insert_size()<0 || record.insert_size()>max_fragment_len as i32 ||
+            !record.is_proper_pair() || record.is_mate_unmapped() || !record.is_first_in_template() ||
+            record.is_secondary() || record.is_duplicate() || record.is_supplementary() {
+            continue;
+        }
+
+        let mut start_pos = record.pos() as usize;
+        if record.is_reverse(){
+            start_pos = record.mpos() as usize;
+        }
+        let fragment_len: usize = record.insert_size() as usize;
+        let stop_pos: usize = start_pos + fragment_len;
+        //window start and stop index is [). The latter is not included.
+        let mut window_index_start: usize = start_pos / window_size;
+        let left_hanger = (window_index_start + 1) * window_size - start_pos;
+        if left_hanger < window_size / 2 && window_index_start < no_of_windows_in_this_chr - 1 {
+            window_index_start += 1;
+        }
+
+        let mut window_index_stop: usize = stop_pos / window_size;
+        let right_hanger = stop_pos - window_index_stop * window_size;
+        if right_hanger > window_size / 2 && window_index_stop < no_of_windows_in_this_chr - 1 {
+            // cover less than half for the last window. decrease.
+            window_index_stop += 1;
+        }
+        // Make sure the start and stop indices within the bounds
+        if window_index_start >= no_of_windows_in_this_chr {
+            window_index_start = no_of_windows_in_this_chr-1;
+        }
+        if window_index_stop >= no_of_windows_in_this_chr {
+            window_index_stop = no_of_windows_in_this_chr-1;
+        }
+        for window_index in window_index_start..window_index_stop {
+            chr_coverage_count.coverage_per_window[window_index] += 1;
+        }
+        chr_coverage_count.no_of_valid_fragments += 1;
+        chr_coverage_count.total_insert_len += fragment_len as usize;
+    }
+    chr_coverage_count
+}
+
 pub struct Normalize<'a> {
     tumor_file_path: &'a Path,
     normal_file_path: &'a Path,
@@ -60,6 +140,8 @@ pub struct Normalize<'a> {
     float_multiplier: usize,
     max_coverage: usize,
     smooth_window_half_size: usize,
+    //threads that scan the tumor and normal bams, one chromosome at a time
+    no_of_threads: usize,
     debug: i32,
 }
 
@@ -73,6 +155,7 @@ impl<'a> Normalize<'a> {
            read_len: usize,
            max_coverage: usize,
            smooth_window_half_size: usize,
+           no_of_threads: usize,
            debug: i32,
     ) -> Normalize<'a> {
         Normalize {
@@ -91,6 +174,7 @@ impl<'a> Normalize<'a> {
             float_multiplier: 1000,
             max_coverage,
             smooth_window_half_size,
+            no_of_threads: cmp::max(1, no_of_threads),
             debug,
         }
     }
@@ -119,126 +203,90 @@ impl<'a> Normalize<'a> {
                                coverage_per_base, no_of_windows);
     }
 
-    fn read_in_coverage_of_genome(&'a self, input_file_path: &'a Path) -> HashMap<usize, OneChrData> {
-        println_stderr!("Calculating gc-ratio, coverage for {:?} ... ", input_file_path);
-
-        let mut chr_idx2one_chr_data: HashMap<usize, OneChrData> = HashMap::new();
-
-        let mut bam_reader = bam::Reader::from_path(&input_file_path).unwrap();
-        //let header = bam::Header::from_template(bam.header());
-
-        let mut no_of_reads: usize = 0;
-        let mut no_of_valid_fragments_chr: usize = 0;
-        let mut coverage_per_window = vec![0usize];
-        let mut total_insert_len_of_chr: usize = 0;
-        let mut prev_chr_idx: i32 = -1;
-        let mut current_chr_idx: i32;
-        let mut chr: &str = "chr0";
-        let mut chr_len = 0usize;
-        let mut no_of_windows_in_this_chr = 0usize;
-        let mut no_of_unique_chrs = 0usize;
-
-        for r in bam_reader.records() {
-            let record = r.unwrap();
-            no_of_reads += 1;
-            if record.tid() >= self.chr_len_array.len() as i32 {
-                //skip all remaining irrelevant chromosomes
-                break;
-            }
-            current_chr_idx = record.tid();
-
-            if current_chr_idx != prev_chr_idx {
-                no_of_unique_chrs += 1;
-                if prev_chr_idx!=-1 {
-                    let chr_idx: usize = prev_chr_idx as usize;
-                    let coverage_per_base = total_insert_len_of_chr as f32 / chr_len as f32;
-                    println_stderr!("{} reads so far for {:?}. Chromosome {} contains {} valid fragments.",
-                            no_of_reads, &input_file_path, &chr, no_of_valid_fragments_chr);
-
-                    // handle previous chromosome data
-                    let one_chr_data = self.smooth_coverage_of_one_chr(&chr, chr_idx, chr_len,
-                                                                       no_of_valid_fragments_chr,
-                                                                       coverage_per_base,
-                                                                       &coverage_per_window);
-                    chr_idx2one_chr_data.insert(chr_idx, one_chr_data);
-                }
-
-                prev_chr_idx = current_chr_idx;
-
-                no_of_valid_fragments_chr = 0;
-                total_insert_len_of_chr = 0;
-                chr = self.chr_name_array[current_chr_idx as usize];
-                chr_len = self.chr_len_array[current_chr_idx as usize];
-                no_of_windows_in_this_chr = chr_len / self.window_size;
-                if chr_len % self.window_size != 0 {
-                    no_of_windows_in_this_chr += 1;
+    // Scan the tumor and the normal bam at the same time. Each (bam, chromosome) pair is one task, fetched
+    // through the bam index by a pool of worker threads, longest chromosomes first. Each worker opens one reader
+    // per bam (and its index) once and keeps it for all its tasks. The thread budget is split so that workers plus
+    // the decompression threads of all their readers stay within no_of_threads. Counts are smoothed here as the
+    // chromosomes come in.
+    fn read_in_coverage_of_genomes(&'a self) -> Vec<HashMap<usize, OneChrData>> {
+        let bam_file_path_array = [self.tumor_file_path.to_path_buf(), self.normal_file_path.to_path_buf()];
+        println_stderr!("Calculating coverage for {:?} and {:?} with {} threads ... ",
+                        bam_file_path_array[0], bam_file_path_array[1], self.no_of_threads);
+
+        let mut chr_idx_by_len: Vec<usize> = (0..self.chr_len_array.len()).collect();
+        chr_idx_by_len.sort_by(|a, b| self.chr_len_array[*b].cmp(&self.chr_len_array[*a]));
+        //tasks are popped from the back
+        let mut task_vec: Vec<(usize, usize)> = Vec::new();
+        for chr_idx in chr_idx_by_len.iter().rev() {
+            task_vec.push((1, *chr_idx));
+            task_vec.push((0, *chr_idx));
+        }
+        //a third of the budget scans, the rest inflates for the 2 readers of each worker
+        let no_of_workers = cmp::min(task_vec.len(), cmp::max(1, self.no_of_threads / 3));
+        let no_of_decompression_threads = self.no_of_threads.saturating_sub(no_of_workers) / (2 * no_of_workers);
+        let task_stack = Arc::new(Mutex::new(task_vec));
+        let (sender, receiver) = mpsc::channel::<(usize, ChrCoverageCount)>();
+
+        let mut worker_handle_vec = Vec::new();
+        for _ in 0..no_of_workers {
+            let task_stack = Arc::clone(&task_stack);
+            let sender = sender.clone();
+            let bam_file_path_array: [PathBuf; 2] = bam_file_path_array.clone();
+            let chr_len_array = self.chr_len_array;
+            let window_size = self.window_size;
+            let max_fragment_len = self.max_fragment_len;
+            worker_handle_vec.push(thread::spawn(move || {
+                let mut bam_reader_array: [Option<bam::IndexedReader>; 2] = [None, None];
+                loop {
+                    let task = task_stack.lock().unwrap().pop();
+                    let (sample_idx, chr_idx) = match task {
+                        Some(task) => task,
+                        None => break,
+                    };
+                    if bam_reader_array[sample_idx].is_none() {
+                        let mut bam_reader = bam::IndexedReader::from_path(&bam_file_path_array[sample_idx])
+                            .expect(&format!("Error in opening {:?} with its index.", &bam_file_path_array[sample_idx]));
+                        if no_of_decompression_threads > 0 {
+                            bam_reader.set_threads(no_of_decompression_threads)
+                                .expect("Error in setting the decompression threads of a bam reader.");
+                        }
+                        bam_reader_array[sample_idx] = Some(bam_reader);
+                    }
+                    let chr_coverage_count = count_coverage_of_one_chr(bam_reader_array[sample_idx].as_mut().unwrap(),
+                                                                       chr_idx, chr_len_array[chr_idx],
+                                                                       window_size, max_fragment_len);
+                    sender.send((sample_idx, chr_coverage_count)).unwrap();
                 }
-                coverage_per_window.clear();
-                coverage_per_window = vec![0usize; no_of_windows_in_this_chr];
-
-                println_stderr!("New chromosome {}, length={}, window size={}, no_of_windows={}.",
-                     chr, chr_len, self.window_size, no_of_windows_in_this_chr);
-
-            }
-
-            if record.mapq()<30 || record.insert_size()<0 || record.insert_size()>self.max_fragment_len as i32 ||
-                !record.is_proper_pair() || record.is_mate_unmapped() || !record.is_first_in_template() ||
-                record.is_secondary() || record.is_duplicate() || record.is_supplementary() {
-                continue;
-            }
-
-            let mut start_pos = record.pos() as usize;
-            if record.is_reverse(){
-                start_pos = record.mpos() as usize;
-            }
-            let fragment_len: usize = record.insert_size() as usize;
-            let stop_pos: usize = start_pos + fragment_len;
-            //window start and stop index is [). The latter is not included.
-            let mut window_index_start: usize = start_pos / self.window_size;
-            let left_hanger = (window_index_start + 1) * self.window_size - start_pos;
-            if left_hanger < self.window_size / 2 && window_index_start < no_of_windows_in_this_chr - 1 {
-                window_index_start += 1;
-            }
-
-            let mut window_index_stop: usize = stop_pos / self.window_size;
-            let right_hanger = stop_pos - window_index_stop * self.window_size;
-            if right_hanger > self.window_size / 2 && window_index_stop < no_of_windows_in_this_chr - 1 {
-                // cover less than half for the last window. decrease.
-                window_index_stop += 1;
-            }
-            // Make sure the start and stop indices within the bounds
-            if window_index_start >= no_of_windows_in_this_chr {
-                window_index_start = no_of_windows_in_this_chr-1;
-            }
-            if window_index_stop >= no_of_windows_in_this_chr {
-                window_index_stop = no_of_windows_in_this_chr-1;
-            }
-            for window_index in window_index_start..window_index_stop {
-                coverage_per_window[window_index] += 1;
-                // add all gc_ratio_per_base to this window, and will average later
-            }
-            no_of_valid_fragments_chr += 1;
-            total_insert_len_of_chr += fragment_len as usize;
+            }));
         }
-
-        //handle last chromosome
-        if prev_chr_idx != -1 && prev_chr_idx < self.chr_len_array.len() as i32 {
-            let chr_idx: usize = prev_chr_idx as usize;
-            let coverage_per_base = total_insert_len_of_chr as f32 / chr_len as f32;
-            println_stderr!("{} reads so far for {:?}. Chromosome {} contains {} valid fragments.",
-                            no_of_reads, &input_file_path, &chr, no_of_valid_fragments_chr);
-
-            // handle previous chromosome data
-            let one_chr_data = self.smooth_coverage_of_one_chr(&chr, chr_idx, chr_len,
-                                                               no_of_valid_fragments_chr,
+        //the receiver stops once all workers are done
+        drop(sender);
+
+        let mut chr_idx2one_chr_data_vec: Vec<HashMap<usize, OneChrData>> = vec![HashMap::new(), HashMap::new()];
+        let mut no_of_reads_array = [0usize; 2];
+        for (sample_idx, chr_coverage_count) in receiver.iter() {
+            let chr = self.chr_name_array[chr_coverage_count.chr_idx];
+            println_stderr!("{:?}: chromosome {} contains {} reads, {} valid fragments.",
+                            &bam_file_path_array[sample_idx], chr, chr_coverage_count.no_of_reads,
+                            chr_coverage_count.no_of_valid_fragments);
+            no_of_reads_array[sample_idx] += chr_coverage_count.no_of_reads;
+            let coverage_per_base = chr_coverage_count.total_insert_len as f32 / chr_coverage_count.chr_len as f32;
+            let one_chr_data = self.smooth_coverage_of_one_chr(chr, chr_coverage_count.chr_idx,
+                                                               chr_coverage_count.chr_len,
+                                                               chr_coverage_count.no_of_valid_fragments,
                                                                coverage_per_base,
-                                                               &coverage_per_window);
-            chr_idx2one_chr_data.insert(chr_idx, one_chr_data);
+                                                               &chr_coverage_count.coverage_per_window);
+            chr_idx2one_chr_data_vec[sample_idx].insert(chr_coverage_count.chr_idx, one_chr_data);
         }
-        println_stderr!("Calculation of gc-ratio, coverage for {:?} is Done. {} unique chromosomes, {} reads.",
-                input_file_path, no_of_unique_chrs, no_of_reads);
-
-        chr_idx2one_chr_data
+        for worker_handle in worker_handle_vec {
+            worker_handle.join().expect("A bam scanning thread panicked.");
+        }
+        for sample_idx in 0..2 {
+            println_stderr!("Calculation of coverage for {:?} is Done. {} chromosomes, {} reads.",
+                            &bam_file_path_array[sample_idx], chr_idx2one_chr_data_vec[sample_idx].len(),
+                            no_of_reads_array[sample_idx]);
+        }
+        chr_idx2one_chr_data_vec
     }
 
     fn output_coverage_ratio_of_one_chr(&self, one_chr_data_tumor: &OneChrData, one_chr_data_normal: &OneChrData,
@@ -342,12 +390,12 @@ impl<'a> Normalize<'a> {
 
     pub fn run(&self) {
         //let chr_idx2gc_map = self.read_gc_indices();
-        //TODO parallel tumor and normal. not easy due to shared references (&self) not allowed in threads
-        let chr_idx2one_chr_data_tumor = self.read_in_coverage_of_genome(self.tumor_file_path);
-        let coverage_mean_tumor = self.calculate_genome_wide_cov_mean(&chr_idx2one_chr_data_tumor);
+        let chr_idx2one_chr_data_vec = self.read_in_coverage_of_genomes();
+        let chr_idx2one_chr_data_tumor = &chr_idx2one_chr_data_vec[0];
+        let coverage_mean_tumor = self.calculate_genome_wide_cov_mean(chr_idx2one_chr_data_tumor);
 
-        let chr_idx2one_chr_data_normal = self.read_in_coverage_of_genome(self.normal_file_path);
-        let coverage_mean_normal = self.calculate_genome_wide_cov_mean(&chr_idx2one_chr_data_normal);
+        let chr_idx2one_chr_data_normal = &chr_idx2one_chr_data_vec[1];
+        let coverage_mean_normal = self.calculate_genome_wide_cov_mean(chr_idx2one_chr_data_normal);
 
         for chr_idx in 0..self.chr_len_array.len() {
             self.output_coverage_ratio_of_one_chr(&chr_idx2one_chr_data_tumor[&chr_idx],